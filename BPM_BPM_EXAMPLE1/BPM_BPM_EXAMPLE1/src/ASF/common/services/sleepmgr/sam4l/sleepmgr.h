@@ -100,10 +100,22 @@ extern uint8_t sleepmgr_locks[];
 #endif /* CONFIG_SLEEPMGR_ENABLE */
 /** @} */
 
+#if defined(CONFIG_SLEEPMGR_PRE_SLEEP_HOOK) || defined(__DOXYGEN__)
+/**
+ * Called before every sleep mode is entered, e.g. to drain a peripheral
+ * whose clock is stopped in \a sleep_mode. Interrupts may already be
+ * disabled, so the hook must not wait for an interrupt.
+ */
+extern void CONFIG_SLEEPMGR_PRE_SLEEP_HOOK(enum sleepmgr_mode sleep_mode);
+#endif
+
 static inline void sleepmgr_sleep(const enum sleepmgr_mode sleep_mode)
 {
 	Assert(sleep_mode != SLEEPMGR_ACTIVE);
 #ifdef CONFIG_SLEEPMGR_ENABLE
+#ifdef CONFIG_SLEEPMGR_PRE_SLEEP_HOOK
+	CONFIG_SLEEPMGR_PRE_SLEEP_HOOK(sleep_mode);
+#endif
 	cpu_irq_disable();
 
 	/* Enter the sleep mode. */
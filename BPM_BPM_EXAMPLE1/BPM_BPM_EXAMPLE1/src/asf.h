@@ -65,6 +65,9 @@
 // From module: EIC - External Interrupt Controller
 #include <eic.h>
 
+// From module: PDCA - Peripheral DMA Controller
+#include <pdca.h>
+
 // From module: FLASHCALW Controller Software Driver
 #include <flashcalw.h>
 
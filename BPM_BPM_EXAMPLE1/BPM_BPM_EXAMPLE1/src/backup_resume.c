@@ -0,0 +1,168 @@
+/**
+ * \file
+ *
+ * \brief Fast resume from BACKUP mode
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+
+#include <asf.h>
+#include "backup_resume.h"
+
+/** Marks a valid state in the upper half of BR0 */
+#define BACKUP_RESUME_MAGIC             (0xB4C5u)
+
+#define BACKUP_RESUME_BR_STATE          (0)
+#define BACKUP_RESUME_BR_ALARM          (1)
+#define BACKUP_RESUME_BR_COUNT          (2)
+
+/**
+ * \brief Write a backup register, which is protected by the BSCIF lock
+ */
+static void backup_resume_br_write(uint8_t index, uint32_t value)
+{
+	BSCIF->BSCIF_UNLOCK = BSCIF_UNLOCK_KEY(0xAAu) | BSCIF_UNLOCK_ADDR(
+			(uint32_t)&BSCIF->BSCIF_BR[index] - (uint32_t)BSCIF);
+	BSCIF->BSCIF_BR[index].BSCIF_BR = value;
+}
+
+static uint32_t backup_resume_br_read(uint8_t index)
+{
+	return BSCIF->BSCIF_BR[index].BSCIF_BR;
+}
+
+/**
+ * \brief Save the state and enter BACKUP mode until the AST alarm, or
+ * another enabled backup wake-up source.
+ *
+ * \param[in]  state  State to restore, count and wake-up fields unused
+ * \param[in]  ticks  AST ticks until the alarm
+ */
+void backup_resume_enter(const struct backup_resume_state *state,
+		uint32_t ticks)
+{
+	uint32_t alarm;
+
+	alarm = ast_read_counter_value(AST) + ticks;
+	ast_clear_interrupt_flag(AST, AST_INTERRUPT_ALARM);
+	ast_write_alarm0_value(AST, alarm);
+	ast_enable_wakeup(AST, AST_WAKEUP_ALARM);
+	bpm_enable_wakeup_source(BPM, BPM_BKUP_WAKEUP_SRC_AST);
+
+	backup_resume_br_write(BACKUP_RESUME_BR_ALARM, alarm);
+	backup_resume_br_write(BACKUP_RESUME_BR_STATE,
+			((uint32_t)BACKUP_RESUME_MAGIC << 16)
+			| ((uint32_t)state->tag << 8)
+			| ((state->sleep_mode & 0x0f) << 4)
+			| (state->power_scaling & 0x01));
+
+	while (1) {
+		sleepmgr_sleep(SLEEPMGR_BACKUP);
+	}
+}
+
+/**
+ * \brief Detect a restart from backup_resume_enter() and restore the state
+ *
+ * Must be the first call of main(), before the clocks are initialized: the
+ * AST counter is latched on entry, and the RCSYS cycles until the next AST
+ * tick give the latency with a better resolution than the AST tick.
+ *
+ * \param[out]  state  State saved by backup_resume_enter()
+ *
+ * \return true if the device resumes from backup_resume_enter().
+ */
+bool backup_resume_check(struct backup_resume_state *state)
+{
+	uint32_t counter, cycles, alarm, br;
+
+	sysclk_enable_peripheral_clock(AST);
+	counter = ast_read_counter_value(AST);
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	sysclk_enable_peripheral_clock(BSCIF);
+	sysclk_enable_peripheral_clock(BPM);
+	br = backup_resume_br_read(BACKUP_RESUME_BR_STATE);
+	if ((br >> 16) != BACKUP_RESUME_MAGIC) {
+		backup_resume_br_write(BACKUP_RESUME_BR_COUNT, 0);
+		return false;
+	}
+
+	alarm = backup_resume_br_read(BACKUP_RESUME_BR_ALARM);
+	state->ast_wakeup = (bpm_get_backup_wakeup_cause(BPM)
+			& BPM_BKUP_WAKEUP_SRC_AST) && ((int32_t)(counter - alarm) >= 0);
+	if (state->ast_wakeup) {
+		while (ast_read_counter_value(AST) == counter) {
+		}
+		cycles = DWT->CYCCNT;
+		state->wake_ticks = counter - alarm + 1;
+		state->wake_cycles = cycles;
+	} else {
+		state->wake_ticks = 0;
+		state->wake_cycles = 0;
+	}
+
+	state->power_scaling = br & 0x01;
+	state->sleep_mode = (br >> 4) & 0x0f;
+	state->tag = (br >> 8) & 0xff;
+	state->count = backup_resume_br_read(BACKUP_RESUME_BR_COUNT) + 1;
+
+	backup_resume_br_write(BACKUP_RESUME_BR_COUNT, state->count);
+	backup_resume_br_write(BACKUP_RESUME_BR_STATE, 0);
+	ast_disable_wakeup(AST, AST_WAKEUP_ALARM);
+	ast_clear_interrupt_flag(AST, AST_INTERRUPT_ALARM);
+	return true;
+}
+
+/**
+ * \brief Time from the AST alarm to the start of main()
+ *
+ * \return Latency in us, 0 if the device has not been woken up by the alarm.
+ */
+uint32_t backup_resume_latency_us(const struct backup_resume_state *state)
+{
+	if (!state->ast_wakeup) {
+		return 0;
+	}
+	return (uint32_t)((uint64_t)state->wake_ticks * 1000000
+			/ BACKUP_RESUME_AST_HZ
+			- (uint64_t)state->wake_cycles * 1000000
+			/ OSC_RCSYS_NOMINAL_HZ);
+}
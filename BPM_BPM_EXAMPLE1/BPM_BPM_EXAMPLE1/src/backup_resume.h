@@ -0,0 +1,101 @@
+/**
+ * \file
+ *
+ * \brief Fast resume from BACKUP mode
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+
+#ifndef BACKUP_RESUME_H_INCLUDED
+#define BACKUP_RESUME_H_INCLUDED
+
+#include <compiler.h>
+
+/**
+ * \defgroup backup_resume_group Fast resume from BACKUP mode
+ *
+ * BACKUP mode resets the core domain: the clocks, the GPIO, the USARTs, the
+ * NVIC and the RAM content are lost. The backup domain is kept: OSC32, the
+ * AST, the EIC, the BPM wake-up configuration and the four BSCIF backup
+ * registers, which hold the state the application needs to resume.
+ *
+ * backup_resume_enter() saves the state and enters BACKUP mode, with an AST
+ * alarm as wake-up source. backup_resume_check(), called first in main(),
+ * detects the wake-up from it and measures how late the application
+ * starts after the alarm; the application then only initializes the core
+ * domain, and skips the configuration of the backup domain.
+ *
+ * Backup registers used:
+ * - BR0: magic, application tag, sleep mode and power scaling,
+ * - BR1: AST alarm value,
+ * - BR2: number of resumes.
+ *
+ * @{
+ */
+
+/** AST counter frequency configured by the application, in Hz */
+#ifndef BACKUP_RESUME_AST_HZ
+#define BACKUP_RESUME_AST_HZ            (16384)
+#endif
+
+/** State saved across BACKUP mode */
+struct backup_resume_state {
+	/** Power scaling (BPM_PS_0 or BPM_PS_1) */
+	uint8_t power_scaling;
+	/** Board monitor sleep mode */
+	uint8_t sleep_mode;
+	/** Free for the application, e.g. to resume a test sequence */
+	uint8_t tag;
+	/** Number of resumes from BACKUP mode, set by backup_resume_check() */
+	uint16_t count;
+	/** The AST alarm woke up the device, so the latency is valid */
+	bool ast_wakeup;
+	/** AST ticks from the alarm to main(), rounded up */
+	uint32_t wake_ticks;
+	/** RCSYS cycles from main() to the next AST tick */
+	uint32_t wake_cycles;
+};
+
+void backup_resume_enter(const struct backup_resume_state *state,
+		uint32_t ticks);
+bool backup_resume_check(struct backup_resume_state *state);
+uint32_t backup_resume_latency_us(const struct backup_resume_state *state);
+
+/** @} */
+
+#endif /* BACKUP_RESUME_H_INCLUDED */
@@ -54,12 +54,17 @@
  * <b>Operating mode: </b>The user can select the low power mode and power
  * scaling from the terminal. The example uses the terminal and the board
  * monitor to provide infomation about the current power save mode and actual
- * power consumption.
+ * power consumption. After Backup mode, the example resumes without setting
+ * up the backup domain again, and prints the wake-up latency.
  *
  * \section files Main Files
  * - bpm.c: BPM driver;
  * - bpm.h: BPM driver header file;
- * - bpm_example.c: BPM example application.
+ * - bpm_example.c: BPM example application;
+ * - usart_stream.c: buffered console using the PDCA;
+ * - energy_bench.c: energy per operation and wake-up latency benchmark,
+ *   driven from the host by tools/energy_bench.py;
+ * - backup_resume.c: fast resume from Backup mode.
  *
  * \section compilinfo Compilation Information
  * This software is written for GNU GCC and IAR Embedded Workbench
@@ -89,6 +94,9 @@
 
 #include <asf.h>
 #include "board_monitor.h"
+#include "usart_stream.h"
+#include "energy_bench.h"
+#include "backup_resume.h"
 
 /* Flag to use board monitor */
 static bool ps_status = BPM_PS_1;
@@ -96,6 +104,12 @@ static bool ps_status = BPM_PS_1;
 /* Current sleep mode */
 static uint32_t current_sleep_mode = SLEEP_MODE_NA;
 
+/* State saved across Backup mode */
+static struct backup_resume_state backup_state;
+
+/* Backup mode duration: 8 seconds of the AST counter */
+#define BACKUP_WAKEUP_TICKS    (8 * BACKUP_RESUME_AST_HZ)
+
 /* Power scaling value -> board monitor status */
 power_scaling_t ps_statuses[] = {
 	POWER_SCALING_PS0, POWER_SCALING_PS1
@@ -123,7 +137,8 @@ static void ast_per_callback(void)
 }
 
 /**
- * Initialize AST to generate 1Hz counter
+ * Initialize AST to generate a 16384Hz counter, which times the wake-up
+ * from Backup mode
  */
 static void config_ast(void)
 {
@@ -139,14 +154,14 @@ static void config_ast(void)
 	ast_enable(AST);
 
 	ast_conf.mode = AST_COUNTER_MODE;
-	ast_conf.osc_type = AST_OSC_1KHZ;
-	ast_conf.psel = AST_PSEL_32KHZ_1HZ;
+	ast_conf.osc_type = AST_OSC_32KHZ;
+	ast_conf.psel = 0;
 	ast_conf.counter = 0;
 	ast_set_config(AST, &ast_conf);
 
 	/* Set periodic 0 to interrupt after 8 second in counter mode. */
 	ast_clear_interrupt_flag(AST, AST_INTERRUPT_PER);
-	ast_write_periodic0_value(AST, AST_PSEL_32KHZ_1HZ - 2);
+	ast_write_periodic0_value(AST, AST_PSEL_32KHZ_1HZ + 3);
 	/* Set callback for periodic0. */
 	ast_set_callback(AST, AST_INTERRUPT_PER, ast_per_callback,
 		AST_PER_IRQn, 1);
@@ -188,6 +203,52 @@ static void config_backup_wakeup(void)
 	bpm_enable_fast_wakeup(BPM);
 }
 
+/**
+ * Restart after Backup mode: OSC32, the AST, the EIC and the Backup
+ * wake-up configuration are kept in the backup domain, so only the
+ * interrupts of the core domain are set up again.
+ */
+static void resume_from_backup(void)
+{
+	ast_set_callback(AST, AST_INTERRUPT_PER, ast_per_callback,
+		AST_PER_IRQn, 1);
+	eic_enable(EIC);
+	eic_line_set_callback(EIC, GPIO_PUSH_BUTTON_EIC_LINE, eic_5_callback,
+		EIC_5_IRQn, 1);
+	/* Release the I/O lines, now that the GPIO are configured again */
+	bpm_disable_io_retention(BPM);
+	bpm_enable_io_retention(BPM);
+
+	ps_status = backup_state.power_scaling;
+	bpm_configure_power_scaling(BPM, ps_status, BPM_PSCM_CPU_NOT_HALT);
+	while((bpm_get_status(BPM) & BPM_SR_PSOK) == 0);
+	current_sleep_mode = backup_state.sleep_mode;
+
+	/* Complete the benchmark after its Backup step */
+	if (energy_bench_resume(&backup_state)) {
+		return;
+	}
+
+	printf("\r\n--Exit Backup mode (resume %u", backup_state.count);
+	if (backup_state.ast_wakeup) {
+		printf(", wake-up latency %lu us",
+				backup_resume_latency_us(&backup_state));
+	}
+	printf(").\r\n");
+}
+
+/**
+ * Enter \a sleep_mode until the AST periodic wake-up. The mode is forced
+ * regardless of the sleep manager locks, so the console is drained first.
+ */
+static void enter_sleep_mode(enum sleepmgr_mode sleep_mode)
+{
+	usart_stream_flush();
+	ast_enable_wakeup(AST, AST_WAKEUP_PER);
+	sleepmgr_sleep(sleep_mode);
+	ast_disable_wakeup(AST, AST_WAKEUP_PER);
+}
+
 /**
  *  Configure serial console.
  */
@@ -205,7 +266,7 @@ static void configure_console(void)
 	};
 
 	/* Configure console. */
-	stdio_serial_init(CONF_UART, &uart_serial_options);
+	usart_stream_stdio_init(CONF_UART, &uart_serial_options);
 }
 
 /**
@@ -223,6 +284,7 @@ static void display_menu(void)
 			"  4: Enter Wait mode. \r\n"
 			"  5: Enter Retention mode. \r\n"
 			"  6: Enter Backup mode. \r\n"
+			"  b: Run the energy benchmark. \r\n"
 			"  h: Display menu \r\n"
 			"  --Push button can also be used to exit low power mode--\r\n"
 			"\r\n");
@@ -238,34 +300,44 @@ static void display_menu(void)
 int main(void)
 {
 	uint8_t key;
+	bool resumed;
+
+	/* First of all, measure the wake-up latency from Backup mode */
+	resumed = backup_resume_check(&backup_state);
 
 	/* Initialize the SAM system */
 	sysclk_init();
 	board_init();
+	sleepmgr_init();
 
 	/* Initialize the console uart */
 	configure_console();
 
-	/* Output example information */
-	printf("\r\n");
-	printf("-- BPM Example --\r\n");
-	printf("-- %s\r\n", BOARD_NAME);
-	printf("-- Compiled: %s %s --\r\n", __DATE__, __TIME__);
-
 	/* Initialize the board monitor  */
 	bm_init();
 
-	/* Configurate the AST to wake up */
-	config_ast();
+	if (resumed) {
+		/* The backup domain is still configured */
+		resume_from_backup();
+	} else {
+		/* Output example information */
+		printf("\r\n");
+		printf("-- BPM Example --\r\n");
+		printf("-- %s\r\n", BOARD_NAME);
+		printf("-- Compiled: %s %s --\r\n", __DATE__, __TIME__);
 
-	/* Configurate the EIC */
-	config_buttons();
+		/* Configurate the AST to wake up */
+		config_ast();
 
-	/* Configurate the backup wakeup source */
-	config_backup_wakeup();
+		/* Configurate the EIC */
+		config_buttons();
 
-	/* Display menu */
-	display_menu();
+		/* Configurate the backup wakeup source */
+		config_backup_wakeup();
+
+		/* Display menu */
+		display_menu();
+	}
 
 	while(1) {
 		scanf("%c", (char *)&key);
@@ -296,12 +368,7 @@ int main(void)
 			bm_send_mcu_status(ps_statuses[ps_status], current_sleep_mode,
 					12000000, CPU_SRC_RC4M);
 			printf("\r\n--Enter Sleep mode 0.\r\n");
-			ast_enable_wakeup(AST, AST_WAKEUP_PER);
-			/* Wait for the printf operation to finish before
-			setting the device in a power save mode. */
-			delay_ms(30);
-			bpm_sleep(BPM, BPM_SM_SLEEP_0);
-			ast_disable_wakeup(AST, AST_WAKEUP_PER);
+			enter_sleep_mode(SLEEPMGR_SLEEP_0);
 			printf("\r\n--Exit Sleep mode 0.\r\n");
 			break;
 
@@ -310,12 +377,7 @@ int main(void)
 			bm_send_mcu_status(ps_statuses[ps_status], current_sleep_mode,
 					12000000, CPU_SRC_RC4M);
 			printf("\r\n--Enter Sleep mode 1.\r\n");
-			ast_enable_wakeup(AST, AST_WAKEUP_PER);
-			/* Wait for the printf operation to finish before
-			setting the device in a power save mode. */
-			delay_ms(30);
-			bpm_sleep(BPM, BPM_SM_SLEEP_1);
-			ast_disable_wakeup(AST, AST_WAKEUP_PER);
+			enter_sleep_mode(SLEEPMGR_SLEEP_1);
 			printf("\r\n--Exit Sleep mode 1.\r\n");
 			break;
 
@@ -324,12 +386,7 @@ int main(void)
 			bm_send_mcu_status(ps_statuses[ps_status], current_sleep_mode,
 					12000000, CPU_SRC_RC4M);
 			printf("\r\n--Enter Sleep mode 2.\r\n");
-			ast_enable_wakeup(AST, AST_WAKEUP_PER);
-			/* Wait for the printf operation to finish before
-			setting the device in a power save mode. */
-			delay_ms(30);
-			bpm_sleep(BPM, BPM_SM_SLEEP_2);
-			ast_disable_wakeup(AST, AST_WAKEUP_PER);
+			enter_sleep_mode(SLEEPMGR_SLEEP_2);
 			printf("\r\n--Exit Sleep mode 2.\r\n");
 			break;
 
@@ -338,12 +395,7 @@ int main(void)
 			bm_send_mcu_status(ps_statuses[ps_status], current_sleep_mode,
 					12000000, CPU_SRC_RC4M);
 			printf("\r\n--Enter Sleep mode 3.\r\n");
-			ast_enable_wakeup(AST, AST_WAKEUP_PER);
-			/* Wait for the printf operation to finish before
-			setting the device in a power save mode. */
-			delay_ms(30);
-			bpm_sleep(BPM, BPM_SM_SLEEP_3);
-			ast_disable_wakeup(AST, AST_WAKEUP_PER);
+			enter_sleep_mode(SLEEPMGR_SLEEP_3);
 			printf("\r\n--Exit Sleep mode 3.\r\n");
 			break;
 
@@ -352,12 +404,7 @@ int main(void)
 			bm_send_mcu_status(ps_statuses[ps_status], current_sleep_mode,
 					12000000, CPU_SRC_RC4M);
 			printf("\r\n--Enter Wait mode.\r\n");
-			ast_enable_wakeup(AST, AST_WAKEUP_PER);
-			/* Wait for the printf operation to finish before
-			setting the device in a power save mode. */
-			delay_ms(30);
-			bpm_sleep(BPM, BPM_SM_WAIT);
-			ast_disable_wakeup(AST, AST_WAKEUP_PER);
+			enter_sleep_mode(SLEEPMGR_WAIT);
 			printf("\r\n--Exit Wait mode.\r\n");
 			break;
 
@@ -366,12 +413,7 @@ int main(void)
 			bm_send_mcu_status(ps_statuses[ps_status], current_sleep_mode,
 					12000000, CPU_SRC_RC4M);
 			printf("\r\n--Enter Retention mode.\r\n");
-			ast_enable_wakeup(AST, AST_WAKEUP_PER);
-			/* Wait for the printf operation to finish before
-			setting the device in a power save mode. */
-			delay_ms(30);
-			bpm_sleep(BPM, BPM_SM_RET);
-			ast_disable_wakeup(AST, AST_WAKEUP_PER);
+			enter_sleep_mode(SLEEPMGR_RET);
 			printf("\r\n--Exit Retention mode.\r\n");
 			break;
 
@@ -380,13 +422,18 @@ int main(void)
 			bm_send_mcu_status(ps_statuses[ps_status], current_sleep_mode,
 					12000000, CPU_SRC_RC4M);
 			printf("\r\n--Enter Backup mode.\r\n");
-			ast_enable_wakeup(AST, AST_WAKEUP_PER);
-			/* Wait for the printf operation to finish before
-			setting the device in a power save mode. */
-			delay_ms(30);
-			bpm_sleep(BPM, BPM_SM_BACKUP);
-			ast_disable_wakeup(AST, AST_WAKEUP_PER);
-			printf("\r\n--Exit Backup mode.\r\n");
+			/* The device restarts and resume_from_backup() takes over */
+			usart_stream_flush();
+			backup_state.power_scaling = ps_status;
+			backup_state.sleep_mode = current_sleep_mode;
+			backup_state.tag = 0;
+			backup_resume_enter(&backup_state, BACKUP_WAKEUP_TICKS);
+			break;
+
+		case 'b':
+			printf("\r\n--Run the energy benchmark.\r\n");
+			/* Ends with a restart from Backup mode. */
+			energy_bench_run();
 			break;
 
 		default:
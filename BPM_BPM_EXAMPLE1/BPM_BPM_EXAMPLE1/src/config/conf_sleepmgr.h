@@ -46,4 +46,7 @@
 // Sleep manager options
 #define CONFIG_SLEEPMGR_ENABLE
 
+// Drain the buffered console before entering a sleep mode
+#define CONFIG_SLEEPMGR_PRE_SLEEP_HOOK  usart_stream_sleep_hook
+
 #endif /* CONF_SLEEPMGR_INCLUDED */
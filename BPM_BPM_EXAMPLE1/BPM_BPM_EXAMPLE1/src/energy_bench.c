@@ -0,0 +1,342 @@
+/**
+ * \file
+ *
+ * \brief Energy per operation and wake-up latency benchmark
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+
+#include <asf.h>
+#include <string.h>
+#include "board_monitor.h"
+#include "usart_stream.h"
+#include "backup_resume.h"
+#include "energy_bench.h"
+
+/** Size of the blocks copied and read by the memory workloads */
+#define ENERGY_BENCH_BLOCK_SIZE         (1024)
+
+/** Workload run for a fixed time */
+struct energy_bench_workload {
+	const char *name;
+	void (*run)(void);
+};
+
+/** Sleep mode entered until the AST alarm */
+struct energy_bench_mode {
+	const char *name;
+	enum sleepmgr_mode sleep_mode;
+	sleep_mode_t bm_sleep_mode;
+};
+
+static uint32_t energy_bench_src[ENERGY_BENCH_BLOCK_SIZE / 4];
+static uint32_t energy_bench_dst[ENERGY_BENCH_BLOCK_SIZE / 4];
+/** Keeps the result of the flash workload alive */
+static volatile uint32_t energy_bench_sum;
+
+static volatile bool energy_bench_alarm;
+
+/** Board monitor status of each power scaling */
+static const power_scaling_t energy_bench_bm_ps[] = {
+	POWER_SCALING_PS0, POWER_SCALING_PS1
+};
+
+/**
+ * \brief Find the first 8 prime numbers, as the low power demo does
+ */
+static void energy_bench_prime(void)
+{
+	uint32_t primes[8];
+	uint32_t i, d, n;
+
+	primes[0] = 1;
+	for (i = 1; i < 8; i++) {
+		for (n = primes[i - 1] + 1; ; n++) {
+			for (d = 2; n % d != 0; d++) {
+			}
+			if (d == n) {
+				break;
+			}
+		}
+		primes[i] = n;
+	}
+	energy_bench_sum = primes[7];
+}
+
+/**
+ * \brief Copy a block in RAM
+ */
+static void energy_bench_memcpy(void)
+{
+	memcpy(energy_bench_dst, energy_bench_src, sizeof(energy_bench_dst));
+}
+
+/**
+ * \brief Sum a block of the flash
+ */
+static void energy_bench_flash(void)
+{
+	const volatile uint32_t *p = (const volatile uint32_t *)FLASH_ADDR;
+	uint32_t sum = 0;
+
+	for (uint32_t i = 0; i < ENERGY_BENCH_BLOCK_SIZE / 4; i++) {
+		sum += p[i];
+	}
+	energy_bench_sum = sum;
+}
+
+static const struct energy_bench_workload energy_bench_workloads[] = {
+	{ "prime",  energy_bench_prime },
+	{ "memcpy", energy_bench_memcpy },
+	{ "flash",  energy_bench_flash },
+};
+
+static const struct energy_bench_mode energy_bench_modes[] = {
+	{ "sleep0",    SLEEPMGR_SLEEP_0, SLEEP_MODE_0 },
+	{ "sleep1",    SLEEPMGR_SLEEP_1, SLEEP_MODE_1 },
+	{ "sleep2",    SLEEPMGR_SLEEP_2, SLEEP_MODE_2 },
+	{ "sleep3",    SLEEPMGR_SLEEP_3, SLEEP_MODE_3 },
+	{ "wait",      SLEEPMGR_WAIT,    SLEEP_MODE_WAIT },
+	{ "retention", SLEEPMGR_RET,     SLEEP_MODE_RETENTION },
+};
+
+/**
+ * \brief AST alarm interrupt: ends the sleep step
+ */
+static void energy_bench_alarm_callback(void)
+{
+	ast_clear_interrupt_flag(AST, AST_INTERRUPT_ALARM);
+	energy_bench_alarm = true;
+}
+
+/**
+ * \brief Read the current measured by the board monitor in a mode
+ *
+ * \return IEEE-754 representation of the current, 0 on error.
+ */
+static uint32_t energy_bench_read_current(sleep_mode_t bm_sleep_mode)
+{
+	uint32_t sleep_mode = bm_sleep_mode;
+	union {
+		float f;
+		uint32_t u32;
+	} current;
+
+	if (!bm_get_mcu_current(&sleep_mode, &current.f)) {
+		return 0;
+	}
+	return current.u32;
+}
+
+/**
+ * \brief Report the mode to the board monitor and let the console drain,
+ * so the measurement only covers the step
+ */
+static void energy_bench_set_status(uint8_t ps, sleep_mode_t bm_sleep_mode)
+{
+	bm_send_mcu_status(energy_bench_bm_ps[ps], bm_sleep_mode,
+			sysclk_get_cpu_hz(), CPU_SRC_RC4M);
+	usart_stream_flush();
+}
+
+static void energy_bench_set_power_scaling(uint8_t ps)
+{
+	bpm_configure_power_scaling(BPM, ps, BPM_PSCM_CPU_NOT_HALT);
+	while ((bpm_get_status(BPM) & BPM_SR_PSOK) == 0) {
+	}
+}
+
+/**
+ * \brief Run a workload for ENERGY_BENCH_RUN_TICKS and count the operations
+ */
+static void energy_bench_workload(uint8_t ps,
+		const struct energy_bench_workload *workload)
+{
+	uint32_t start, ticks, ops = 0;
+
+	energy_bench_set_status(ps, SLEEP_MODE_RUN);
+
+	start = ast_read_counter_value(AST);
+	do {
+		workload->run();
+		ops++;
+		ticks = ast_read_counter_value(AST) - start;
+	} while (ticks < ENERGY_BENCH_RUN_TICKS);
+
+	printf("BENCH RUN ps=%u wl=%s ops=%lu ticks=%lu cur=0x%08lx\r\n",
+			ps, workload->name, ops, ticks,
+			energy_bench_read_current(SLEEP_MODE_RUN));
+}
+
+/**
+ * \brief Sleep until the AST alarm, then measure how late the application
+ * resumes: whole AST ticks since the alarm, less the CPU cycles left until
+ * the next tick.
+ */
+static void energy_bench_sleep(uint8_t ps,
+		const struct energy_bench_mode *mode)
+{
+	uint32_t alarm, counter, cycles;
+
+	energy_bench_set_status(ps, mode->bm_sleep_mode);
+
+	energy_bench_alarm = false;
+	alarm = ast_read_counter_value(AST) + ENERGY_BENCH_SLEEP_TICKS;
+	ast_write_alarm0_value(AST, alarm);
+
+	/*
+	 * Check the alarm with interrupts disabled: the alarm interrupt still
+	 * wakes up the CPU if it is pending when the sleep mode is entered.
+	 */
+	while (1) {
+		cpu_irq_disable();
+		if (energy_bench_alarm) {
+			cpu_irq_enable();
+			break;
+		}
+		sleepmgr_sleep(mode->sleep_mode);
+	}
+
+	counter = ast_read_counter_value(AST);
+	cycles = DWT->CYCCNT;
+	while (ast_read_counter_value(AST) == counter) {
+	}
+	cycles = DWT->CYCCNT - cycles;
+
+	printf("BENCH SLEEP ps=%u mode=%s ticks=%lu wake=%lu cycles=%lu"
+			" cur=0x%08lx\r\n", ps, mode->name,
+			(uint32_t)ENERGY_BENCH_SLEEP_TICKS, counter - alarm + 1, cycles,
+			energy_bench_read_current(mode->bm_sleep_mode));
+}
+
+/**
+ * \brief Enter BACKUP mode until the AST alarm. The device restarts, and
+ * energy_bench_resume() prints the record.
+ */
+static void energy_bench_backup(uint8_t ps)
+{
+	const struct backup_resume_state state = {
+		.power_scaling = ps,
+		.sleep_mode = SLEEP_MODE_BACKUP,
+		.tag = ENERGY_BENCH_TAG,
+	};
+
+	energy_bench_set_status(ps, SLEEP_MODE_BACKUP);
+	backup_resume_enter(&state, ENERGY_BENCH_SLEEP_TICKS);
+}
+
+/**
+ * \brief Configure the AST as the benchmark timebase, with an alarm
+ * waking up from all the sleep modes
+ */
+static void energy_bench_config_ast(void)
+{
+	struct ast_config ast_conf;
+
+	ast_conf.mode = AST_COUNTER_MODE;
+	ast_conf.osc_type = AST_OSC_32KHZ;
+	ast_conf.psel = ENERGY_BENCH_AST_PSEL;
+	ast_conf.counter = 0;
+	ast_set_config(AST, &ast_conf);
+
+	ast_disable_interrupt(AST, AST_INTERRUPT_PER);
+	ast_disable_wakeup(AST, AST_WAKEUP_PER);
+	ast_clear_interrupt_flag(AST, AST_INTERRUPT_ALARM);
+	ast_set_callback(AST, AST_INTERRUPT_ALARM, energy_bench_alarm_callback,
+			AST_ALARM_IRQn, 1);
+	ast_enable_wakeup(AST, AST_WAKEUP_ALARM);
+}
+
+/**
+ * \brief Run all the workloads and sleep modes under each power scaling,
+ * then enter BACKUP mode. Does not return: the benchmark ends with the
+ * restart from BACKUP mode.
+ */
+void energy_bench_run(void)
+{
+	uint8_t ps;
+	uint8_t i;
+
+	// CPU cycle counter
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	energy_bench_config_ast();
+
+	printf("BENCH BEGIN cpu_hz=%lu ast_hz=%lu\r\n", sysclk_get_cpu_hz(),
+			(uint32_t)(32768 >> (ENERGY_BENCH_AST_PSEL + 1)));
+
+	for (ps = BPM_PS_0; ps <= BPM_PS_1; ps++) {
+		energy_bench_set_power_scaling(ps);
+		for (i = 0; i < sizeof(energy_bench_workloads)
+				/ sizeof(energy_bench_workloads[0]); i++) {
+			energy_bench_workload(ps, &energy_bench_workloads[i]);
+		}
+		for (i = 0; i < sizeof(energy_bench_modes)
+				/ sizeof(energy_bench_modes[0]); i++) {
+			energy_bench_sleep(ps, &energy_bench_modes[i]);
+		}
+	}
+
+	energy_bench_backup(BPM_PS_1);
+}
+
+/**
+ * \brief Print the record of the BACKUP step, when the device restarts
+ * from the benchmark BACKUP mode. The latency measured from RCSYS cycles
+ * is reported in CPU cycles, as the other records.
+ *
+ * \param[in]  resume  State restored by backup_resume_check()
+ *
+ * \return true if the benchmark has been completed.
+ */
+bool energy_bench_resume(const struct backup_resume_state *resume)
+{
+	if (resume->tag != ENERGY_BENCH_TAG) {
+		return false;
+	}
+
+	printf("BENCH SLEEP ps=%u mode=backup ticks=%lu wake=%lu cycles=%lu"
+			" cur=0x%08lx\r\n", resume->power_scaling,
+			(uint32_t)ENERGY_BENCH_SLEEP_TICKS, resume->wake_ticks,
+			(uint32_t)((uint64_t)resume->wake_cycles * sysclk_get_cpu_hz()
+			/ OSC_RCSYS_NOMINAL_HZ),
+			energy_bench_read_current(SLEEP_MODE_BACKUP));
+	printf("BENCH END\r\n");
+	return true;
+}
@@ -0,0 +1,104 @@
+/**
+ * \file
+ *
+ * \brief Energy per operation and wake-up latency benchmark
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+
+#ifndef ENERGY_BENCH_H_INCLUDED
+#define ENERGY_BENCH_H_INCLUDED
+
+#include <compiler.h>
+
+/**
+ * \defgroup energy_bench_group Energy benchmark
+ *
+ * Runs each workload for a fixed time and each sleep mode until an AST
+ * alarm, under both power scalings, and reads the current measured by the
+ * board monitor after each step. One record per step is printed on the
+ * console, for tools/energy_bench.py to compute the energy per operation
+ * and the wake-up latency:
+ *
+ * - BENCH BEGIN cpu_hz=<Hz> ast_hz=<Hz>
+ * - BENCH RUN ps=<0|1> wl=<name> ops=<count> ticks=<AST ticks> cur=<float>
+ * - BENCH SLEEP ps=<0|1> mode=<name> ticks=<AST ticks> wake=<AST ticks>
+ *   cycles=<CPU cycles> cur=<float>
+ * - BENCH END
+ *
+ * cur is the IEEE-754 representation of the board monitor current, in hex.
+ * The wake-up latency is wake AST ticks minus cycles CPU cycles: the
+ * application resumes that many ticks after the alarm, less the cycles
+ * left until the next AST tick.
+ *
+ * BACKUP mode resets the device, so it is entered last, through
+ * backup_resume_enter(). Its record is printed by energy_bench_resume() on
+ * the next start, with a latency which includes the startup code.
+ *
+ * The benchmark ends with the restart from BACKUP mode, so the AST and the
+ * power scaling are not restored.
+ *
+ * @{
+ */
+
+/** AST prescaler of the benchmark: 16384 Hz counter from OSC32 */
+#ifndef ENERGY_BENCH_AST_PSEL
+#define ENERGY_BENCH_AST_PSEL           (0)
+#endif
+
+/** Time each workload runs, in AST ticks */
+#ifndef ENERGY_BENCH_RUN_TICKS
+#define ENERGY_BENCH_RUN_TICKS          (32768)
+#endif
+
+/** Time each sleep mode lasts, in AST ticks */
+#ifndef ENERGY_BENCH_SLEEP_TICKS
+#define ENERGY_BENCH_SLEEP_TICKS        (32768)
+#endif
+
+/** Application tag of the BACKUP step in the backup registers */
+#define ENERGY_BENCH_TAG                (0xEB)
+
+struct backup_resume_state;
+
+void energy_bench_run(void);
+bool energy_bench_resume(const struct backup_resume_state *resume);
+
+/** @} */
+
+#endif /* ENERGY_BENCH_H_INCLUDED */
@@ -0,0 +1,310 @@
+/**
+ * \file
+ *
+ * \brief Buffered USART stdio driver using the PDCA
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#include <asf.h>
+#include "usart_stream.h"
+
+#define TX_MASK         (USART_STREAM_TX_SIZE - 1)
+
+#if (USART_STREAM_TX_SIZE & TX_MASK) != 0
+#  error USART_STREAM_TX_SIZE must be a power of two
+#endif
+
+/** Characters waiting for or being moved by the PDCA */
+static uint8_t tx_buf[USART_STREAM_TX_SIZE];
+/** Next free position, advanced by the writer only */
+static volatile uint16_t tx_head;
+/** First character of the block loaded into the PDCA */
+static volatile uint16_t tx_tail;
+/** Length of the block loaded into the PDCA, 0 when idle */
+static volatile uint16_t tx_len;
+
+/** Written by the PDCA in ring mode */
+static volatile uint8_t rx_buf[USART_STREAM_RX_SIZE];
+/** Next position to be read */
+static uint16_t rx_tail;
+
+static Usart *stream_usart;
+
+/**
+ * \brief Load the next contiguous block of the transmit buffer
+ *
+ * Must be called with interrupts disabled. The first block of a
+ * transmission locks SLEEPMGR_SLEEP_0, which is released again once the
+ * buffer is empty.
+ */
+static void usart_stream_tx_start(void)
+{
+	uint16_t head = tx_head;
+
+	if (tx_len != 0) {
+		return;
+	}
+
+	if (head == tx_tail) {
+		pdca_channel_disable_interrupt(USART_STREAM_TX_PDCA_CHANNEL,
+				PDCA_IDR_TRC);
+		sleepmgr_unlock_mode(SLEEPMGR_SLEEP_0);
+		return;
+	}
+
+	/* Stop at the end of the buffer, the rest follows as a next block. */
+	tx_len = (head > tx_tail) ? (head - tx_tail) :
+			(USART_STREAM_TX_SIZE - tx_tail);
+	pdca_channel_write_load(USART_STREAM_TX_PDCA_CHANNEL,
+			&tx_buf[tx_tail], tx_len);
+}
+
+/**
+ * \brief Retire the block the PDCA has completed and load the next one
+ *
+ * Must be called with interrupts disabled.
+ */
+static void usart_stream_tx_done(void)
+{
+	if (tx_len == 0) {
+		return;
+	}
+
+	tx_tail = (tx_tail + tx_len) & TX_MASK;
+	tx_len = 0;
+	usart_stream_tx_start();
+}
+
+/**
+ * \brief PDCA transfer of the transmit channel complete
+ */
+static void usart_stream_tx_cb(enum pdca_channel_status status)
+{
+	if (status == PDCA_CH_TRANSFER_COMPLETED) {
+		usart_stream_tx_done();
+	}
+}
+
+/**
+ * \brief Poll for a completed block
+ *
+ * Lets the transmitter make progress when called with interrupts
+ * disabled, e.g. from printf() in an interrupt handler or from the
+ * pre-sleep hook.
+ */
+static void usart_stream_tx_poll(void)
+{
+	irqflags_t flags = cpu_irq_save();
+
+	if (pdca_get_channel_status(USART_STREAM_TX_PDCA_CHANNEL) ==
+			PDCA_CH_TRANSFER_COMPLETED) {
+		usart_stream_tx_done();
+	}
+	cpu_irq_restore(flags);
+}
+
+static void usart_stream_get_pids(Usart *usart, uint32_t *tx_pid,
+		uint32_t *rx_pid)
+{
+	if (usart == USART0) {
+		*tx_pid = USART0_PDCA_ID_TX;
+		*rx_pid = USART0_PDCA_ID_RX;
+	} else if (usart == USART1) {
+		*tx_pid = USART1_PDCA_ID_TX;
+		*rx_pid = USART1_PDCA_ID_RX;
+	} else if (usart == USART2) {
+		*tx_pid = USART2_PDCA_ID_TX;
+		*rx_pid = USART2_PDCA_ID_RX;
+	} else {
+		*tx_pid = USART3_PDCA_ID_TX;
+		*rx_pid = USART3_PDCA_ID_RX;
+	}
+}
+
+/**
+ * \brief Initialize the USART and redirect stdio to the ring buffers
+ *
+ * Replaces stdio_serial_init().
+ *
+ * \param[in]  usart  USART used for stdio
+ * \param[in]  opt    Serial line options
+ */
+void usart_stream_stdio_init(Usart *usart, const usart_serial_options_t *opt)
+{
+	pdca_channel_config_t tx_cfg = {
+		.addr = (void *)tx_buf,
+		.size = 0,
+		.transfer_size = PDCA_MR_SIZE_BYTE
+	};
+	pdca_channel_config_t rx_cfg = {
+		.addr = (void *)rx_buf,
+		.size = USART_STREAM_RX_SIZE,
+		/* Wrap around to the start of the buffer forever */
+		.r_addr = (void *)rx_buf,
+		.r_size = USART_STREAM_RX_SIZE,
+		.transfer_size = PDCA_MR_SIZE_BYTE,
+		.ring = true
+	};
+
+	stdio_serial_init(usart, opt);
+	stream_usart = usart;
+	tx_head = tx_tail = tx_len = 0;
+	rx_tail = 0;
+
+	usart_stream_get_pids(usart, &tx_cfg.pid, &rx_cfg.pid);
+
+	pdca_enable(PDCA);
+	pdca_channel_set_config(USART_STREAM_TX_PDCA_CHANNEL, &tx_cfg);
+	pdca_channel_set_callback(USART_STREAM_TX_PDCA_CHANNEL,
+			usart_stream_tx_cb,
+			PDCA_0_IRQn + USART_STREAM_TX_PDCA_CHANNEL, 1, 0);
+	pdca_channel_enable(USART_STREAM_TX_PDCA_CHANNEL);
+	pdca_channel_set_config(USART_STREAM_RX_PDCA_CHANNEL, &rx_cfg);
+	pdca_channel_enable(USART_STREAM_RX_PDCA_CHANNEL);
+
+	ptr_put = (int (*)(void volatile*,char))&usart_stream_putchar;
+	ptr_get = (void (*)(void volatile*,char*))&usart_stream_getchar;
+}
+
+/**
+ * \brief Queue one character for transmission
+ *
+ * Only waits if the transmit buffer is full.
+ *
+ * \param[in]  usart  Unused, the USART given to usart_stream_stdio_init()
+ * \param[in]  c      Character to send
+ *
+ * \return 1, as usart_serial_putchar()
+ */
+int usart_stream_putchar(Usart *usart, const uint8_t c)
+{
+	irqflags_t flags;
+	uint16_t next = (tx_head + 1) & TX_MASK;
+
+	UNUSED(usart);
+
+	while (next == tx_tail) {
+		usart_stream_tx_poll();
+	}
+
+	tx_buf[tx_head] = c;
+
+	flags = cpu_irq_save();
+	if ((tx_len == 0) && (tx_head == tx_tail)) {
+		sleepmgr_lock_mode(SLEEPMGR_SLEEP_0);
+		pdca_channel_enable_interrupt(USART_STREAM_TX_PDCA_CHANNEL,
+				PDCA_IER_TRC);
+	}
+	tx_head = next;
+	usart_stream_tx_start();
+	cpu_irq_restore(flags);
+
+	return 1;
+}
+
+/**
+ * \brief Number of characters the PDCA has written ahead of the reader
+ */
+static uint16_t usart_stream_rx_count(void)
+{
+	volatile PdcaChannel *ch =
+			pdca_channel_get_handler(USART_STREAM_RX_PDCA_CHANNEL);
+	uint16_t head = (ch->PDCA_MAR - (uint32_t)rx_buf) % USART_STREAM_RX_SIZE;
+
+	return (head + USART_STREAM_RX_SIZE - rx_tail) % USART_STREAM_RX_SIZE;
+}
+
+/**
+ * \brief Check whether a received character can be read
+ *
+ * \return true if usart_stream_getchar() does not wait
+ */
+bool usart_stream_is_rx_ready(void)
+{
+	return usart_stream_rx_count() != 0;
+}
+
+/**
+ * \brief Read one received character, waiting for it if necessary
+ *
+ * \param[in]  usart  Unused, the USART given to usart_stream_stdio_init()
+ * \param[out] c      Received character
+ */
+void usart_stream_getchar(Usart *usart, uint8_t *c)
+{
+	UNUSED(usart);
+
+	while (!usart_stream_is_rx_ready()) {
+	}
+
+	*c = rx_buf[rx_tail];
+	rx_tail = (rx_tail + 1) % USART_STREAM_RX_SIZE;
+}
+
+/**
+ * \brief Wait until all queued characters have left the USART
+ *
+ * May be called with interrupts disabled.
+ */
+void usart_stream_flush(void)
+{
+	while (tx_len != 0) {
+		usart_stream_tx_poll();
+	}
+
+	while (!usart_is_tx_empty(stream_usart)) {
+	}
+}
+
+/**
+ * \brief Pre-sleep hook of the sleep manager
+ *
+ * The buffer is drained before every mode: in deeper modes the PDCA and
+ * the USART stop, and in SLEEPMGR_SLEEP_0 the end of the transfer would
+ * wake the CPU before the intended wake-up source.
+ *
+ * \param[in]  sleep_mode  Mode about to be entered
+ */
+void usart_stream_sleep_hook(enum sleepmgr_mode sleep_mode)
+{
+	UNUSED(sleep_mode);
+
+	if (stream_usart != NULL) {
+		usart_stream_flush();
+	}
+}
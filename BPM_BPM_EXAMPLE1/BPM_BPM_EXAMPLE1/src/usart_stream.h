@@ -0,0 +1,99 @@
+/**
+ * \file
+ *
+ * \brief Buffered USART stdio driver using the PDCA
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#ifndef USART_STREAM_H_INCLUDED
+#define USART_STREAM_H_INCLUDED
+
+#include <compiler.h>
+#include <sleepmgr.h>
+#include <serial.h>
+
+/**
+ * \defgroup usart_stream_group Buffered USART stdio
+ *
+ * printf() only copies the characters into a transmit ring buffer and the
+ * PDCA moves them to the USART, so the CPU neither waits for each
+ * character nor takes an interrupt per character. A second PDCA channel
+ * fills a receive ring buffer in ring mode and never needs to be serviced.
+ *
+ * While a transmission is in progress SLEEPMGR_SLEEP_0 is locked, since
+ * the PDCA stops with the HSB clock. Before a sleep mode is entered with
+ * sleepmgr_sleep() the transmit buffer is drained through the pre-sleep
+ * hook, so no delay is needed after the last printf().
+ *
+ * Received characters are dropped if the application does not read them
+ * before \ref USART_STREAM_RX_SIZE more characters arrived, and nothing is
+ * received in modes deeper than SLEEPMGR_SLEEP_0.
+ *
+ * @{
+ */
+
+/** Size of the transmit ring buffer, power of two */
+#ifndef USART_STREAM_TX_SIZE
+#define USART_STREAM_TX_SIZE            (256)
+#endif
+
+/** Size of the receive ring buffer */
+#ifndef USART_STREAM_RX_SIZE
+#define USART_STREAM_RX_SIZE            (64)
+#endif
+
+/** PDCA channel feeding the USART transmitter */
+#ifndef USART_STREAM_TX_PDCA_CHANNEL
+#define USART_STREAM_TX_PDCA_CHANNEL    (0)
+#endif
+
+/** PDCA channel filling the receive ring buffer */
+#ifndef USART_STREAM_RX_PDCA_CHANNEL
+#define USART_STREAM_RX_PDCA_CHANNEL    (1)
+#endif
+
+void usart_stream_stdio_init(Usart *usart, const usart_serial_options_t *opt);
+int usart_stream_putchar(Usart *usart, const uint8_t c);
+void usart_stream_getchar(Usart *usart, uint8_t *c);
+bool usart_stream_is_rx_ready(void);
+void usart_stream_flush(void);
+void usart_stream_sleep_hook(enum sleepmgr_mode sleep_mode);
+
+/** @} */
+
+#endif /* USART_STREAM_H_INCLUDED */
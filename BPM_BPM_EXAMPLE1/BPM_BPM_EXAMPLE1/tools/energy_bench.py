@@ -0,0 +1,360 @@
+#!/usr/bin/env python3
+"""Run the BPM example energy benchmark and report energy per operation.
+
+The firmware (src/energy_bench.c) runs each workload for a fixed time and
+each sleep mode until an AST alarm, under power scaling PS0 and PS1, and
+prints one BENCH record per step with the current read from the board
+monitor. This runner starts the benchmark from the console ('b' command),
+collects the records, including the one printed after the restart from
+BACKUP mode, and reports:
+
+    - for each workload: operations per second, current, uJ per operation,
+    - for each sleep mode: current and wake-up latency.
+
+    energy_bench.py --port /dev/ttyACM0
+
+Without a board, --sim runs a model of the firmware against a simulated
+board monitor, which answers the board monitor protocol frames with the
+currents of a table. --check then verifies that the report matches the
+model, for CI:
+
+    energy_bench.py --sim --check
+
+On a board whose board monitor USART is wired to the host instead,
+--bm-port serves the simulated board monitor on that port while the
+benchmark runs.
+"""
+
+import argparse
+import re
+import struct
+import sys
+import threading
+import time
+
+BM_MSG_START_PATTERN = 0x75
+BM_MSG_STOP_PATTERN = 0xA3
+BM_MCU_STATUS = 0x07
+BM_MCU_GET_CURRENT = 0x0A
+BM_MCU_RET_CURRENT = 0x0C
+BM_MCU_GET_FIFO_FREE_SIZE = 0x0D
+BM_MCU_RET_FIFO_FREE_SIZE = 0x0E
+
+# sleep_mode_t of board_monitor.h
+SLEEP_MODES = {
+    'run': 1, 'sleep0': 2, 'sleep1': 3, 'sleep2': 4, 'sleep3': 5,
+    'wait': 6, 'retention': 7, 'backup': 8,
+}
+# power_scaling_t of board_monitor.h
+POWER_SCALINGS = {0: 1, 1: 2}
+
+CURRENT_UNITS = {'A': 1.0, 'mA': 1e-3, 'uA': 1e-6}
+
+RECORD = re.compile(r'BENCH (\w+)((?: \w+=\S+)*)')
+
+
+def frame(cmd, payload=b''):
+    """Encode a board monitor frame: the length counts itself, the command,
+    the payload and the stop pattern."""
+    return bytes([BM_MSG_START_PATTERN, len(payload) + 3, cmd]) + \
+        bytes(payload) + bytes([BM_MSG_STOP_PATTERN])
+
+
+class FrameParser:
+    """Board monitor frame decoder, fed with bytes."""
+
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data):
+        """Return the (cmd, payload) of the complete frames received."""
+        self.buf += data
+        frames = []
+        while True:
+            start = self.buf.find(BM_MSG_START_PATTERN)
+            if start < 0:
+                self.buf.clear()
+                return frames
+            del self.buf[:start]
+            if len(self.buf) < 2:
+                return frames
+            length = self.buf[1]
+            if length < 3:
+                del self.buf[0]
+                continue
+            if len(self.buf) < length + 1:
+                return frames
+            if self.buf[length] == BM_MSG_STOP_PATTERN:
+                frames.append((self.buf[2], bytes(self.buf[3:length])))
+                del self.buf[:length + 1]
+            else:
+                del self.buf[0]
+
+
+class BoardMonitorSim:
+    """Simulated board monitor: keeps the MCU status sent by the firmware
+    and answers the queries, with the current of the table for the
+    requested mode, in uA."""
+
+    # uA at 12 MHz for RUN, per power scaling (PS0, PS1)
+    CURRENTS = {
+        'run': (2600.0, 1900.0),
+        'sleep0': (1400.0, 1000.0),
+        'sleep1': (900.0, 650.0),
+        'sleep2': (520.0, 380.0),
+        'sleep3': (180.0, 120.0),
+        'wait': (3.0, 1.9),
+        'retention': (1.5, 0.9),
+        'backup': (0.9, 0.9),
+    }
+
+    def __init__(self):
+        self.parser = FrameParser()
+        self.power_scaling = POWER_SCALINGS[0]
+        self.sleep_mode = SLEEP_MODES['run']
+
+    def current(self, sleep_mode):
+        name = next(k for k, v in SLEEP_MODES.items() if v == sleep_mode)
+        ps = 1 if self.power_scaling == POWER_SCALINGS[1] else 0
+        return self.CURRENTS[name][ps]
+
+    def feed(self, data):
+        """Return the response bytes to the frames received."""
+        out = b''
+        for cmd, payload in self.parser.feed(data):
+            if cmd == BM_MCU_STATUS and len(payload) >= 2:
+                self.power_scaling, self.sleep_mode = payload[0], payload[1]
+            elif cmd == BM_MCU_GET_CURRENT and len(payload) == 1:
+                out += frame(BM_MCU_RET_CURRENT, bytes([payload[0]]) +
+                             struct.pack('>f', self.current(payload[0])))
+            elif cmd == BM_MCU_GET_FIFO_FREE_SIZE:
+                out += frame(BM_MCU_RET_FIFO_FREE_SIZE, b'\x01\x00')
+        return out
+
+
+class SimTarget:
+    """Model of the benchmark firmware, talking to a board monitor through
+    the frame protocol, and printing the same records."""
+
+    CPU_HZ = 12000000
+    AST_HZ = 16384
+    RUN_TICKS = 32768
+    SLEEP_TICKS = 32768
+    # CPU cycles per operation of each workload
+    WORKLOADS = (('prime', 1450), ('memcpy', 2150), ('flash', 3340))
+    # Wake-up latency of each mode, in us
+    LATENCIES = (('sleep0', 1.2), ('sleep1', 1.8), ('sleep2', 3.5),
+                 ('sleep3', 9.0), ('wait', 14.0), ('retention', 16.0))
+    BACKUP_LATENCY = 1900.0
+
+    def __init__(self, bm):
+        self.bm = bm
+        self.parser = FrameParser()
+
+    def status(self, ps, mode):
+        self.bm.feed(frame(BM_MCU_STATUS, bytes(
+            [POWER_SCALINGS[ps], SLEEP_MODES[mode], 0, 0xB7, 0x1B, 0x00, 6])))
+
+    def current(self, mode):
+        reply = self.parser.feed(self.bm.feed(
+            frame(BM_MCU_GET_CURRENT, bytes([SLEEP_MODES[mode]]))))
+        cmd, payload = reply[0]
+        assert cmd == BM_MCU_RET_CURRENT and len(payload) == 5
+        return struct.unpack('>I', payload[1:])[0]
+
+    def wake(self, latency_us):
+        """AST ticks since the alarm and CPU cycles until the next tick."""
+        wake = int(latency_us * 1e-6 * self.AST_HZ) + 1
+        cycles = round((wake / self.AST_HZ - latency_us * 1e-6) * self.CPU_HZ)
+        return wake, cycles
+
+    def lines(self):
+        yield 'BENCH BEGIN cpu_hz=%d ast_hz=%d' % (self.CPU_HZ, self.AST_HZ)
+        for ps in (0, 1):
+            for name, cycles_per_op in self.WORKLOADS:
+                self.status(ps, 'run')
+                ops = self.RUN_TICKS * self.CPU_HZ // (self.AST_HZ *
+                                                       cycles_per_op)
+                yield 'BENCH RUN ps=%d wl=%s ops=%d ticks=%d cur=0x%08x' % (
+                    ps, name, ops, self.RUN_TICKS, self.current('run'))
+            for name, latency in self.LATENCIES:
+                self.status(ps, name)
+                wake, cycles = self.wake(latency)
+                yield ('BENCH SLEEP ps=%d mode=%s ticks=%d wake=%d cycles=%d'
+                       ' cur=0x%08x' % (ps, name, self.SLEEP_TICKS, wake,
+                                        cycles, self.current(name)))
+        self.status(1, 'backup')
+        yield '-- BPM Example --'
+        wake, _ = self.wake(self.BACKUP_LATENCY)
+        yield ('BENCH SLEEP ps=1 mode=backup ticks=%d wake=%d cycles=0'
+               ' cur=0x%08x' % (self.SLEEP_TICKS, wake,
+                                self.current('backup')))
+        yield 'BENCH END'
+
+
+def parse(lines):
+    """Return the BEGIN fields and the RUN and SLEEP records."""
+    begin, runs, sleeps = None, [], []
+    for line in lines:
+        m = RECORD.search(line)
+        if not m:
+            continue
+        fields = dict(f.split('=', 1) for f in m.group(2).split())
+        if m.group(1) == 'BEGIN':
+            begin = {k: int(v) for k, v in fields.items()}
+        elif m.group(1) == 'RUN':
+            runs.append(fields)
+        elif m.group(1) == 'SLEEP':
+            sleeps.append(fields)
+        elif m.group(1) == 'END':
+            break
+    if begin is None:
+        raise ValueError('no BENCH BEGIN record')
+    return begin, runs, sleeps
+
+
+def current_a(field, unit):
+    return struct.unpack('>f', struct.pack('>I', int(field, 16)))[0] * \
+        CURRENT_UNITS[unit]
+
+
+def report(begin, runs, sleeps, vdd, unit):
+    """Compute the results of the records."""
+    cpu_hz, ast_hz = begin['cpu_hz'], begin['ast_hz']
+    results = []
+    for r in runs:
+        seconds = int(r['ticks']) / ast_hz
+        ops = int(r['ops'])
+        current = current_a(r['cur'], unit)
+        results.append({
+            'step': 'run', 'ps': int(r['ps']), 'name': r['wl'],
+            'ops_per_s': ops / seconds, 'current_ma': current * 1e3,
+            'uj_per_op': vdd * current * seconds / ops * 1e6,
+        })
+    for s in sleeps:
+        current = current_a(s['cur'], unit)
+        latency = int(s['wake']) / ast_hz - int(s['cycles']) / cpu_hz
+        results.append({
+            'step': 'sleep', 'ps': int(s['ps']), 'name': s['mode'],
+            'current_ma': current * 1e3, 'latency_us': latency * 1e6,
+        })
+    return results
+
+
+def print_report(results, out):
+    out.write('%-5s %-2s %-10s %12s %12s %12s %12s\n' % (
+        'step', 'ps', 'name', 'ops/s', 'mA', 'uJ/op', 'wakeup us'))
+    for r in results:
+        out.write('%-5s %-2d %-10s %12s %12.4f %12s %12s\n' % (
+            r['step'], r['ps'], r['name'],
+            '%.0f' % r['ops_per_s'] if 'ops_per_s' in r else '-',
+            r['current_ma'],
+            '%.4f' % r['uj_per_op'] if 'uj_per_op' in r else '-',
+            '%.1f' % r['latency_us'] if 'latency_us' in r else '-'))
+
+
+def check(results, vdd):
+    """Compare the report of a --sim run with the model."""
+    errors = []
+    model = SimTarget
+    for r in results:
+        ps = r['ps']
+        if r['step'] == 'run':
+            cycles = dict(model.WORKLOADS)[r['name']]
+            expected = vdd * BoardMonitorSim.CURRENTS['run'][ps] * 1e-6 * \
+                cycles / model.CPU_HZ * 1e6
+            if abs(r['uj_per_op'] - expected) > expected * 0.01:
+                errors.append('%s ps%d: %.5f uJ/op, expected %.5f' % (
+                    r['name'], ps, r['uj_per_op'], expected))
+        else:
+            expected = dict(model.LATENCIES).get(r['name'],
+                                                 model.BACKUP_LATENCY)
+            tolerance = 1e6 / model.AST_HZ if r['name'] == 'backup' else 0.1
+            if abs(r['latency_us'] - expected) > tolerance:
+                errors.append('%s ps%d: %.2f us, expected %.2f' % (
+                    r['name'], ps, r['latency_us'], expected))
+        current = BoardMonitorSim.CURRENTS[
+            'run' if r['step'] == 'run' else r['name']][ps] * 1e-3
+        if abs(r['current_ma'] - current) > current * 1e-6:
+            errors.append('%s ps%d: %.4f mA, expected %.4f' % (
+                r['name'], ps, r['current_ma'], current))
+    return errors
+
+
+def serve_board_monitor(port, stop):
+    """Answer the board monitor frames on a serial port until stopped."""
+    bm = BoardMonitorSim()
+    while not stop.is_set():
+        data = port.read(64)
+        if data:
+            port.write(bm.feed(data))
+
+
+def target_lines(port, timeout):
+    """Start the benchmark and yield the console lines until BENCH END."""
+    port.reset_input_buffer()
+    port.write(b'b')
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        line = port.readline().decode('ascii', 'replace').strip()
+        if line:
+            yield line
+            if line == 'BENCH END':
+                return
+    raise TimeoutError('no BENCH END record within %d s' % timeout)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--port', help='console serial port of the board')
+    source.add_argument('--sim', action='store_true',
+                        help='run the firmware model instead of a board')
+    source.add_argument('--log', help='parse a console capture')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--bm-port',
+                        help='serve a simulated board monitor on this port')
+    parser.add_argument('--timeout', type=int, default=120,
+                        help='seconds allowed for the benchmark')
+    parser.add_argument('--vdd', type=float, default=3.3,
+                        help='supply voltage of the measured current')
+    parser.add_argument('--current-unit', choices=sorted(CURRENT_UNITS),
+                        default='uA', help='unit of the board monitor current')
+    parser.add_argument('--check', action='store_true',
+                        help='with --sim, fail unless the report matches')
+    args = parser.parse_args()
+    if args.check and not args.sim:
+        parser.error('--check requires --sim')
+
+    stop = threading.Event()
+    if args.bm_port:
+        import serial
+        bm_port = serial.Serial(args.bm_port, 115200, timeout=0.1)
+        threading.Thread(target=serve_board_monitor, args=(bm_port, stop),
+                         daemon=True).start()
+    try:
+        if args.sim:
+            lines = list(SimTarget(BoardMonitorSim()).lines())
+        elif args.log:
+            with open(args.log, errors='replace') as f:
+                lines = f.read().splitlines()
+        else:
+            import serial
+            with serial.Serial(args.port, args.baud, timeout=1) as port:
+                lines = list(target_lines(port, args.timeout))
+    finally:
+        stop.set()
+
+    results = report(*parse(lines), vdd=args.vdd, unit=args.current_unit)
+    print_report(results, sys.stdout)
+
+    if args.check:
+        errors = check(results, args.vdd)
+        for e in errors:
+            sys.stderr.write('mismatch: %s\n' % e)
+        return 1 if errors else 0
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
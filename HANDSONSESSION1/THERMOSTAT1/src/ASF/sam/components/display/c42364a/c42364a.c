@@ -41,10 +41,123 @@
  *
  */
 
+#include <string.h>
 #include "compiler.h"
 #include "c42364a.h"
 #include "lcdca.h"
 
+/** Character code the digit decoder displays as a blank digit */
+#define C42364A_7SEG_BLANK 0x0F
+
+/**
+ * Pixels of each 7-segment digit, two bits (SEGn, SEGn+1) per COM line,
+ * COM0 in the lowest bits. Captured from the LCDCA digit decoder at init.
+ */
+static uint8_t c42364a_digit_seg[10];
+/** Pixels used by any digit, i.e. without the decimal point */
+static uint8_t c42364a_digit_mask;
+/** First segment (SEGn) of each digit position of the numeric field */
+static uint8_t c42364a_digit_pos[C42364A_WIDTH_7SEG_4C];
+
+/**
+ * \brief Read the pixels of a digit from the display memory.
+ *
+ * \param seg First segment of the digit.
+ */
+static uint8_t c42364a_read_digit(uint8_t seg)
+{
+	uint8_t pattern = 0;
+	uint8_t com;
+
+	for (com = 0; com < C42364A_NB_OF_COM; com++) {
+		if (lcdca_get_pixel(com, seg)) {
+			pattern |= 1 << (2 * com);
+		}
+		if (lcdca_get_pixel(com, seg + 1)) {
+			pattern |= 2 << (2 * com);
+		}
+	}
+	return pattern;
+}
+
+/**
+ * \brief Build the digit segment table.
+ *
+ * Each digit is decoded once by the LCDCA digit decoder and read back from
+ * the display memory, so later updates are plain table lookups composed in
+ * the shadow display memory. Must run while the numeric field is blank.
+ */
+static void c42364a_digit_table_init(void)
+{
+	uint8_t data[C42364A_WIDTH_7SEG_4C];
+	uint8_t pos;
+	uint8_t seg;
+	uint8_t com;
+	uint8_t d;
+
+	/* Locate each digit position by showing an '8' in it. */
+	for (pos = 0; pos < C42364A_WIDTH_7SEG_4C; pos++) {
+		memset(data, C42364A_7SEG_BLANK, sizeof(data));
+		data[pos] = '8';
+		c42364a_write_num_packet(data);
+		for (seg = 0; seg < C42364A_NB_OF_SEG; seg++) {
+			for (com = 0; com < C42364A_NB_OF_COM; com++) {
+				if (lcdca_get_pixel(com, seg)) {
+					break;
+				}
+			}
+			if (com < C42364A_NB_OF_COM) {
+				break;
+			}
+		}
+		c42364a_digit_pos[pos] = seg;
+	}
+
+	memset(data, C42364A_7SEG_BLANK, sizeof(data));
+	c42364a_digit_mask = 0;
+	for (d = 0; d < 10; d++) {
+		data[0] = '0' + d;
+		c42364a_write_num_packet(data);
+		c42364a_digit_seg[d] = c42364a_read_digit(c42364a_digit_pos[0]);
+		c42364a_digit_mask |= c42364a_digit_seg[d];
+	}
+
+	data[0] = C42364A_7SEG_BLANK;
+	c42364a_write_num_packet(data);
+}
+
+/**
+ * \brief Queue the pixels of one digit position in the shadow memory.
+ *
+ * \param pos     Digit position, 0 being the leftmost.
+ * \param pattern Pixels from c42364a_digit_seg, 0 for a blank digit.
+ */
+static void c42364a_shadow_digit(uint8_t pos, uint8_t pattern)
+{
+	uint8_t seg = c42364a_digit_pos[pos];
+	uint8_t com;
+
+	for (com = 0; com < C42364A_NB_OF_COM; com++) {
+		uint8_t shift = 2 * com;
+
+		lcdca_shadow_write(com,
+				(uint64_t)((c42364a_digit_mask >> shift) & 3) << seg,
+				(uint64_t)((pattern >> shift) & 3) << seg);
+	}
+}
+
+/**
+ * \brief Write the queued pixel updates to the display.
+ */
+static void c42364a_commit(void)
+{
+#ifdef CONF_C42364A_FRAME_SYNC
+	lcdca_shadow_commit_on_frame();
+#else
+	lcdca_shadow_commit();
+#endif
+}
+
 void c42364a_init(void)
 {
 	struct lcdca_config lcdca_cfg;
@@ -65,6 +178,7 @@ void c42364a_init(void)
 	lcdca_enable_timer(LCDCA_TIMER_FC0);
 	lcdca_enable_timer(LCDCA_TIMER_FC1);
 	lcdca_enable_timer(LCDCA_TIMER_FC2);
+	c42364a_digit_table_init();
 }
 
 void c42364a_show_all(void)
@@ -93,13 +207,15 @@ void c42364a_clear_text(void)
 
 void c42364a_clear_numeric_dec(void)
 {
-	uint8_t clear_data[4] = {0x0F, 0x0F, 0x0F, 0x0F};
+	uint8_t pos;
 
-	lcdca_clear_pixel(C42364A_ICON_MINUS);
-	lcdca_clear_pixel(C42364A_ICON_MINUS_SEG1);
-	lcdca_clear_pixel(C42364A_ICON_MINUS_SEG2);
-	lcdca_write_packet(LCDCA_TDG_7SEG4COM, C42364A_FIRST_7SEG_4C,
-			clear_data, C42364A_WIDTH_7SEG_4C, LCDCA_CMCFG_DREV_LEFT);
+	lcdca_shadow_clear_pixel(C42364A_ICON_MINUS);
+	lcdca_shadow_clear_pixel(C42364A_ICON_MINUS_SEG1);
+	lcdca_shadow_clear_pixel(C42364A_ICON_MINUS_SEG2);
+	for (pos = 0; pos < C42364A_WIDTH_7SEG_4C; pos++) {
+		c42364a_shadow_digit(pos, 0);
+	}
+	c42364a_commit();
 }
 
 void c42364a_blink_icon_start(uint8_t icon_com, uint8_t icon_seg)
@@ -148,48 +264,58 @@ void c42364a_circular_animation_start(uint8_t csr_dir,
 
 void c42364a_show_battery(enum c42364a_battery_value val)
 {
-	lcdca_clear_pixel(C42364A_ICON_BAT_LEVEL_1);
-	lcdca_clear_pixel(C42364A_ICON_BAT_LEVEL_2);
-	lcdca_clear_pixel(C42364A_ICON_BAT_LEVEL_3);
-	lcdca_set_pixel(C42364A_ICON_BAT);
+	lcdca_shadow_clear_pixel(C42364A_ICON_BAT_LEVEL_1);
+	lcdca_shadow_clear_pixel(C42364A_ICON_BAT_LEVEL_2);
+	lcdca_shadow_clear_pixel(C42364A_ICON_BAT_LEVEL_3);
+	lcdca_shadow_set_pixel(C42364A_ICON_BAT);
 	if (val > 2) {
-		lcdca_set_pixel(C42364A_ICON_BAT_LEVEL_3);
+		lcdca_shadow_set_pixel(C42364A_ICON_BAT_LEVEL_3);
 	}
 	if (val > 1) {
-		lcdca_set_pixel(C42364A_ICON_BAT_LEVEL_2);
+		lcdca_shadow_set_pixel(C42364A_ICON_BAT_LEVEL_2);
 	}
 	if (val > 0) {
-		lcdca_set_pixel(C42364A_ICON_BAT_LEVEL_1);
+		lcdca_shadow_set_pixel(C42364A_ICON_BAT_LEVEL_1);
 	}
+	c42364a_commit();
 }
 
 void c42364a_show_numeric_dec(int32_t value)
 {
-	uint8_t lcd_num[5];
+	uint8_t i;
 
 	Assert(value > -20000);
 	Assert(value < 20000);
 
 	if(value < 0) {
-		lcdca_set_pixel(C42364A_ICON_MINUS);
+		lcdca_shadow_set_pixel(C42364A_ICON_MINUS);
 	} else {
-		lcdca_clear_pixel(C42364A_ICON_MINUS);
+		lcdca_shadow_clear_pixel(C42364A_ICON_MINUS);
 	}
 
 	value = Abs(value);
 
 	if(value > 9999) {
 		value -= 10000;
-		lcdca_set_pixel(C42364A_ICON_MINUS_SEG1);
-		lcdca_set_pixel(C42364A_ICON_MINUS_SEG2);
+		lcdca_shadow_set_pixel(C42364A_ICON_MINUS_SEG1);
+		lcdca_shadow_set_pixel(C42364A_ICON_MINUS_SEG2);
 	} else {
-		lcdca_clear_pixel(C42364A_ICON_MINUS_SEG1);
-		lcdca_clear_pixel(C42364A_ICON_MINUS_SEG2);
+		lcdca_shadow_clear_pixel(C42364A_ICON_MINUS_SEG1);
+		lcdca_shadow_clear_pixel(C42364A_ICON_MINUS_SEG2);
 	}
 
-	sprintf((char*)lcd_num, "%4d", (int)value);
+	/* Rightmost digit first, leading zeros are blank as with "%4d" */
+	for (i = 0; i < C42364A_WIDTH_7SEG_4C; i++) {
+		uint8_t pattern = 0;
+
+		if ((value != 0) || (i == 0)) {
+			pattern = c42364a_digit_seg[value % 10];
+			value /= 10;
+		}
+		c42364a_shadow_digit(C42364A_WIDTH_7SEG_4C - 1 - i, pattern);
+	}
 
-	c42364a_write_num_packet((uint8_t const*)&lcd_num);
+	c42364a_commit();
 }
 
 void c42364a_text_scrolling_start(const uint8_t *data, uint32_t length)
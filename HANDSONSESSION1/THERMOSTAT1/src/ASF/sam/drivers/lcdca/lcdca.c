@@ -57,6 +57,19 @@
  */
 lcdca_callback_t lcdca_callback_pointer = NULL;
 
+/**
+ * \internal
+ * \brief Pending display memory updates per COM line.
+ */
+static uint64_t lcdca_shadow_data[LCDCA_MAX_NR_OF_COM];
+static uint64_t lcdca_shadow_mask[LCDCA_MAX_NR_OF_COM];
+
+/**
+ * \internal
+ * \brief Set when the frame interrupt is to commit the shadow.
+ */
+static volatile bool lcdca_shadow_on_frame = false;
+
 void lcdca_clk_init(void)
 {
 	/* Enable APB clock for LCDCA */
@@ -418,6 +431,73 @@ bool lcdca_get_pixel(uint8_t pix_com, uint8_t pix_seg)
 	return register_value & ((uint64_t)1 << pix_seg);
 }
 
+void lcdca_shadow_write(uint8_t pix_com, uint64_t mask, uint64_t data)
+{
+	irqflags_t flags;
+
+	if (pix_com >= LCDCA_MAX_NR_OF_COM) {
+		return;
+	}
+
+	flags = cpu_irq_save();
+	lcdca_shadow_data[pix_com] = (lcdca_shadow_data[pix_com] & ~mask) |
+			(data & mask);
+	lcdca_shadow_mask[pix_com] |= mask;
+	cpu_irq_restore(flags);
+}
+
+void lcdca_shadow_commit(void)
+{
+	irqflags_t flags;
+	uint8_t i;
+
+	flags = cpu_irq_save();
+	for (i = 0; i < LCDCA_MAX_NR_OF_COM; i++) {
+		uint64_t mask = lcdca_shadow_mask[i];
+		uint64_t register_value;
+
+		if (mask == 0) {
+			continue;
+		}
+		register_value = lcdca_get_pixel_register(i);
+		register_value = (register_value & ~mask) |
+				(lcdca_shadow_data[i] & mask);
+		switch (i) {
+		case 0:
+			LCDCA->LCDCA_DRL0 = register_value;
+			LCDCA->LCDCA_DRH0 = (register_value >> 32);
+			break;
+
+		case 1:
+			LCDCA->LCDCA_DRL1 = register_value;
+			LCDCA->LCDCA_DRH1 = (register_value >> 32);
+			break;
+
+		case 2:
+			LCDCA->LCDCA_DRL2 = register_value;
+			LCDCA->LCDCA_DRH2 = (register_value >> 32);
+			break;
+
+		case 3:
+			LCDCA->LCDCA_DRL3 = register_value;
+			LCDCA->LCDCA_DRH3 = (register_value >> 32);
+			break;
+		}
+		lcdca_shadow_mask[i] = 0;
+	}
+	lcdca_shadow_on_frame = false;
+	cpu_irq_restore(flags);
+}
+
+void lcdca_shadow_commit_on_frame(void)
+{
+	lcdca_shadow_on_frame = true;
+	NVIC_ClearPendingIRQ(LCDCA_IRQn);
+	NVIC_EnableIRQ(LCDCA_IRQn);
+	lcdca_clear_status();
+	lcdca_enable_interrupt();
+}
+
 void lcdca_set_callback(lcdca_callback_t callback,
 		uint8_t irq_line, uint8_t irq_level)
 {
@@ -433,6 +513,13 @@ void LCDCA_Handler(void)
 	/* Clear interrupt flags */
 	lcdca_clear_status();
 
+	if (lcdca_shadow_on_frame) {
+		lcdca_shadow_commit();
+		if (lcdca_callback_pointer == NULL) {
+			lcdca_disable_interrupt();
+		}
+	}
+
 	/* Interrupt handler */
 	if (lcdca_callback_pointer != NULL) {
 		lcdca_callback_pointer();
@@ -526,6 +526,63 @@ void lcdca_toggle_pixel(uint8_t pix_com, uint8_t pix_seg);
  */
 bool lcdca_get_pixel(uint8_t pix_com, uint8_t pix_seg);
 
+/**
+ * \name Shadow Display Memory
+ *
+ * Pixel updates are collected in RAM and written to the display memory in
+ * one pass, one read-modify-write per COM line that has pending changes.
+ * Only the pixels written through the shadow are touched, so segments
+ * driven by the character decoder, blinking or circular shift stay intact.
+ * @{
+ */
+
+/**
+ * \brief Queue a display memory update for one COM line.
+ *
+ * \param  pix_com  COM line to update.
+ * \param  mask     Segments to update, bit y for SEGy.
+ * \param  data     New state of the segments selected by \a mask.
+ */
+void lcdca_shadow_write(uint8_t pix_com, uint64_t mask, uint64_t data);
+
+/**
+ * \brief Queue setting a pixel (icon).
+ *
+ * \param  pix_com  Pixel coordinate - COMx - of the pixel (icon).
+ * \param  pix_seg  Pixel coordinate - SEGy - of the pixel (icon).
+ */
+static inline void lcdca_shadow_set_pixel(uint8_t pix_com, uint8_t pix_seg)
+{
+	lcdca_shadow_write(pix_com, (uint64_t)1 << pix_seg,
+			(uint64_t)1 << pix_seg);
+}
+
+/**
+ * \brief Queue clearing a pixel (icon).
+ *
+ * \param  pix_com  Pixel coordinate - COMx - of the pixel (icon).
+ * \param  pix_seg  Pixel coordinate - SEGy - of the pixel (icon).
+ */
+static inline void lcdca_shadow_clear_pixel(uint8_t pix_com, uint8_t pix_seg)
+{
+	lcdca_shadow_write(pix_com, (uint64_t)1 << pix_seg, 0);
+}
+
+/**
+ * \brief Write all queued updates to the display memory now.
+ */
+void lcdca_shadow_commit(void);
+
+/**
+ * \brief Write all queued updates from the next frame interrupt.
+ *
+ * Avoids changing the display memory in the middle of a frame. Updates
+ * queued before the interrupt occurs are included.
+ */
+void lcdca_shadow_commit_on_frame(void);
+
+/** @} */
+
 /**
  * \brief Enable LCDCA to wake up CPU.
  */
@@ -112,7 +112,13 @@ extern "C" {
 #endif
 /*@{*/
 
+void mac_sec_flush_cache(void);
 
+uint32_t mac_sec_fc_restore(void);
+
+void mac_sec_fc_set(uint32_t value);
+
+void mac_sec_fc_task(void);
 
 /*@}*/
 
@@ -247,6 +247,11 @@ bool mac_task(void)
 
     if (!mac_busy)
     {
+#ifdef MAC_SECURITY_ZIP
+        /* Persist the frame counter while no frame is in progress */
+        mac_sec_fc_task();
+#endif  /* MAC_SECURITY_ZIP */
+
         /* Check whether queue is empty */
         if (nhle_mac_q.size != 0)
         {
@@ -267,6 +267,9 @@ void dispatch_event(uint8_t *event)
      */
     uint8_t *buffer_body = BMM_BUFFER_POINTER((buffer_t *)event);
 
+    CACHE_PROF_BEGIN(CACHE_PROF_MAC_DISPATCH);
+    PAL_TRACE1(PAL_TRACE_MAC_DISPATCH, buffer_body[CMD_ID_OCTET]);
+
     /* Check is done to see if the message type is valid */
     /* Please note:
      * The macro PGM_READ_WORD is only relevant for AVR-GCC builds and
@@ -313,6 +316,8 @@ void dispatch_event(uint8_t *event)
         dispatch_rtb_event(event);
 }
 #endif  /* ENABLE_RTB */
+
+    CACHE_PROF_END(CACHE_PROF_MAC_DISPATCH);
 }
 /* EOF */
 
@@ -289,7 +289,9 @@ static void do_init_pib(void)
     mac_sec_pib.KeyTableEntries = macKeyTableEntries_def;
     mac_sec_pib.DeviceTableEntries = macDeviceTable_def;
     mac_sec_pib.SecurityLevelTableEntries = macSecurityLevelTable_def;
-    mac_sec_pib.FrameCounter = macFrameCounter_def;
+    /* Continue behind the last persisted frame counter reservation. */
+    mac_sec_pib.FrameCounter = mac_sec_fc_restore();
+    mac_sec_flush_cache();
 #endif  /* MAC_SECURITY_ZIP */
 
 #ifdef TEST_HARNESS
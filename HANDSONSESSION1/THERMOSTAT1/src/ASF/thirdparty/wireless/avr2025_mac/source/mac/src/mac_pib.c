@@ -563,7 +563,7 @@ retval_t mlme_set(uint8_t attribute, pib_value_t *attribute_value, bool set_trx_
             break;
 
         case macFrameCounter:
-            mac_sec_pib.FrameCounter = attribute_value->pib_value_32bit;
+            mac_sec_fc_set(attribute_value->pib_value_32bit);
             break;
 
         case macDefaultKeySource:
@@ -588,6 +588,17 @@ retval_t mlme_set(uint8_t attribute, pib_value_t *attribute_value, bool set_trx_
 #endif /* TEST_HARNESS */
     }
 
+#ifdef MAC_SECURITY_ZIP
+    /* Cached key and device lookups refer to the security tables. */
+    if ((MAC_SUCCESS == status) &&
+        ((macKeyTable == attribute) || (macKeyTableEntries == attribute) ||
+         (macDeviceTable == attribute) || (macDeviceTableEntries == attribute) ||
+         (macDefaultKeySource == attribute)))
+    {
+        mac_sec_flush_cache();
+    }
+#endif  /* MAC_SECURITY_ZIP */
+
     /*
      * In case the transceiver shall be forced back to sleep and
      * has been woken up, it is put back to sleep again.
@@ -61,6 +61,10 @@
 #include "stb.h"
 #include "mac_security.h"
 
+#ifndef STB_ON_SAL
+#error "MAC security requires the security toolbox (STB_ON_SAL)"
+#endif
+
 /* === Macros =============================================================== */
 
 /* Security Control Field: Security Level mask */
@@ -72,8 +76,67 @@
 /* Security Control Field: Key Identifier Field position */
 #define SEC_CTRL_KEY_ID_FIELD_POS       (3)
 
+/* Number of entries of the key lookup cache */
+#define KEY_CACHE_ENTRIES               (4)
+
+/* Number of entries of the source device cache */
+#define DEVICE_CACHE_ENTRIES            (4)
+
+/* Marks an unused cache entry */
+#define CACHE_ENTRY_UNUSED              (0xFF)
+
+/*
+ * Number of outgoing frame counter values reserved per flash write.
+ * After a restart the counter continues behind the last reservation, so at
+ * most this many values are skipped, but none is ever reused.
+ */
+#ifndef MAC_SEC_FC_RESERVE
+#define MAC_SEC_FC_RESERVE              (256)
+#endif
+
+/*
+ * The reservation is extended from mac_task() once fewer values than this
+ * are left in it, so secured frames never wait for a flash write.
+ */
+#define MAC_SEC_FC_LOW_WATER            (MAC_SEC_FC_RESERVE / 2)
+
+/* === Types =============================================================== */
+
+/* Result of a key lookup (7.5.8.2.5) for a given lookup data */
+typedef struct key_cache_entry_tag
+{
+    uint8_t lookup_data[9];
+    uint8_t lookup_data_size;           /* CACHE_ENTRY_UNUSED if unused */
+    mac_key_table_t *key_desc;
+} key_cache_entry_t;
+
+/* DeviceDescriptor of a frame originator and its precomputed nonce prefix */
+typedef struct device_cache_entry_tag
+{
+    uint8_t src_addr_mode;              /* CACHE_ENTRY_UNUSED if unused */
+    uint16_t src_panid;
+    uint64_t src_addr;
+    mac_key_table_t *key_desc;
+    mac_device_desc_t *device;
+    uint8_t nonce_prefix[8];            /* ExtAddress in nonce byte order */
+} device_cache_entry_t;
+
 /* === Globals ============================================================= */
 
+static key_cache_entry_t key_cache[KEY_CACHE_ENTRIES];
+static uint8_t key_cache_next;
+
+static device_cache_entry_t device_cache[DEVICE_CACHE_ENTRIES];
+static uint8_t device_cache_next;
+
+/* Nonce prefix of this device and the address it was computed from */
+static uint8_t own_nonce_prefix[8];
+static uint64_t own_nonce_addr;
+static bool own_nonce_valid;
+
+/* Outgoing frame counter values below this one are covered by flash */
+static uint32_t fc_reserved;
+
 /* === Prototypes ========================================================== */
 
 static uint8_t get_key_id_field_len(uint8_t key_id_mode);
@@ -88,9 +151,15 @@ static inline retval_t unsecure_frame(parse_t *mac_parse_data, uint8_t * mpdu, u
 
 static inline retval_t outgoing_key_retrieval(mcps_data_req_t *pmdr, uint8_t **key);
 
-static inline retval_t incoming_sec_material_retrieval(parse_t *mac_parse_data, uint8_t **key, uint8_t **addr);
+static inline retval_t incoming_sec_material_retrieval(parse_t *mac_parse_data, uint8_t **key, uint8_t **nonce_prefix);
+
+static void create_nonce(uint8_t *nonce_prefix, uint32_t frame_cnt, uint8_t security_level, uint8_t *nonce);
 
-static void create_nonce(uint8_t *ieee_addr, uint8_t *frame_cnt, uint8_t security_level, uint8_t *nonce);
+static void nonce_prefix_from_addr(uint64_t *ieee_addr, uint8_t *nonce_prefix);
+
+static retval_t key_lookup(uint8_t *lookup_data, uint8_t lookup_data_size, mac_key_table_t **key_desc);
+
+static retval_t fc_reserve(void);
 
 /* === Implementation ====================================================== */
 
@@ -181,28 +250,294 @@ static uint8_t get_mic_length(uint8_t security_level)
     }
 
 
-static void create_nonce(uint8_t *ieee_addr, uint8_t *frame_cnt, uint8_t security_level, uint8_t *nonce)
+/*
+ * The nonce (octets 1..13 of the block, see stb_ccm_secure()) is
+ * ExtAddress | FrameCounter | SecurityLevel, each most significant octet
+ * first. The address part is precomputed per device.
+ */
+static void nonce_prefix_from_addr(uint64_t *ieee_addr, uint8_t *nonce_prefix)
 {
-    /*
-     * Create Nonce - Attentation: byte order is inverse in comparison to RF4CE
-     * RF4CE: Little endian
-     */
-    uint8_t *ptr;
-    uint8_t *nonce_ptr = &nonce[1];
+    uint8_t *ptr = (uint8_t *)ieee_addr + 7;
 
-    ptr = ieee_addr;
-    ptr += 7;
     for (uint8_t i = 0; i < 8; i++)
     {
-        *nonce_ptr++ = *ptr--;
+        *nonce_prefix++ = *ptr--;
+    }
+}
+
+
+static void create_nonce(uint8_t *nonce_prefix, uint32_t frame_cnt, uint8_t security_level, uint8_t *nonce)
+{
+    memcpy(&nonce[1], nonce_prefix, 8);
+    nonce[9] = (uint8_t)(frame_cnt >> 24);
+    nonce[10] = (uint8_t)(frame_cnt >> 16);
+    nonce[11] = (uint8_t)(frame_cnt >> 8);
+    nonce[12] = (uint8_t)frame_cnt;
+    nonce[13] = security_level;   // Only security level NOT security control field
+}
+
+
+/* --- Key and Device Caches ----------------------------------------------- */
+
+
+/**
+ * @brief Invalidates the key and device caches
+ *
+ * Must be called whenever macKeyTable, macDeviceTable or
+ * macDefaultKeySource are changed.
+ */
+void mac_sec_flush_cache(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < KEY_CACHE_ENTRIES; i++)
+    {
+        key_cache[i].lookup_data_size = CACHE_ENTRY_UNUSED;
+    }
+    for (i = 0; i < DEVICE_CACHE_ENTRIES; i++)
+    {
+        device_cache[i].src_addr_mode = CACHE_ENTRY_UNUSED;
+    }
+    own_nonce_valid = false;
+}
+
+
+/*
+ * Key descriptor lookup procedure (7.5.8.2.5), served from the key cache
+ * if the same lookup data has been resolved before.
+ */
+static retval_t key_lookup(uint8_t *lookup_data, uint8_t lookup_data_size, mac_key_table_t **key_desc)
+{
+    uint8_t len;
+    uint8_t i;
+
+    switch (lookup_data_size)
+    {
+        case 0: len = 5; break;
+        case 1: len = 9; break;
+        default: return MAC_UNSUPPORTED_SECURITY;
+    }
+
+    for (i = 0; i < KEY_CACHE_ENTRIES; i++)
+    {
+        if ((key_cache[i].lookup_data_size == lookup_data_size) &&
+            (memcmp(key_cache[i].lookup_data, lookup_data, len) == 0))
+        {
+            *key_desc = key_cache[i].key_desc;
+            return MAC_SUCCESS;
+        }
+    }
+
+    // Get key from KeyDescriptor as 7.5.8.2.5
+    for (i = 0; i < mac_sec_pib.KeyTableEntries; i++)
+    {
+        for (uint8_t k = 0; k < mac_sec_pib.KeyTable[i].KeyIdLookupListEntries; k++)
+        {
+            if ((mac_sec_pib.KeyTable[i].KeyIdLookupList[k].LookupDataSize == lookup_data_size) &&
+                (memcmp(mac_sec_pib.KeyTable[i].KeyIdLookupList[k].LookupData,
+                        lookup_data, len) == 0))
+            {
+                key_cache_entry_t *entry = &key_cache[key_cache_next];
+
+                key_cache_next = (key_cache_next + 1) % KEY_CACHE_ENTRIES;
+                memcpy(entry->lookup_data, lookup_data, len);
+                entry->lookup_data_size = lookup_data_size;
+                entry->key_desc = &mac_sec_pib.KeyTable[i];
+
+                *key_desc = entry->key_desc;
+                return MAC_SUCCESS;
+            }
+        }
+    }
+
+    return MAC_UNAVAILABLE_KEY;
 }
-    ptr = frame_cnt;
-    ptr += 3;
-    for (uint8_t i = 0; i < 4; i++)
+
+
+/* Checks whether a DeviceDescriptor matches the originator of a frame. */
+static bool device_matches(mac_device_desc_t *device, parse_t *mac_parse_data)
+{
+    if (FCF_LONG_ADDR == mac_parse_data->src_addr_mode)
     {
-        *nonce_ptr++ = *ptr--;
+        return (device->ExtAddress == mac_parse_data->src_addr.long_address);
     }
-    *nonce_ptr = security_level;   // Only security level NOT security control field
+
+    return ((device->PANId == mac_parse_data->src_panid) &&
+            (device->ShortAddress == mac_parse_data->src_addr.short_address));
+}
+
+
+/*
+ * Device descriptor lookup procedure (7.5.8.2.6) for the originator of a
+ * received frame, served from the device cache if possible. Devices listed
+ * in the key's KeyDeviceList are searched first; a key without such a list
+ * is considered valid for every device of macDeviceTable.
+ */
+static retval_t device_lookup(parse_t *mac_parse_data, mac_key_table_t *key_desc,
+                              device_cache_entry_t **device_entry)
+{
+    mac_device_desc_t *device = NULL;
+    device_cache_entry_t *entry;
+    uint64_t src_addr;
+    uint8_t i;
+
+    if (FCF_LONG_ADDR == mac_parse_data->src_addr_mode)
+    {
+        src_addr = mac_parse_data->src_addr.long_address;
+    }
+    else
+    {
+        src_addr = mac_parse_data->src_addr.short_address;
+    }
+
+    for (i = 0; i < DEVICE_CACHE_ENTRIES; i++)
+    {
+        entry = &device_cache[i];
+        if ((entry->src_addr_mode == mac_parse_data->src_addr_mode) &&
+            (entry->src_addr == src_addr) &&
+            (entry->src_panid == mac_parse_data->src_panid) &&
+            (entry->key_desc == key_desc))
+        {
+            *device_entry = entry;
+            return MAC_SUCCESS;
+        }
+    }
+
+    if (key_desc->KeyDeviceListEntries > 0)
+    {
+        for (i = 0; i < key_desc->KeyDeviceListEntries; i++)
+        {
+            uint8_t handle = key_desc->KeyDeviceList[i].DeviceDescriptorHandle;
+
+            if ((handle < mac_sec_pib.DeviceTableEntries) &&
+                device_matches(&mac_sec_pib.DeviceTable[handle].DeviceDescriptor[0], mac_parse_data))
+            {
+                if (key_desc->KeyDeviceList[i].BlackListed)
+                {
+                    return MAC_UNAVAILABLE_KEY;
+                }
+                device = &mac_sec_pib.DeviceTable[handle].DeviceDescriptor[0];
+                break;
+            }
+        }
+    }
+    else
+    {
+        for (i = 0; i < mac_sec_pib.DeviceTableEntries; i++)
+        {
+            if (device_matches(&mac_sec_pib.DeviceTable[i].DeviceDescriptor[0], mac_parse_data))
+            {
+                device = &mac_sec_pib.DeviceTable[i].DeviceDescriptor[0];
+                break;
+            }
+        }
+    }
+
+    if (NULL == device)
+    {
+        return MAC_UNAVAILABLE_KEY;
+    }
+
+    entry = &device_cache[device_cache_next];
+    device_cache_next = (device_cache_next + 1) % DEVICE_CACHE_ENTRIES;
+    entry->src_addr_mode = mac_parse_data->src_addr_mode;
+    entry->src_addr = src_addr;
+    entry->src_panid = mac_parse_data->src_panid;
+    entry->key_desc = key_desc;
+    entry->device = device;
+    nonce_prefix_from_addr(&device->ExtAddress, entry->nonce_prefix);
+
+    *device_entry = entry;
+    return MAC_SUCCESS;
+}
+
+
+/* --- Frame Counter Persistence ------------------------------------------- */
+
+
+/*
+ * Extends the reservation in flash to MAC_SEC_FC_RESERVE values beyond the
+ * current outgoing frame counter, once fewer than MAC_SEC_FC_LOW_WATER
+ * values are left.
+ */
+static retval_t fc_reserve(void)
+{
+    uint32_t reserve;
+
+    if ((mac_sec_pib.FrameCounter < fc_reserved) &&
+        ((fc_reserved - mac_sec_pib.FrameCounter) > MAC_SEC_FC_LOW_WATER))
+    {
+        return MAC_SUCCESS;
+    }
+    if (fc_reserved == 0xFFFFFFFF)
+    {
+        /* Nothing left to reserve */
+        return MAC_SUCCESS;
+    }
+
+    reserve = mac_sec_pib.FrameCounter + MAC_SEC_FC_RESERVE;
+    if (reserve < mac_sec_pib.FrameCounter)
+    {
+        reserve = 0xFFFFFFFF;
+    }
+
+    if (MAC_SUCCESS != pal_ps_counter_set(reserve))
+    {
+        return MAC_COUNTER_ERROR;
+    }
+
+    fc_reserved = reserve;
+    return MAC_SUCCESS;
+}
+
+
+/**
+ * @brief Restores the outgoing frame counter after a reset
+ *
+ * The counter continues at the end of the last reservation, and the first
+ * reservation of this run is persisted right away.
+ *
+ * @return The first frame counter value that has certainly not been used
+ *         before, or macFrameCounter_def if nothing has been persisted.
+ */
+uint32_t mac_sec_fc_restore(void)
+{
+    uint32_t value;
+
+    if (MAC_SUCCESS != pal_ps_counter_get(&value))
+    {
+        value = macFrameCounter_def;
+    }
+
+    mac_sec_pib.FrameCounter = value;
+    fc_reserved = value;
+    fc_reserve();
+    return value;
+}
+
+
+/**
+ * @brief Handles a new value of macFrameCounter set by the upper layer
+ *
+ * The reservation starting at this value is persisted by the next call of
+ * mac_sec_fc_task(); secured frames fail with MAC_COUNTER_ERROR until then.
+ */
+void mac_sec_fc_set(uint32_t value)
+{
+    mac_sec_pib.FrameCounter = value;
+    fc_reserved = value;
+}
+
+
+/**
+ * @brief Persists the next frame counter reservation ahead of time
+ *
+ * Called from mac_task() while the MAC is idle, so that the flash erase and
+ * write never delay a frame with the transceiver armed.
+ */
+void mac_sec_fc_task(void)
+{
+    fc_reserve();
 }
 
 
@@ -243,6 +578,11 @@ retval_t mac_build_aux_sec_header(uint8_t **frame_ptr, mcps_data_req_t *pmdr, ui
     {
         return MAC_COUNTER_ERROR;
     }
+    else if (mac_sec_pib.FrameCounter >= fc_reserved)
+    {
+        /* Not covered by flash yet, see mac_sec_fc_task() */
+        return MAC_COUNTER_ERROR;
+    }
     else
     {
         memcpy(sec_msdu_ptr, &mac_sec_pib.FrameCounter, 4);
@@ -295,10 +635,15 @@ retval_t mac_secure(frame_info_t *frame, uint8_t *mac_payload_ptr, mcps_data_req
 
     /* Encrypt payload data */
     uint8_t nonce[AES_BLOCKSIZE];
-    uint8_t enc_data[aMaxPHYPacketSize - FCS_LEN + AES_BLOCKSIZE];
-    /* Extra AES Bloc size at end required for MIC generation. */
 
-    create_nonce((uint8_t *)&tal_pib.IeeeAddress, (uint8_t *)&mac_sec_pib.FrameCounter, pmdr->SecurityLevel, nonce);
+    if (!own_nonce_valid || (own_nonce_addr != tal_pib.IeeeAddress))
+    {
+        own_nonce_addr = tal_pib.IeeeAddress;
+        nonce_prefix_from_addr(&own_nonce_addr, own_nonce_prefix);
+        own_nonce_valid = true;
+    }
+
+    create_nonce(own_nonce_prefix, mac_sec_pib.FrameCounter, pmdr->SecurityLevel, nonce);
 
 /*
      * Create string a
@@ -306,32 +651,39 @@ retval_t mac_secure(frame_info_t *frame, uint8_t *mac_payload_ptr, mcps_data_req
      * = FCF (2) | SeqNo (1) | AddrFields
  */
     uint8_t hdr_len = mac_payload_ptr - &frame->mpdu[1] - m;
-    memcpy(enc_data, &frame->mpdu[1], hdr_len);
 
     switch (frame->mpdu[1] & 0x03)   // FCF
     {
         case FCF_FRAMETYPE_DATA:                  //(0x01)
-            /* Append payload (string m) */
-            memcpy(&enc_data[hdr_len], mac_payload_ptr, pmdr->msduLength);
+            /*
+             * The frame is secured in place: the payload is moved directly
+             * behind the header (string a), so that the MIC appended by
+             * the toolbox ends exactly where the plaintext payload ended.
+             */
+            memmove(mac_payload_ptr - m, mac_payload_ptr, pmdr->msduLength);
             {
                 uint8_t *current_key;
 
                 /* Shall the real key be used or rather a test key? */
                     current_key = key;
 
-                stb_ccm_secure(enc_data, /* plaintext header (string a) and payload concatenated */
+                /* The AES engine of the transceiver is only accessible while awake. */
+                mac_trx_wakeup();
+
+                if (stb_ccm_secure(&frame->mpdu[1], /* plaintext header (string a) and payload concatenated */
                            nonce,
                            current_key, /*security_key */
                            hdr_len, /* plaintext header length */
                            pmdr->msduLength, /* Length of payload to be encrypted */
                            pmdr->SecurityLevel, /* security level */
-                           AES_DIR_ENCRYPT);
+                           AES_DIR_ENCRYPT)
+                    != STB_CCM_OK)
+                {
+                    return MAC_UNSUPPORTED_SECURITY;
+                }
             }
 
             mac_sec_pib.FrameCounter++;
-
-            /* Replace original payload by secured payload */
-            memcpy(mac_payload_ptr - m, &enc_data[hdr_len], pmdr->msduLength + m);
             break;
 
         default:
@@ -414,33 +766,14 @@ static inline retval_t outgoing_key_retrieval(mcps_data_req_t *pmdr, uint8_t **k
     }
 
     // Get key from KeyDescriptor as 7.5.8.2.5
-    for (uint8_t i = 0; i < mac_sec_pib.KeyTableEntries; i++)
-    {
-        for (uint8_t k = 0; k < mac_sec_pib.KeyTable[i].KeyIdLookupListEntries; k++)
-        {
-            if (mac_sec_pib.KeyTable[i].KeyIdLookupList[k].LookupDataSize == key_lookup_data_size)
-            {
-                int16_t compare;
-                uint8_t len;
+    mac_key_table_t *key_desc;
+    retval_t status = key_lookup(lookup_data, key_lookup_data_size, &key_desc);
 
-                switch(key_lookup_data_size)
-                {
-                    case 0: len = 5; break;
-                    case 1: len = 9; break;
-                    default: return MAC_UNSUPPORTED_SECURITY;
-                }
-                compare = memcmp(mac_sec_pib.KeyTable[i].KeyIdLookupList[k].LookupData,
-                                 lookup_data, len);
-                if (compare == 0x00)
-                {
-                    *key = mac_sec_pib.KeyTable[i].Key;
-                    return MAC_SUCCESS;
-                }
-            }
-        }
+    if (MAC_SUCCESS == status)
+    {
+        *key = key_desc->Key;
     }
-
-    return MAC_UNAVAILABLE_KEY;
+    return status;
 }
 
 
@@ -534,12 +867,12 @@ static inline retval_t unsecure_frame(parse_t *mac_parse_data, uint8_t * mpdu, u
 {
     /* Encrypt payload data */
     uint8_t nonce[AES_BLOCKSIZE];   // AES_BLOCKSIZE 16
-    uint8_t *src_ieee_addr;
+    uint8_t *nonce_prefix;
 
     /* Incoming key retrieval */
     uint8_t *key;
 
-        retval_t status = incoming_sec_material_retrieval(mac_parse_data, &key, &src_ieee_addr);
+        retval_t status = incoming_sec_material_retrieval(mac_parse_data, &key, &nonce_prefix);
         if (status != MAC_SUCCESS)
         {
             return status;
@@ -548,16 +881,13 @@ static inline retval_t unsecure_frame(parse_t *mac_parse_data, uint8_t * mpdu, u
     /*
      * Create Nonce - Attentation: byte order is inverse in comparison to RF4CE
      * RF4CE: Little endian
+     * The address part has been precomputed for the originating device.
      */
-    uint8_t *addr_ptr;
     uint8_t *current_key;   // Pointer to actually used key
 
-        /* Standard way of extracting Src IEEE address. */
-        addr_ptr = src_ieee_addr;
-
     uint8_t m = get_mic_length(mac_parse_data->sec_ctrl.sec_level);
 
-    create_nonce(addr_ptr, (uint8_t *)&mac_parse_data->frame_cnt, mac_parse_data->sec_ctrl.sec_level, nonce);
+    create_nonce(nonce_prefix, mac_parse_data->frame_cnt, mac_parse_data->sec_ctrl.sec_level, nonce);
 
     switch (mac_parse_data->frame_type)
     {
@@ -570,14 +900,26 @@ static inline retval_t unsecure_frame(parse_t *mac_parse_data, uint8_t * mpdu, u
             uint8_t mhr_len = mac_payload - mpdu + sec_hdr_len;
             uint8_t encryp_payload_len = mac_parse_data->mpdu_length - mhr_len - m - 2;  // 2 = CRC
 
-            if (stb_ccm_secure(mpdu, /* plaintext header (string a) and payload concatenated */
+            /* The AES engine of the transceiver is only accessible while awake. */
+            bool trx_was_sleeping = (RADIO_SLEEPING == mac_radio_sleep_state);
+            stb_ccm_t ccm_status;
+
+            mac_trx_wakeup();
+
+            ccm_status = stb_ccm_secure(mpdu, /* plaintext header (string a) and payload concatenated */
                        nonce,
                        current_key, /* security_key */
                        mhr_len, /* plaintext header length */
                        encryp_payload_len, /* Length of payload to be encrypted */
                        mac_parse_data->sec_ctrl.sec_level, /* security level */
-                       AES_DIR_DECRYPT)
-                == STB_CCM_OK)
+                       AES_DIR_DECRYPT);
+
+            if (trx_was_sleeping)
+            {
+                mac_sleep_trans();
+            }
+
+            if (ccm_status == STB_CCM_OK)
             {
                 /* Adjust payload by secured payload */
                 *payload_index = sec_hdr_len;
@@ -598,7 +940,7 @@ static inline retval_t unsecure_frame(parse_t *mac_parse_data, uint8_t * mpdu, u
 }
 
 
-static inline retval_t incoming_sec_material_retrieval(parse_t *mac_parse_data, uint8_t **key, uint8_t **addr)
+static inline retval_t incoming_sec_material_retrieval(parse_t *mac_parse_data, uint8_t **key, uint8_t **nonce_prefix)
 {
     /* @ToDo: Check a holy bunch of other stuff, see 7.5.8.2.3*/
 
@@ -651,34 +993,24 @@ static inline retval_t incoming_sec_material_retrieval(parse_t *mac_parse_data,
     }
 
     // Get key from KeyDescriptor as 7.5.8.2.5
-    for (uint8_t i = 0; i < mac_sec_pib.KeyTableEntries; i++)
+    mac_key_table_t *key_desc;
+    device_cache_entry_t *device_entry;
+    retval_t status = key_lookup(lookup_data, lookup_data_size, &key_desc);
+
+    if (MAC_SUCCESS != status)
     {
-        for (uint8_t k = 0; k < mac_sec_pib.KeyTable[i].KeyIdLookupListEntries; k++)
-        {
-            if (mac_sec_pib.KeyTable[i].KeyIdLookupList[k].LookupDataSize == lookup_data_size)
-            {
-                int16_t compare;
-                uint8_t len;
+        return status;
+    }
 
-                switch(lookup_data_size)
-                {
-                    case 0: len = 5; break;
-                    case 1: len = 9; break;
-                    default: return MAC_UNSUPPORTED_SECURITY;
-                }
-                compare = memcmp(mac_sec_pib.KeyTable[i].KeyIdLookupList[k].LookupData,
-                                 lookup_data, len);
-                if (compare == 0x00)
-                {
-                    *key = mac_sec_pib.KeyTable[i].Key;
-                    *addr = (uint8_t *)&mac_sec_pib.DeviceTable[i].DeviceDescriptor[i].ExtAddress;
-                    return MAC_SUCCESS;
-                }
-            }
-        }
+    status = device_lookup(mac_parse_data, key_desc, &device_entry);
+    if (MAC_SUCCESS != status)
+    {
+        return status;
     }
-    // No key has been found. */
-    return MAC_UNAVAILABLE_KEY;
+
+    *key = key_desc->Key;
+    *nonce_prefix = device_entry->nonce_prefix;
+    return MAC_SUCCESS;
 }
 
 
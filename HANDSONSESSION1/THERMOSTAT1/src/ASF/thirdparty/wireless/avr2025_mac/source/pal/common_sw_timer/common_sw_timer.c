@@ -55,6 +55,12 @@
  */
 volatile uint16_t sys_time;
 
+/*
+ * Time during which the timer counter was stopped in a deep sleep mode.
+ * It is added to the counter to give the system time.
+ */
+static uint32_t sys_time_offset;
+
 /*
  * This is the timer array.
  *
@@ -448,6 +454,60 @@ uint32_t sw_timer_get_time(void)
 }
 
 
+bool sw_timer_get_residual_time(uint32_t *residual)
+{
+    bool running = false;
+    irqflags_t flags = cpu_irq_save();
+
+    if ((NO_TIMER != expired_timer_queue_head) || timer_trigger)
+    {
+        /* A callback is already pending in sw_timer_service() */
+        *residual = 0;
+        running = true;
+    }
+    else if (NO_TIMER != running_timer_queue_head)
+    {
+        uint32_t now = gettime();
+        uint32_t point_in_time =
+            timer_array[running_timer_queue_head].abs_exp_timer;
+
+        if (compare_time(now, point_in_time))
+        {
+            *residual = SUB_TIME(point_in_time, now);
+        }
+        else
+        {
+            *residual = 0;
+        }
+        running = true;
+    }
+
+    cpu_irq_restore(flags);
+    return running;
+}
+
+
+void sw_timer_advance(uint32_t elapsed)
+{
+    irqflags_t flags = cpu_irq_save();
+
+    sys_time_offset += elapsed;
+
+    if (NO_TIMER != running_timer_queue_head)
+    {
+        /*
+         * A loaded compare was set for the counter value before the
+         * sleep and would now fire late; load it again from the new time.
+         */
+        common_tc_compare_stop();
+        timer_array[running_timer_queue_head].loaded = false;
+        load_hw_timer(running_timer_queue_head);
+    }
+
+    cpu_irq_restore(flags);
+}
+
+
 static inline bool compare_time(uint32_t t1, uint32_t t2)
 {
     return ((t2 - t1) < INT32_MAX);
@@ -472,7 +532,7 @@ static inline uint32_t gettime(void)
          */
     } while (current_sys_time != sys_time);
 
-    return current_time;
+    return current_time + sys_time_offset;
 }
 
 
@@ -487,7 +547,9 @@ static void prog_ocr(void)
     if (NO_TIMER != running_timer_queue_head && 
 		!timer_array[running_timer_queue_head].loaded)
     {
-        timeout = timer_array[running_timer_queue_head].abs_exp_timer;
+        /* The compare is done on the counter, without the offset */
+        timeout = timer_array[running_timer_queue_head].abs_exp_timer -
+                  sys_time_offset;
         timeout_high = (uint16_t)(timeout >> SYS_TIME_SHIFT_MASK);
 
         if (timeout_high == sys_time)
@@ -571,6 +633,7 @@ void sw_timer_init(void)
     running_timers = 0;
     timer_trigger = false;
     sys_time = 0;
+    sys_time_offset = 0;
 
     running_timer_queue_head = NO_TIMER;
     expired_timer_queue_head = NO_TIMER;
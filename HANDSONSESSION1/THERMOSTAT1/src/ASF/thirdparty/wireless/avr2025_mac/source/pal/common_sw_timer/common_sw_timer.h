@@ -173,6 +173,31 @@ status_code_t sw_timer_stop (uint8_t timer_id);
      */
 uint32_t sw_timer_get_time(void);
 
+    /**
+     * \brief Gets the time until the next timer expires
+     *
+     * This function returns the time left until the earliest running timer
+     * expires. A timer whose callback is still pending in
+     * sw_timer_service() counts as expiring now.
+     *
+     * \param[out] residual Time until the next expiry in microseconds
+     *
+     * \return True if a timer is running, false if \p residual is not set
+     */
+bool sw_timer_get_residual_time(uint32_t *residual);
+
+    /**
+     * \brief Advances the system time over a stop of the timer counter
+     *
+     * The timer counter is not clocked in the deeper sleep modes. After
+     * waking up from one of them the time spent asleep, measured with
+     * another clock, is added to the system time so that the running
+     * timers expire at the right time.
+     *
+     * \param elapsed Time the counter was stopped in microseconds
+     */
+void sw_timer_advance(uint32_t elapsed);
+
     /**
      * \brief Checks whether a given timer is running or not
      *
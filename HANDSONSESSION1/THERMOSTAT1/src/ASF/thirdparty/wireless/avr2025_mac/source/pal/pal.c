@@ -45,6 +45,7 @@
 #include "pal.h"
 #include "delay.h"
 #include "ioport.h"
+#include "flashcalw.h"
 
 bool pal_calibrate_rc_osc(void)
 {
@@ -157,20 +158,225 @@ bool pal_is_timer_running(uint8_t timer_id)
 /**
  * @brief Services timer and sio handler
  *
- * This function calls sio & timer handling functions.
+ * This function calls sio & timer handling functions and sends pending
+ * trace records.
  */
 void pal_task(void)
 {
     sw_timer_service();
+#ifdef ENABLE_TRACE
+    pal_trace_task();
+#endif
 }
 
 
+/**
+ * @brief Provides timestamp of the last transceiver interrupt
+ *
+ * The timestamp is the value of the free-running PAL timer latched on entry
+ * of the transceiver ISR (RX_START or TRX_END), so it does not include the
+ * time spent reading the IRQ status over SPI.
+ */
 void pal_trx_read_timestamp(uint32_t *timestamp)
 {
-    *timestamp  = sw_timer_get_time();
+#if (PAL_USE_SPI_TRX == 1) && ((defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP))
+    *timestamp = pal_trx_irq_time;
+#else
+    *timestamp = sw_timer_get_time();
+#endif
 }
 
+/**
+ * @brief Provides the current time of the free-running PAL timer
+ *
+ * This is the same timebase as used by pal_trx_read_timestamp().
+ */
 void pal_get_current_time(uint32_t *timer_count)
 {
     *timer_count = sw_timer_get_time();
 }
+
+
+/*
+ * Persistent counter log
+ *
+ * Each page starts with a header record holding its generation; the page
+ * with the highest valid generation is the active one. Values are appended
+ * as records of value and inverted value, so torn writes are detected. When
+ * the active page is full, the other page is erased and becomes active.
+ */
+
+/* Record of the counter log, one flash double word */
+typedef struct ps_counter_rec_tag
+{
+    uint32_t value;
+    uint32_t check;
+} ps_counter_rec_t;
+
+#define PS_COUNTER_RECS_PER_PAGE        (FLASH_PAGE_SIZE / sizeof(ps_counter_rec_t))
+
+/* Index of the active page, PS_COUNTER_PAGES if none is valid yet */
+static uint8_t ps_counter_active = PS_COUNTER_PAGES;
+
+/* Index of the next free record within the active page */
+static uint16_t ps_counter_next;
+
+/* Generation of the active page */
+static uint32_t ps_counter_gen;
+
+/* Indicates that the log has been scanned since reset */
+static bool ps_counter_scanned;
+
+static uint32_t ps_counter_page_number(uint8_t page)
+{
+    return flashcalw_get_page_count() - (STACK_FLASH_SIZE / FLASH_PAGE_SIZE) -
+           PS_COUNTER_PAGES + page;
+}
+
+static volatile ps_counter_rec_t *ps_counter_page(uint8_t page)
+{
+    return (volatile ps_counter_rec_t *)(FLASH_ADDR +
+                                         ps_counter_page_number(page) * FLASH_PAGE_SIZE);
+}
+
+static inline bool ps_counter_rec_valid(volatile ps_counter_rec_t *rec)
+{
+    return (rec->value == ~rec->check);
+}
+
+static inline bool ps_counter_rec_erased(volatile ps_counter_rec_t *rec)
+{
+    return ((rec->value == 0xFFFFFFFF) && (rec->check == 0xFFFFFFFF));
+}
+
+/* Returns the number of used records (incl. header) of a page */
+static uint16_t ps_counter_used(uint8_t page)
+{
+    volatile ps_counter_rec_t *rec = ps_counter_page(page);
+    uint16_t i;
+
+    for (i = 0; i < PS_COUNTER_RECS_PER_PAGE; i++)
+    {
+        if (ps_counter_rec_erased(&rec[i]))
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+/* Returns the last valid value record of a page */
+static bool ps_counter_last(uint8_t page, uint32_t *value)
+{
+    volatile ps_counter_rec_t *rec = ps_counter_page(page);
+    uint16_t i = ps_counter_used(page);
+
+    while (i > 1)
+    {
+        i--;
+        if (ps_counter_rec_valid(&rec[i]))
+        {
+            *value = rec[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void ps_counter_scan(void)
+{
+    uint8_t page;
+
+    ps_counter_active = PS_COUNTER_PAGES;
+    ps_counter_gen = 0;
+
+    for (page = 0; page < PS_COUNTER_PAGES; page++)
+    {
+        volatile ps_counter_rec_t *hdr = ps_counter_page(page);
+
+        if (ps_counter_rec_valid(hdr) &&
+            ((ps_counter_active == PS_COUNTER_PAGES) || (hdr->value > ps_counter_gen)))
+        {
+            ps_counter_active = page;
+            ps_counter_gen = hdr->value;
+        }
+    }
+
+    if (ps_counter_active < PS_COUNTER_PAGES)
+    {
+        ps_counter_next = ps_counter_used(ps_counter_active);
+    }
+    ps_counter_scanned = true;
+}
+
+retval_t pal_ps_counter_get(uint32_t *value)
+{
+    uint8_t page;
+
+    if (!ps_counter_scanned)
+    {
+        ps_counter_scan();
+    }
+
+    if (ps_counter_active == PS_COUNTER_PAGES)
+    {
+        return FAILURE;
+    }
+
+    if (ps_counter_last(ps_counter_active, value))
+    {
+        return MAC_SUCCESS;
+    }
+
+    /* Interrupted right after a page switch: use the previous page. */
+    for (page = 0; page < PS_COUNTER_PAGES; page++)
+    {
+        if ((page != ps_counter_active) && ps_counter_last(page, value))
+        {
+            return MAC_SUCCESS;
+        }
+    }
+    return FAILURE;
+}
+
+retval_t pal_ps_counter_set(uint32_t value)
+{
+    ps_counter_rec_t rec;
+
+    if (!ps_counter_scanned)
+    {
+        ps_counter_scan();
+    }
+
+    if ((ps_counter_active == PS_COUNTER_PAGES) ||
+        (ps_counter_next >= PS_COUNTER_RECS_PER_PAGE))
+    {
+        uint8_t page = (ps_counter_active + 1) % PS_COUNTER_PAGES;
+
+        if (!flashcalw_erase_page(ps_counter_page_number(page), true))
+        {
+            return FAILURE;
+        }
+        ps_counter_gen++;
+        rec.value = ps_counter_gen;
+        rec.check = ~ps_counter_gen;
+        flashcalw_memcpy(ps_counter_page(page), &rec, sizeof(rec), false);
+        /* The PicoCache may still hold the old page contents */
+        flashcalw_picocache_invalid_all();
+        ps_counter_active = page;
+        ps_counter_next = 1;
+    }
+
+    rec.value = value;
+    rec.check = ~value;
+    flashcalw_memcpy(&ps_counter_page(ps_counter_active)[ps_counter_next], &rec, sizeof(rec), false);
+    ps_counter_next++;
+    flashcalw_picocache_invalid_all();
+
+    if (flashcalw_is_lock_error() || flashcalw_is_programming_error() ||
+        !ps_counter_rec_valid(&ps_counter_page(ps_counter_active)[ps_counter_next - 1]))
+    {
+        return FAILURE;
+    }
+    return MAC_SUCCESS;
+}
@@ -67,6 +67,8 @@
 #include "board.h"
 #include "delay.h"
 #include "conf_pal.h"
+#include "pal_cache_prof.h"
+#include "pal_trace.h"
 
 #if (PAL_USE_SPI_TRX == 1)
 #include "pal_ext_trx.h"
@@ -114,6 +116,12 @@
 
 #define STACK_FLASH_SIZE (1024)
 
+/*
+ * Number of flash pages used by the persistent counter log.
+ * They are located directly below the STACK_FLASH_SIZE area.
+ */
+#define PS_COUNTER_PAGES                (2)
+
 
 /* === Types =============================================================== */
 
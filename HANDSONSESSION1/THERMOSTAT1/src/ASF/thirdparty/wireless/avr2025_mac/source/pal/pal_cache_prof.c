@@ -0,0 +1,188 @@
+/**
+ * @file pal_cache_prof.c
+ *
+ * @brief PicoCache and cycle profiling of stack hot paths
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* === Includes ============================================================ */
+
+#include <string.h>
+#include "pal.h"
+#include "flashcalw.h"
+
+#ifdef ENABLE_CACHE_PROF
+
+/* === Globals ============================================================= */
+
+/* Totals per probe, index 0 without and index 1 with the PicoCache */
+static cache_prof_stats_t cache_prof_stats[CACHE_PROF_PROBES][2];
+
+/* Current state of the PicoCache */
+static volatile bool cache_prof_cached;
+
+/* Probe exits since the last toggle of the PicoCache */
+static uint16_t cache_prof_exits;
+
+/* === Implementation ====================================================== */
+
+void pal_cache_prof_init(void)
+{
+    memset(cache_prof_stats, 0, sizeof(cache_prof_stats));
+    cache_prof_exits = 0;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    flashcalw_picocache_enable();
+    cache_prof_cached = true;
+
+    flashcalw_picocache_set_monitor_mode(CACHE_PROF_MONITOR_MODE);
+    flashcalw_picocache_reset_monitor();
+    flashcalw_picocache_enable_monitor();
+}
+
+
+/**
+ * @brief Records the counters at the start of a probe
+ *
+ * @param[out] mark Counter values
+ */
+void pal_cache_prof_begin(cache_prof_mark_t *mark)
+{
+    irqflags_t flags = cpu_irq_save();
+
+    mark->cached = cache_prof_cached;
+    mark->hits = flashcalw_picocache_get_monitor_cnt();
+    mark->cycles = DWT->CYCCNT;
+
+    cpu_irq_restore(flags);
+}
+
+
+/**
+ * @brief Adds the cycles and hits since pal_cache_prof_begin() to a probe
+ *
+ * A measurement during which the PicoCache was toggled is discarded.
+ *
+ * @param probe Profiled code path
+ * @param mark Counter values recorded by pal_cache_prof_begin()
+ */
+void pal_cache_prof_end(cache_prof_probe_t probe, cache_prof_mark_t *mark)
+{
+    uint32_t cycles = DWT->CYCCNT;
+    uint32_t hits = flashcalw_picocache_get_monitor_cnt();
+    cache_prof_stats_t *stats;
+    irqflags_t flags = cpu_irq_save();
+
+    if (mark->cached == cache_prof_cached)
+    {
+        stats = &cache_prof_stats[probe][cache_prof_cached ? 1 : 0];
+        stats->calls++;
+        stats->cycles += cycles - mark->cycles;
+        stats->hits += hits - mark->hits;
+    }
+
+    if (++cache_prof_exits >= CACHE_PROF_PHASE_CALLS)
+    {
+        cache_prof_exits = 0;
+        if (cache_prof_cached)
+        {
+            flashcalw_picocache_disable();
+        }
+        else
+        {
+            flashcalw_picocache_enable();
+        }
+        cache_prof_cached = !cache_prof_cached;
+    }
+
+    cpu_irq_restore(flags);
+}
+
+
+void pal_cache_prof_get(cache_prof_probe_t probe, bool cached,
+                        cache_prof_stats_t *stats)
+{
+    irqflags_t flags = cpu_irq_save();
+
+    *stats = cache_prof_stats[probe][cached ? 1 : 0];
+
+    cpu_irq_restore(flags);
+}
+
+
+void pal_cache_prof_report(void)
+{
+    cache_prof_stats_t off;
+    cache_prof_stats_t on;
+    uint32_t cycles_off;
+    uint32_t cycles_on;
+    int32_t saved;
+    uint8_t probe;
+
+    for (probe = 0; probe < CACHE_PROF_PROBES; probe++)
+    {
+        pal_cache_prof_get((cache_prof_probe_t)probe, false, &off);
+        pal_cache_prof_get((cache_prof_probe_t)probe, true, &on);
+
+        if ((off.calls == 0) || (on.calls == 0))
+        {
+            continue;
+        }
+
+        cycles_off = (uint32_t)(off.cycles / off.calls);
+        cycles_on = (uint32_t)(on.cycles / on.calls);
+        saved = (int32_t)(cycles_off - cycles_on);
+
+        PAL_TRACE3(PAL_TRACE_CACHE_CALLS, probe, off.calls + on.calls,
+                   (uint32_t)(on.hits / on.calls));
+        PAL_TRACE3(PAL_TRACE_CACHE_CYCLES, probe, cycles_off, cycles_on);
+        PAL_TRACE3(PAL_TRACE_CACHE_SAVED, probe, PAL_TRACE_SIGNED(saved),
+                   PAL_TRACE_SIGNED(saved * (int32_t)on.calls));
+    }
+}
+
+#endif  /* ENABLE_CACHE_PROF */
+
+/* EOF */
@@ -0,0 +1,175 @@
+/**
+ * @file pal_cache_prof.h
+ *
+ * @brief PicoCache and cycle profiling of stack hot paths
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PAL_CACHE_PROF_H
+#define PAL_CACHE_PROF_H
+
+/* === Includes ============================================================ */
+
+#include "compiler.h"
+
+/* === Macros =============================================================== */
+
+/*
+ * Code placed with PAL_RAMFUNC runs from the .ramfunc section in RAM when
+ * ENABLE_RAMFUNC is defined, so it does not compete with the rest of the
+ * program for the PicoCache lines and runs without flash wait states.
+ */
+#ifdef ENABLE_RAMFUNC
+#define PAL_RAMFUNC                     RAMFUNC
+#else
+#define PAL_RAMFUNC
+#endif
+
+/*
+ * Number of probe exits after which the profiler toggles the PicoCache,
+ * so that every probe is measured both with and without the cache.
+ */
+#ifndef CACHE_PROF_PHASE_CALLS
+#define CACHE_PROF_PHASE_CALLS          (256)
+#endif
+
+/* PicoCache monitor mode, instruction hits by default */
+#ifndef CACHE_PROF_MONITOR_MODE
+#define CACHE_PROF_MONITOR_MODE         HCACHE_MCFG_MODE_IHIT
+#endif
+
+#if defined(ENABLE_CACHE_PROF) && !defined(ENABLE_TRACE)
+#error "ENABLE_CACHE_PROF requires ENABLE_TRACE for its report"
+#endif
+
+#ifdef ENABLE_CACHE_PROF
+/*
+ * Measures the code between CACHE_PROF_BEGIN(probe) and
+ * CACHE_PROF_END(probe) within one block. Probes may nest, e.g. an
+ * interrupt inside the MAC dispatcher; the outer probe then includes the
+ * inner one.
+ */
+#define CACHE_PROF_BEGIN(probe)                                             \
+    cache_prof_mark_t cache_prof_mark_##probe;                              \
+    pal_cache_prof_begin(&cache_prof_mark_##probe)
+#define CACHE_PROF_END(probe)                                               \
+    pal_cache_prof_end(probe, &cache_prof_mark_##probe)
+#else
+#define CACHE_PROF_BEGIN(probe)
+#define CACHE_PROF_END(probe)
+#endif
+
+/* === Types =============================================================== */
+
+/* Profiled code paths */
+typedef enum cache_prof_probe_tag
+{
+    CACHE_PROF_TAL_IRQ,
+    CACHE_PROF_MAC_DISPATCH,
+    CACHE_PROF_ADC_CB,
+    CACHE_PROF_PROBES
+} SHORTENUM cache_prof_probe_t;
+
+/* Counter values at the start of a probe */
+typedef struct cache_prof_mark_tag
+{
+    uint32_t cycles;
+    uint32_t hits;
+    bool cached;
+} cache_prof_mark_t;
+
+/* Totals of a probe in one cache state */
+typedef struct cache_prof_stats_tag
+{
+    uint32_t calls;
+    uint64_t cycles;
+    uint64_t hits;
+} cache_prof_stats_t;
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef ENABLE_CACHE_PROF
+    /**
+     * @brief Starts profiling
+     *
+     * Enables the DWT cycle counter and the PicoCache monitor and clears the
+     * statistics. Profiling starts with the cache enabled.
+     */
+    void pal_cache_prof_init(void);
+
+    void pal_cache_prof_begin(cache_prof_mark_t *mark);
+    void pal_cache_prof_end(cache_prof_probe_t probe, cache_prof_mark_t *mark);
+
+    /**
+     * @brief Reads the totals of a probe
+     *
+     * @param probe Profiled code path
+     * @param cached True for the totals with the PicoCache enabled
+     * @param[out] stats Totals of the probe
+     */
+    void pal_cache_prof_get(cache_prof_probe_t probe, bool cached,
+                            cache_prof_stats_t *stats);
+
+    /**
+     * @brief Sends the cycles and cache hits per call of each probe
+     *
+     * Each probe with calls in both cache states gives three trace records:
+     * its calls and hits per call with the cache, its cycles per call
+     * without and with the cache, and the cycles per call saved by the
+     * cache together with those saved over the calls made with the cache.
+     * Probes are identified by their cache_prof_probe_t value.
+     */
+    void pal_cache_prof_report(void);
+#endif  /* ENABLE_CACHE_PROF */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PAL_CACHE_PROF_H */
+/* EOF */
@@ -51,6 +51,15 @@
 #include "conf_pal.h"
 
 static irq_handler_t irq_hdl_trx = NULL;
+
+#if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP)
+/*
+ * Value of the free-running PAL timer latched on entry of the transceiver
+ * ISR, i.e. before the SPI accesses of the IRQ handler delay it.
+ */
+volatile uint32_t pal_trx_irq_time;
+#endif  /* #if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP) */
+
 struct spi_device SPI_AT86RFX_DEVICE = {
 	//! Board specific select id
 	.id = AT86RFX_SPI_CS
@@ -58,6 +67,11 @@ struct spi_device SPI_AT86RFX_DEVICE = {
 
 AT86RFX_ISR()
 {
+#if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP)
+    /* Capture the IRQ edge time first, everything below adds latency */
+    pal_trx_irq_time = sw_timer_get_time();
+#endif  /* #if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP) */
+
     /*Clearing the RF interrupt*/
     pal_trx_irq_flag_clr();
 
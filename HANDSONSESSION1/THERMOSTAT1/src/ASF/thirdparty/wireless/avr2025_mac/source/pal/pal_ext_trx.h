@@ -146,6 +146,10 @@
 
 /* === Externals ============================================================ */
 
+#if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP)
+/* PAL timer value latched on entry of the transceiver ISR */
+extern volatile uint32_t pal_trx_irq_time;
+#endif  /* #if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP) */
 
 /* === Prototypes =========================================================== */
 
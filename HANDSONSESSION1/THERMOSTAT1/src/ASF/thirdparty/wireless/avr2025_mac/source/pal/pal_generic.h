@@ -231,6 +231,28 @@ extern "C" {
      */
     retval_t pal_ps_set(uint16_t start_addr, uint16_t length, void *value);
 
+    /**
+     * \brief Get the last value of the persistent counter log
+     *
+     * \param[out] value Last value stored with pal_ps_counter_set()
+     *
+     * \return MAC_SUCCESS if a value was found, FAILURE if the log is empty
+     */
+    retval_t pal_ps_counter_get(uint32_t *value);
+
+    /**
+     * \brief Append a value to the persistent counter log
+     *
+     * The log is wear-leveled across PS_COUNTER_PAGES flash pages; a page is
+     * only erased once all its records are used. Callers are expected to
+     * batch updates, since every call programs flash.
+     *
+     * \param[in] value Value to be stored
+     *
+     * \return MAC_SUCCESS if the value was written, FAILURE otherwise
+     */
+    retval_t pal_ps_counter_set(uint32_t value);
+
 
 retval_t pal_timer_get_id(uint8_t* timer_id);
 
@@ -0,0 +1,321 @@
+/**
+ * @file pal_trace.c
+ *
+ * @brief Binary trace of stack events
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*
+ * A record holds the event ID, the PAL time in microseconds and the
+ * arguments, all as base-128 varints with the least significant group
+ * first. It is sent COBS encoded and ends with a zero octet, the only zero
+ * on the wire, so a receiver that joins mid-stream or loses bytes picks
+ * up again at the next record. A zero octet is also sent at
+ * initialization to end whatever the receiver had before.
+ *
+ * Writers reserve space with an exclusive load/store on the head index and
+ * never block. Since interrupts nest, the records are complete once the
+ * outermost writer has finished, which then publishes the head as commit
+ * index. Only committed bytes are sent by the PDCA.
+ */
+
+/* === Includes ============================================================ */
+
+#include "pal.h"
+#include "pdca.h"
+#include "sleepmgr.h"
+#include "usart.h"
+
+#ifdef ENABLE_TRACE
+
+/* === Macros =============================================================== */
+
+#define TRACE_MASK                      (PAL_TRACE_BUFFER_SIZE - 1)
+
+#if (PAL_TRACE_BUFFER_SIZE & TRACE_MASK) != 0
+#error "PAL_TRACE_BUFFER_SIZE must be a power of two"
+#endif
+
+/* === Globals ============================================================= */
+
+static uint8_t trace_buf[PAL_TRACE_BUFFER_SIZE];
+
+/*
+ * Free-running byte counts; the buffer position is the count modulo the
+ * buffer size.
+ */
+/* Reserved by writers */
+static volatile uint32_t trace_head;
+/* End of the complete records */
+static volatile uint32_t trace_commit;
+/* Sent by the PDCA */
+static volatile uint32_t trace_tail;
+
+/* Writers in progress, including the interrupted ones */
+static volatile uint8_t trace_writers;
+
+/* Length of the block loaded into the PDCA, 0 when idle */
+static volatile uint16_t trace_tx_len;
+
+static volatile uint32_t trace_dropped;
+
+/* Drops already reported by a PAL_TRACE_DROPPED record */
+static uint32_t trace_reported;
+
+/* === Implementation ====================================================== */
+
+static uint8_t trace_put_varint(uint8_t *dst, uint32_t value)
+{
+    uint8_t len = 0;
+
+    while (value >= 0x80)
+    {
+        dst[len++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+    dst[len++] = (uint8_t)value;
+
+    return len;
+}
+
+
+/*
+ * COBS encodes a record of less than 254 octets and appends the zero
+ * delimiter. Each zero is replaced by the distance to the next one; the
+ * first octet holds the distance to the first zero.
+ */
+static uint8_t trace_put_cobs(uint8_t *dst, const uint8_t *src, uint8_t len)
+{
+    uint8_t code_pos = 0;
+    uint8_t out = 1;
+    uint8_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (src[i] == 0)
+        {
+            dst[code_pos] = out - code_pos;
+            code_pos = out++;
+        }
+        else
+        {
+            dst[out++] = src[i];
+        }
+    }
+    dst[code_pos] = out - code_pos;
+    dst[out++] = 0;
+
+    return out;
+}
+
+
+/*
+ * Makes the reserved records visible to the PDCA once the outermost writer
+ * is done. The commit index is written exclusively, so a writer that
+ * interrupts this one and commits a later head is not undone.
+ */
+static void trace_publish(void)
+{
+    uint32_t head;
+
+    if (--trace_writers != 0)
+    {
+        return;
+    }
+
+    do
+    {
+        (void)__LDREXW(&trace_commit);
+        head = trace_head;
+    } while (__STREXW(head, &trace_commit));
+}
+
+
+void pal_trace_write(pal_trace_id_t id, uint8_t argc,
+                     uint32_t a, uint32_t b, uint32_t c)
+{
+    uint8_t raw[PAL_TRACE_RECORD_MAX - 2];
+    uint8_t rec[PAL_TRACE_RECORD_MAX];
+    uint32_t args[3] = {a, b, c};
+    uint32_t pos;
+    uint8_t len = 0;
+    uint8_t i;
+
+    raw[len++] = id;
+    len += trace_put_varint(&raw[len], sw_timer_get_time());
+    for (i = 0; i < argc; i++)
+    {
+        len += trace_put_varint(&raw[len], args[i]);
+    }
+    len = trace_put_cobs(rec, raw, len);
+
+    /* Balanced by any interrupting writer before it returns */
+    trace_writers++;
+
+    do
+    {
+        pos = __LDREXW(&trace_head);
+        if ((pos + len - trace_tail) > PAL_TRACE_BUFFER_SIZE)
+        {
+            __CLREX();
+            trace_dropped++;
+            trace_publish();
+            return;
+        }
+    } while (__STREXW(pos + len, &trace_head));
+
+    for (i = 0; i < len; i++)
+    {
+        trace_buf[(pos + i) & TRACE_MASK] = rec[i];
+    }
+
+    trace_publish();
+}
+
+
+/*
+ * Loads the next contiguous block of committed records into the PDCA.
+ * Must be called with interrupts disabled.
+ */
+static void trace_tx_start(void)
+{
+    uint32_t start = trace_tail & TRACE_MASK;
+    uint32_t len = trace_commit - trace_tail;
+
+    if (len == 0)
+    {
+        pdca_channel_disable_interrupt(PAL_TRACE_PDCA_CHANNEL, PDCA_IDR_TRC);
+        /* The PDCA is an HSB master and stops with the HSB clock. */
+        sleepmgr_unlock_mode(SLEEPMGR_SLEEP_0);
+        return;
+    }
+
+    if (len > (PAL_TRACE_BUFFER_SIZE - start))
+    {
+        len = PAL_TRACE_BUFFER_SIZE - start;
+    }
+    trace_tx_len = len;
+    pdca_channel_write_load(PAL_TRACE_PDCA_CHANNEL, &trace_buf[start], len);
+}
+
+
+static void trace_pdca_cb(enum pdca_channel_status status)
+{
+    if ((status != PDCA_CH_TRANSFER_COMPLETED) || (trace_tx_len == 0))
+    {
+        return;
+    }
+
+    trace_tail += trace_tx_len;
+    trace_tx_len = 0;
+    trace_tx_start();
+}
+
+
+void pal_trace_init(void)
+{
+    const sam_usart_opt_t usart_opt =
+    {
+        .baudrate = PAL_TRACE_BAUDRATE,
+        .char_length = US_MR_CHRL_8_BIT,
+        .parity_type = US_MR_PAR_NO,
+        .stop_bits = US_MR_NBSTOP_1_BIT,
+        .channel_mode = US_MR_CHMODE_NORMAL
+    };
+    const pdca_channel_config_t pdca_cfg =
+    {
+        .addr = (void *)trace_buf,
+        .pid = PAL_TRACE_PDCA_PID,
+        .size = 0,
+        .transfer_size = PDCA_MR_SIZE_BYTE
+    };
+
+    /* Delimiter ending any partial record the receiver has seen */
+    trace_buf[0] = 0;
+    trace_head = trace_commit = 1;
+    trace_tail = 0;
+    trace_writers = 0;
+    trace_tx_len = 0;
+    trace_dropped = trace_reported = 0;
+
+    sysclk_enable_peripheral_clock(PAL_TRACE_USART);
+    usart_init_rs232(PAL_TRACE_USART, &usart_opt, sysclk_get_pba_hz());
+    usart_enable_tx(PAL_TRACE_USART);
+
+    pdca_enable(PDCA);
+    pdca_channel_set_config(PAL_TRACE_PDCA_CHANNEL, &pdca_cfg);
+    pdca_channel_set_callback(PAL_TRACE_PDCA_CHANNEL, trace_pdca_cb,
+                              PDCA_0_IRQn + PAL_TRACE_PDCA_CHANNEL, 1, 0);
+    pdca_channel_enable(PAL_TRACE_PDCA_CHANNEL);
+}
+
+
+void pal_trace_task(void)
+{
+    uint32_t dropped = trace_dropped;
+
+    if (dropped != trace_reported)
+    {
+        PAL_TRACE1(PAL_TRACE_DROPPED, dropped - trace_reported);
+        trace_reported = dropped;
+    }
+
+    ENTER_CRITICAL_REGION();
+    if ((trace_tx_len == 0) && (trace_commit != trace_tail))
+    {
+        sleepmgr_lock_mode(SLEEPMGR_SLEEP_0);
+        pdca_channel_enable_interrupt(PAL_TRACE_PDCA_CHANNEL, PDCA_IER_TRC);
+        trace_tx_start();
+    }
+    LEAVE_CRITICAL_REGION();
+}
+
+
+uint32_t pal_trace_get_dropped(void)
+{
+    return trace_dropped;
+}
+
+#endif  /* ENABLE_TRACE */
+
+/* EOF */
@@ -0,0 +1,185 @@
+/**
+ * @file pal_trace.h
+ *
+ * @brief Binary trace of stack events
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef PAL_TRACE_H
+#define PAL_TRACE_H
+
+/* === Includes ============================================================ */
+
+#include "compiler.h"
+
+/* === Macros =============================================================== */
+
+/*
+ * Trace events, each with its format string. The index of an entry is the
+ * event ID sent on the wire; the host decoder reads this table from this
+ * file, so entries may only be appended and each must stay on one line.
+ * Arguments are unsigned; a %d argument has to be passed through
+ * PAL_TRACE_SIGNED().
+ */
+#define PAL_TRACE_EVENTS(X)                                                  \
+    X(PAL_TRACE_DROPPED,        "%u records dropped")                        \
+    X(PAL_TRACE_TRX_IRQ,        "trx irq cause=0x%02x tal_state=%u")         \
+    X(PAL_TRACE_TRX_RX_FRAME,   "trx rx frame len=%u ed=%u")                 \
+    X(PAL_TRACE_TRX_TX_END,     "trx tx end trac=%u")                        \
+    X(PAL_TRACE_MAC_DISPATCH,   "mac dispatch cmd=0x%02x")                   \
+    X(PAL_TRACE_APP_TASK,       "app task %u runs, %u us, est. %u nC/run")   \
+    X(PAL_TRACE_CACHE_CALLS,    "cache probe %u: %u calls, %u hits/call")    \
+    X(PAL_TRACE_CACHE_CYCLES,   "cache probe %u: %u cyc/call off, %u on")    \
+    X(PAL_TRACE_CACHE_SAVED,    "cache probe %u: %d saved/call, %d in all")
+
+/* Size of the trace buffer in bytes, power of two */
+#ifndef PAL_TRACE_BUFFER_SIZE
+#define PAL_TRACE_BUFFER_SIZE           (512)
+#endif
+
+/* USART the trace is sent on, the virtual COM port of the SAM4L-EK */
+#ifndef PAL_TRACE_USART
+#define PAL_TRACE_USART                 COM_PORT_USART
+#endif
+
+#ifndef PAL_TRACE_BAUDRATE
+#define PAL_TRACE_BAUDRATE              (115200)
+#endif
+
+/* PDCA channel moving the trace buffer to the USART */
+#ifndef PAL_TRACE_PDCA_CHANNEL
+#define PAL_TRACE_PDCA_CHANNEL          (2)
+#endif
+
+/* PDCA peripheral ID of the transmitter of PAL_TRACE_USART */
+#ifndef PAL_TRACE_PDCA_PID
+#define PAL_TRACE_PDCA_PID              USART2_PDCA_ID_TX
+#endif
+
+/*
+ * Largest encoded record: ID, time stamp and three arguments, with the
+ * COBS code octet and the delimiter
+ */
+#define PAL_TRACE_RECORD_MAX            (1 + 5 + 3 * 5 + 2)
+
+/* Maps a signed argument to an unsigned one with a short encoding */
+#define PAL_TRACE_SIGNED(value)                                             \
+    ((((uint32_t)(value)) << 1) ^ (uint32_t)((int32_t)(value) >> 31))
+
+#ifdef ENABLE_TRACE
+/*
+ * Records an event with up to three arguments. May be used in any
+ * context, including interrupts of any priority.
+ */
+#define PAL_TRACE0(id)                                                      \
+    pal_trace_write((id), 0, 0, 0, 0)
+#define PAL_TRACE1(id, a)                                                   \
+    pal_trace_write((id), 1, (uint32_t)(a), 0, 0)
+#define PAL_TRACE2(id, a, b)                                                \
+    pal_trace_write((id), 2, (uint32_t)(a), (uint32_t)(b), 0)
+#define PAL_TRACE3(id, a, b, c)                                             \
+    pal_trace_write((id), 3, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c))
+#else
+#define PAL_TRACE0(id)
+#define PAL_TRACE1(id, a)
+#define PAL_TRACE2(id, a, b)
+#define PAL_TRACE3(id, a, b, c)
+#endif
+
+/* === Types =============================================================== */
+
+#define PAL_TRACE_ENUM(id, fmt)         id,
+
+/* Trace event IDs */
+typedef enum pal_trace_id_tag
+{
+    PAL_TRACE_EVENTS(PAL_TRACE_ENUM)
+    PAL_TRACE_IDS
+} SHORTENUM pal_trace_id_t;
+
+#undef PAL_TRACE_ENUM
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef ENABLE_TRACE
+    /**
+     * @brief Initializes the trace USART and its PDCA channel
+     */
+    void pal_trace_init(void);
+
+    /**
+     * @brief Encodes an event into the trace buffer
+     *
+     * The record is dropped and counted if the buffer is full.
+     *
+     * @param id Event
+     * @param argc Number of valid arguments
+     */
+    void pal_trace_write(pal_trace_id_t id, uint8_t argc,
+                         uint32_t a, uint32_t b, uint32_t c);
+
+    /**
+     * @brief Starts sending the trace buffer if the USART is idle
+     *
+     * Called from pal_task(); the PDCA interrupt continues as long as
+     * records are available.
+     */
+    void pal_trace_task(void);
+
+    /**
+     * @brief Returns the number of records dropped since initialization
+     */
+    uint32_t pal_trace_get_dropped(void);
+#endif  /* ENABLE_TRACE */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PAL_TRACE_H */
+/* EOF */
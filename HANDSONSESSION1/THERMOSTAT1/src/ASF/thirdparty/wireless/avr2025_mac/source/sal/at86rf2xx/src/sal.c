@@ -0,0 +1,223 @@
+/**
+ * @file sal.c
+ *
+ * @brief AES block engine using the AES core of the AT86RF2xx transceiver.
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#include "sal_types.h"
+
+#if (defined STB_ON_SAL) && (SAL_TYPE == AT86RF2xx)
+
+/* === Includes ============================================================ */
+
+#include <compiler.h>
+#include <string.h>
+#include "pal.h"
+#include "at86rf231.h"
+#include "sal.h"
+
+/* === Macros ============================================================== */
+
+/** Processing time of the transceiver AES core for one block in us */
+#define AES_RD_WAIT_US                      (24)
+
+/** SRAM address of register AES_CTRL */
+#define AES_CTRL_ADDR                       (AES_BASE_ADDR + RG_AES_CTRL)
+
+/** SRAM address of the AES state/key buffer */
+#define AES_STATE_ADDR                      (AES_BASE_ADDR + RG_AES_STATE_KEY_0)
+
+/** Builds the AES_CTRL value for the given mode and direction */
+#define AES_CTRL_VALUE(mode, dir)           (((mode) << 4) | ((dir) << 3))
+
+/** Request bit of AES_CTRL / AES_CTRL_MIRROR */
+#define AES_CTRL_REQUEST                    (AES_REQUEST << 7)
+
+/* === Globals ============================================================= */
+
+/** AES_CTRL value of the current mode and direction */
+static uint8_t mode_byte;
+
+/** Copy of the key loaded into the transceiver */
+static uint8_t loaded_key[AES_KEYSIZE];
+
+/** Indicates that loaded_key is present in the transceiver */
+static bool key_loaded;
+
+/** Indicates that AES_CTRL has to be rewritten with the next block */
+static bool ctrl_dirty;
+
+/** Indicates that the AES core may still be processing a block */
+static bool aes_running;
+
+/** SPI transfer buffer: AES_CTRL | state | AES_CTRL_MIRROR */
+static uint8_t aes_buf[AES_BLOCKSIZE + 2];
+
+/* === Implementation ====================================================== */
+
+/*
+ * Waits until the block started last has been processed by the AES core.
+ * The core needs AES_RD_WAIT_US after the request bit has been written;
+ * polling AES_STATUS via SPI would take longer than that.
+ */
+static inline void wait_aes_done(void)
+{
+    if (aes_running)
+    {
+        pal_timer_delay(AES_RD_WAIT_US);
+        aes_running = false;
+    }
+}
+
+
+void sal_init(void)
+{
+    sal_aes_restart();
+}
+
+
+bool sal_aes_setup(uint8_t *key, uint8_t enc_mode, uint8_t dir)
+{
+    uint8_t new_mode;
+
+    /*
+     * ECB decryption would require the last round key; CCM* only ever
+     * uses the forward cipher, so only encryption is supported.
+     */
+    if ((dir != AES_DIR_ENCRYPT) ||
+        ((enc_mode != AES_MODE_ECB) && (enc_mode != AES_MODE_CBC)))
+    {
+        return false;
+    }
+
+    if ((key != NULL) &&
+        (!key_loaded || (memcmp(loaded_key, key, AES_KEYSIZE) != 0)))
+    {
+        wait_aes_done();
+        aes_buf[0] = AES_CTRL_VALUE(AES_MODE_KEY, AES_DIR_ENCRYPT);
+        memcpy(&aes_buf[1], key, AES_KEYSIZE);
+        pal_trx_sram_write(AES_CTRL_ADDR, aes_buf, AES_KEYSIZE + 1);
+        memcpy(loaded_key, key, AES_KEYSIZE);
+        key_loaded = true;
+        /* AES_CTRL holds the key mode now. */
+        ctrl_dirty = true;
+    }
+
+    new_mode = AES_CTRL_VALUE(enc_mode, dir);
+    if (new_mode != mode_byte)
+    {
+        mode_byte = new_mode;
+        ctrl_dirty = true;
+    }
+
+    return true;
+}
+
+
+void sal_aes_exec(uint8_t *data)
+{
+    wait_aes_done();
+
+    memcpy(&aes_buf[1], data, AES_BLOCKSIZE);
+    aes_buf[AES_BLOCKSIZE + 1] = mode_byte | AES_CTRL_REQUEST;
+
+    if (ctrl_dirty)
+    {
+        aes_buf[0] = mode_byte;
+        pal_trx_sram_write(AES_CTRL_ADDR, aes_buf, AES_BLOCKSIZE + 2);
+        ctrl_dirty = false;
+    }
+    else
+    {
+        /* Mode unchanged: start right at the state buffer. */
+        pal_trx_sram_write(AES_STATE_ADDR, &aes_buf[1], AES_BLOCKSIZE + 1);
+    }
+
+    aes_running = true;
+}
+
+
+void sal_aes_wrrd(uint8_t *idata, uint8_t *odata)
+{
+    if (ctrl_dirty)
+    {
+        /* The mode has to be written first, no combined transfer possible. */
+        sal_aes_read(odata);
+        sal_aes_exec(idata);
+        return;
+    }
+
+    wait_aes_done();
+
+    /*
+     * While the next block and AES_CTRL_MIRROR are written, the transceiver
+     * shifts out the previous result from the same SRAM locations.
+     */
+    memcpy(aes_buf, idata, AES_BLOCKSIZE);
+    aes_buf[AES_BLOCKSIZE] = mode_byte | AES_CTRL_REQUEST;
+    pal_trx_aes_wrrd(AES_STATE_ADDR, aes_buf, AES_BLOCKSIZE);
+    memcpy(odata, aes_buf, AES_BLOCKSIZE);
+
+    aes_running = true;
+}
+
+
+void sal_aes_read(uint8_t *data)
+{
+    wait_aes_done();
+    pal_trx_sram_read(AES_STATE_ADDR, data, AES_BLOCKSIZE);
+}
+
+
+void sal_aes_restart(void)
+{
+    key_loaded = false;
+    ctrl_dirty = true;
+    aes_running = false;
+    mode_byte = AES_CTRL_VALUE(AES_MODE_ECB, AES_DIR_ENCRYPT);
+}
+
+#endif /* #if (defined STB_ON_SAL) && (SAL_TYPE == AT86RF2xx) */
+
+/* EOF */
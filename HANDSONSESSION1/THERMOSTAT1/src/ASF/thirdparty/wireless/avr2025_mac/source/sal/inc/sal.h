@@ -0,0 +1,153 @@
+/**
+ * @file sal.h
+ *
+ * @brief Declarations of the security abstraction layer (AES block engine).
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef SAL_H
+#define SAL_H
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sal_types.h"
+
+/* === Macros =============================================================== */
+
+/** Size of an AES block in octets */
+#define AES_BLOCKSIZE                       (16)
+
+/** Size of an AES-128 key in octets */
+#define AES_KEYSIZE                         (16)
+
+#ifndef AES_DIR_ENCRYPT
+/** AES core operation direction: Encryption (ECB, CBC) */
+#define AES_DIR_ENCRYPT                     (0)
+#endif
+
+#ifndef AES_DIR_DECRYPT
+/** AES core operation direction: Decryption (ECB) */
+#define AES_DIR_DECRYPT                     (1)
+#endif
+
+#ifndef AES_MODE_ECB
+/** Electronic code book mode */
+#define AES_MODE_ECB                        (0)
+#endif
+
+#ifndef AES_MODE_CBC
+/** Cipher block chaining mode; the input block is XORed with the last result */
+#define AES_MODE_CBC                        (2)
+#endif
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the AES engine
+ *
+ * Must be called once before any other SAL function.
+ */
+void sal_init(void);
+
+/**
+ * @brief Sets the key, mode and direction for the following AES operations
+ *
+ * The key is only transferred to the engine if it differs from the key
+ * loaded last, so repeated calls with the same key are cheap.
+ *
+ * @param key Pointer to the AES-128 key, or NULL to keep the current key
+ *            and only change mode and direction
+ * @param enc_mode AES_MODE_ECB or AES_MODE_CBC
+ * @param dir AES_DIR_ENCRYPT or AES_DIR_DECRYPT
+ *
+ * @return true if the engine accepted the setup, false otherwise
+ */
+bool sal_aes_setup(uint8_t *key, uint8_t enc_mode, uint8_t dir);
+
+/**
+ * @brief Starts an AES operation on one block
+ *
+ * The result is fetched with sal_aes_read() or sal_aes_wrrd().
+ *
+ * @param data Pointer to the AES_BLOCKSIZE octets of input data
+ */
+void sal_aes_exec(uint8_t *data);
+
+/**
+ * @brief Starts the AES operation on the next block and reads the result
+ *        of the previous one in the same transfer
+ *
+ * @param idata Pointer to the AES_BLOCKSIZE octets of the next input block
+ * @param odata Pointer to where the previous result is stored
+ *              (may be equal to idata)
+ */
+void sal_aes_wrrd(uint8_t *idata, uint8_t *odata);
+
+/**
+ * @brief Reads the result of the last AES operation
+ *
+ * @param data Pointer to where the AES_BLOCKSIZE octets are stored
+ */
+void sal_aes_read(uint8_t *data);
+
+/**
+ * @brief Marks the key of the engine as lost
+ *
+ * Called whenever the engine lost its state, e.g. after transceiver sleep,
+ * so that the next sal_aes_setup() reloads the key.
+ */
+void sal_aes_restart(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SAL_H */
+/* EOF */
@@ -0,0 +1,265 @@
+/**
+ * @file sal_sw.c
+ *
+ * @brief Portable software AES block engine.
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#include "sal_types.h"
+
+#if (defined STB_ON_SAL) && (SAL_TYPE == SW_AES)
+
+/*
+ * This file has no hardware dependencies. It is the reference for the
+ * transceiver backend and allows the security toolbox to be built and
+ * checked on a host against the IEEE 802.15.4 CCM* test vectors.
+ */
+
+/* === Includes ============================================================ */
+
+#include <string.h>
+#include "sal.h"
+
+/* === Macros ============================================================== */
+
+/** Number of AES-128 rounds */
+#define AES_ROUNDS                          (10)
+
+/** Multiplication by x in GF(2^8) */
+#define XTIME(x)                            ((uint8_t)(((x) << 1) ^ (((x) & 0x80) ? 0x1B : 0x00)))
+
+/* === Globals ============================================================= */
+
+/** Forward S-box */
+static const uint8_t sbox[256] =
+{
+    0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+    0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+    0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+    0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+    0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+    0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+    0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+    0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+    0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+    0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+    0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+    0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+    0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+    0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+    0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+    0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16
+};
+
+/** Expanded key schedule */
+static uint8_t round_key[(AES_ROUNDS + 1) * AES_BLOCKSIZE];
+
+/** Copy of the key the schedule was expanded from */
+static uint8_t loaded_key[AES_KEYSIZE];
+
+/** Indicates that round_key is valid for loaded_key */
+static bool key_loaded;
+
+/** Current mode: AES_MODE_ECB or AES_MODE_CBC */
+static uint8_t aes_mode;
+
+/** Result of the last operation, also the CBC chaining value */
+static uint8_t aes_state[AES_BLOCKSIZE];
+
+/* === Implementation ====================================================== */
+
+static void expand_key(const uint8_t *key)
+{
+    uint8_t rcon = 0x01;
+    uint8_t i;
+    uint8_t t[4];
+
+    memcpy(round_key, key, AES_KEYSIZE);
+
+    for (i = AES_KEYSIZE; i < sizeof(round_key); i += 4)
+    {
+        memcpy(t, &round_key[i - 4], 4);
+
+        if ((i % AES_KEYSIZE) == 0)
+        {
+            uint8_t tmp = t[0];
+
+            t[0] = sbox[t[1]] ^ rcon;
+            t[1] = sbox[t[2]];
+            t[2] = sbox[t[3]];
+            t[3] = sbox[tmp];
+            rcon = XTIME(rcon);
+        }
+
+        round_key[i + 0] = round_key[i - AES_KEYSIZE + 0] ^ t[0];
+        round_key[i + 1] = round_key[i - AES_KEYSIZE + 1] ^ t[1];
+        round_key[i + 2] = round_key[i - AES_KEYSIZE + 2] ^ t[2];
+        round_key[i + 3] = round_key[i - AES_KEYSIZE + 3] ^ t[3];
+    }
+}
+
+
+/* Encrypts one block in place, state is column-major as in FIPS-197. */
+static void encrypt_block(uint8_t *s)
+{
+    uint8_t round;
+    uint8_t i;
+    uint8_t t;
+
+    for (i = 0; i < AES_BLOCKSIZE; i++)
+    {
+        s[i] ^= round_key[i];
+    }
+
+    for (round = 1; round <= AES_ROUNDS; round++)
+    {
+        /* SubBytes */
+        for (i = 0; i < AES_BLOCKSIZE; i++)
+        {
+            s[i] = sbox[s[i]];
+        }
+
+        /* ShiftRows */
+        t = s[1]; s[1] = s[5]; s[5] = s[9]; s[9] = s[13]; s[13] = t;
+        t = s[2]; s[2] = s[10]; s[10] = t;
+        t = s[6]; s[6] = s[14]; s[14] = t;
+        t = s[15]; s[15] = s[11]; s[11] = s[7]; s[7] = s[3]; s[3] = t;
+
+        /* MixColumns, omitted in the final round */
+        if (round != AES_ROUNDS)
+        {
+            for (i = 0; i < AES_BLOCKSIZE; i += 4)
+            {
+                uint8_t a0 = s[i];
+                uint8_t all = s[i] ^ s[i + 1] ^ s[i + 2] ^ s[i + 3];
+
+                s[i + 0] ^= all ^ XTIME(s[i + 0] ^ s[i + 1]);
+                s[i + 1] ^= all ^ XTIME(s[i + 1] ^ s[i + 2]);
+                s[i + 2] ^= all ^ XTIME(s[i + 2] ^ s[i + 3]);
+                s[i + 3] ^= all ^ XTIME(s[i + 3] ^ a0);
+            }
+        }
+
+        /* AddRoundKey */
+        for (i = 0; i < AES_BLOCKSIZE; i++)
+        {
+            s[i] ^= round_key[round * AES_BLOCKSIZE + i];
+        }
+    }
+}
+
+
+void sal_init(void)
+{
+    sal_aes_restart();
+}
+
+
+bool sal_aes_setup(uint8_t *key, uint8_t enc_mode, uint8_t dir)
+{
+    /* CCM* only uses the forward cipher. */
+    if ((dir != AES_DIR_ENCRYPT) ||
+        ((enc_mode != AES_MODE_ECB) && (enc_mode != AES_MODE_CBC)))
+    {
+        return false;
+    }
+
+    if ((key != NULL) &&
+        (!key_loaded || (memcmp(loaded_key, key, AES_KEYSIZE) != 0)))
+    {
+        expand_key(key);
+        memcpy(loaded_key, key, AES_KEYSIZE);
+        key_loaded = true;
+    }
+
+    aes_mode = enc_mode;
+
+    return key_loaded;
+}
+
+
+void sal_aes_exec(uint8_t *data)
+{
+    uint8_t i;
+
+    if (aes_mode == AES_MODE_CBC)
+    {
+        for (i = 0; i < AES_BLOCKSIZE; i++)
+        {
+            aes_state[i] ^= data[i];
+        }
+    }
+    else
+    {
+        memcpy(aes_state, data, AES_BLOCKSIZE);
+    }
+
+    encrypt_block(aes_state);
+}
+
+
+void sal_aes_wrrd(uint8_t *idata, uint8_t *odata)
+{
+    uint8_t prev[AES_BLOCKSIZE];
+
+    memcpy(prev, aes_state, AES_BLOCKSIZE);
+    sal_aes_exec(idata);
+    memcpy(odata, prev, AES_BLOCKSIZE);
+}
+
+
+void sal_aes_read(uint8_t *data)
+{
+    memcpy(data, aes_state, AES_BLOCKSIZE);
+}
+
+
+void sal_aes_restart(void)
+{
+    key_loaded = false;
+    aes_mode = AES_MODE_ECB;
+}
+
+#endif /* #if (defined STB_ON_SAL) && (SAL_TYPE == SW_AES) */
+
+/* EOF */
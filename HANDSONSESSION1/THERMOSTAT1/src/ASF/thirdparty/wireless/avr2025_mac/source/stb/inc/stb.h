@@ -0,0 +1,140 @@
+/**
+ * @file stb.h
+ *
+ * @brief Declarations of the security toolbox (CCM* according to IEEE 802.15.4).
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/* Prevent double inclusion */
+#ifndef STB_H
+#define STB_H
+
+#ifdef STB_ON_SAL
+
+/* === Includes ============================================================= */
+
+#include <stdint.h>
+#include "sal.h"
+
+/* === Types ================================================================ */
+
+/**
+ * Status of a CCM* operation
+ */
+typedef enum stb_ccm_tag
+{
+    /** CCM* operation completed successfully */
+    STB_CCM_OK = 0,
+    /** Illegal parameter (security level, length) */
+    STB_CCM_ILLPARM,
+    /** The AES engine rejected the key */
+    STB_CCM_KEYMISS,
+    /** Received MIC does not match, frame is not authentic */
+    STB_CCM_MICERR
+} stb_ccm_t;
+
+/* === Macros =============================================================== */
+
+/**
+ * Offset of the 13 octet CCM* nonce within the nonce block passed to
+ * stb_ccm_secure(); octet 0 and octets 14-15 are used by the toolbox.
+ */
+#define STB_NONCE_OFFSET                    (1)
+
+/* === Prototypes =========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the security toolbox and the underlying AES engine
+ */
+void stb_init(void);
+
+/**
+ * @brief Re-initializes the toolbox after the AES engine lost its state
+ *
+ * Called by the TAL whenever the transceiver has been reset or sent to
+ * sleep.
+ */
+void stb_restart(void);
+
+/**
+ * @brief Secures or unsecures a frame in place using CCM*
+ *
+ * The buffer holds the plaintext header (string a) directly followed by
+ * the payload. On encryption the payload is replaced by its ciphertext and
+ * the MIC is appended right behind it, so the buffer must provide
+ * MIC-length octets of room after the payload. On decryption the encrypted
+ * MIC is expected behind the payload and the payload is decrypted in place.
+ *
+ * For security levels without encryption the payload is authenticated as
+ * part of string a and left unchanged.
+ *
+ * @param buffer Header and payload, processed in place
+ * @param nonce AES_BLOCKSIZE octets with the nonce at STB_NONCE_OFFSET
+ * @param key AES-128 key
+ * @param hdr_len Length of the plaintext header
+ * @param pld_len Length of the payload, excluding the MIC
+ * @param sec_level Security level (1..7)
+ * @param aes_dir AES_DIR_ENCRYPT to secure, AES_DIR_DECRYPT to unsecure
+ *
+ * @return STB_CCM_OK, STB_CCM_ILLPARM, STB_CCM_KEYMISS or STB_CCM_MICERR
+ */
+stb_ccm_t stb_ccm_secure(uint8_t *buffer,
+                         uint8_t nonce[AES_BLOCKSIZE],
+                         uint8_t *key,
+                         uint8_t hdr_len,
+                         uint8_t pld_len,
+                         uint8_t sec_level,
+                         uint8_t aes_dir);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* STB_ON_SAL */
+
+#endif /* STB_H */
+/* EOF */
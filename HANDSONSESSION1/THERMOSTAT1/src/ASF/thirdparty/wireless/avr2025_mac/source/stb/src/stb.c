@@ -0,0 +1,322 @@
+/**
+ * @file stb.c
+ *
+ * @brief Security toolbox: in-place CCM* on top of the security abstraction layer.
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#ifdef STB_ON_SAL
+
+/* === Includes ============================================================ */
+
+#include <string.h>
+#include "sal.h"
+#include "stb.h"
+
+/* === Macros ============================================================== */
+
+/** Size of the CCM* length field in octets (15 - nonce length) */
+#define CCM_L                               (2)
+
+/** Flags octet of the authentication block B0 */
+#define CCM_B0_FLAGS(adata, mic_len)        ((uint8_t)(((adata) ? 0x40 : 0x00) | \
+                                             ((((mic_len) - 2) >> 1) << 3) | \
+                                             (CCM_L - 1)))
+
+/** Flags octet of the counter blocks A_i */
+#define CCM_A_FLAGS                         (CCM_L - 1)
+
+/** Security levels 4 to 7 provide confidentiality */
+#define SEC_LEVEL_ENC                       (0x04)
+
+/** Highest security level */
+#define SEC_LEVEL_MAX                       (0x07)
+
+/* === Implementation ====================================================== */
+
+/* Returns the MIC length for the given security level. */
+static inline uint8_t mic_length(uint8_t sec_level)
+{
+    switch (sec_level & 0x03)
+    {
+        case 1:
+            return 4;
+        case 2:
+            return 8;
+        case 3:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+
+/*
+ * Feeds a string into the running CBC-MAC, zero padded to the block size.
+ * The first 'fill' octets of block already hold a prefix (e.g. l(a)).
+ */
+static void cbc_mac_string(uint8_t *block, uint8_t fill, uint8_t *data, uint8_t len)
+{
+    uint8_t n;
+
+    do
+    {
+        n = AES_BLOCKSIZE - fill;
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(&block[fill], data, n);
+        data += n;
+        len -= n;
+        fill += n;
+        memset(&block[fill], 0, AES_BLOCKSIZE - fill);
+
+        sal_aes_exec(block);
+        fill = 0;
+    }
+    while (len > 0);
+}
+
+
+/*
+ * Computes the unencrypted authentication tag T over string a
+ * (buffer[0 .. a_len-1]) and string m (the following m_len octets).
+ * The chaining is done by the AES engine in CBC mode, so no intermediate
+ * result has to be read back.
+ */
+static void compute_mic(uint8_t *buffer, uint8_t *nonce, uint8_t mic_len,
+                        uint8_t a_len, uint8_t m_len, uint8_t *mic)
+{
+    uint8_t block[AES_BLOCKSIZE];
+
+    /* Authentication block B0: flags | nonce | l(m) */
+    memcpy(block, nonce, AES_BLOCKSIZE);
+    block[0] = CCM_B0_FLAGS(a_len > 0, mic_len);
+    block[AES_BLOCKSIZE - 2] = 0;
+    block[AES_BLOCKSIZE - 1] = m_len;
+
+    sal_aes_setup(NULL, AES_MODE_ECB, AES_DIR_ENCRYPT);
+    sal_aes_exec(block);
+    sal_aes_setup(NULL, AES_MODE_CBC, AES_DIR_ENCRYPT);
+
+    if (a_len > 0)
+    {
+        /* l(a) is encoded in two octets since a_len < 0xFF00. */
+        block[0] = 0;
+        block[1] = a_len;
+        cbc_mac_string(block, 2, buffer, a_len);
+    }
+
+    if (m_len > 0)
+    {
+        cbc_mac_string(block, 0, &buffer[a_len], m_len);
+    }
+
+    sal_aes_read(block);
+    memcpy(mic, block, mic_len);
+}
+
+
+/* XORs up to one block of key stream into data. */
+static inline void xor_block(uint8_t *data, uint8_t *key_stream, uint8_t len)
+{
+    uint8_t i;
+
+    if (len > AES_BLOCKSIZE)
+    {
+        len = AES_BLOCKSIZE;
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        data[i] ^= key_stream[i];
+    }
+}
+
+
+/*
+ * Encrypts or decrypts data in place in counter mode and returns the key
+ * stream block S0 used for the MIC. The counter block A(i+1) is written to
+ * the AES engine in the same transfer that reads back S(i).
+ */
+static void ctr_crypt(uint8_t *data, uint8_t len, uint8_t *nonce, uint8_t *s0)
+{
+    uint8_t ctr_blk[AES_BLOCKSIZE];
+    uint8_t key_stream[AES_BLOCKSIZE];
+    uint8_t blocks = (len + AES_BLOCKSIZE - 1) / AES_BLOCKSIZE;
+    uint8_t i;
+
+    memcpy(ctr_blk, nonce, AES_BLOCKSIZE);
+    ctr_blk[0] = CCM_A_FLAGS;
+    ctr_blk[AES_BLOCKSIZE - 2] = 0;
+    ctr_blk[AES_BLOCKSIZE - 1] = 0;
+
+    sal_aes_setup(NULL, AES_MODE_ECB, AES_DIR_ENCRYPT);
+    sal_aes_exec(ctr_blk);
+
+    for (i = 1; i <= blocks; i++)
+    {
+        ctr_blk[AES_BLOCKSIZE - 1] = i;
+        sal_aes_wrrd(ctr_blk, key_stream);
+
+        if (i == 1)
+        {
+            memcpy(s0, key_stream, AES_BLOCKSIZE);
+        }
+        else
+        {
+            xor_block(&data[(i - 2) * AES_BLOCKSIZE], key_stream,
+                      len - (i - 2) * AES_BLOCKSIZE);
+        }
+    }
+
+    sal_aes_read(key_stream);
+
+    if (blocks == 0)
+    {
+        memcpy(s0, key_stream, AES_BLOCKSIZE);
+    }
+    else
+    {
+        xor_block(&data[(blocks - 1) * AES_BLOCKSIZE], key_stream,
+                  len - (blocks - 1) * AES_BLOCKSIZE);
+    }
+}
+
+
+void stb_init(void)
+{
+    sal_init();
+}
+
+
+void stb_restart(void)
+{
+    sal_aes_restart();
+}
+
+
+stb_ccm_t stb_ccm_secure(uint8_t *buffer,
+                         uint8_t nonce[AES_BLOCKSIZE],
+                         uint8_t *key,
+                         uint8_t hdr_len,
+                         uint8_t pld_len,
+                         uint8_t sec_level,
+                         uint8_t aes_dir)
+{
+    uint8_t mic_len = mic_length(sec_level);
+    uint8_t mic[AES_BLOCKSIZE];
+    uint8_t s0[AES_BLOCKSIZE];
+    uint8_t *mic_ptr = &buffer[hdr_len + pld_len];
+    uint8_t a_len;
+    uint8_t m_len;
+    uint8_t i;
+
+    if ((sec_level == 0) || (sec_level > SEC_LEVEL_MAX) ||
+        ((uint16_t)hdr_len + pld_len + mic_len > 0xFF))
+    {
+        return STB_CCM_ILLPARM;
+    }
+
+    if (!sal_aes_setup(key, AES_MODE_ECB, AES_DIR_ENCRYPT))
+    {
+        return STB_CCM_KEYMISS;
+    }
+
+    /* Without encryption the payload is authenticated as part of string a. */
+    if (sec_level & SEC_LEVEL_ENC)
+    {
+        a_len = hdr_len;
+        m_len = pld_len;
+    }
+    else
+    {
+        a_len = hdr_len + pld_len;
+        m_len = 0;
+    }
+
+    if (aes_dir == AES_DIR_ENCRYPT)
+    {
+        /* The MIC covers the plaintext, so it is computed first. */
+        if (mic_len > 0)
+        {
+            compute_mic(buffer, nonce, mic_len, a_len, m_len, mic);
+        }
+
+        ctr_crypt(&buffer[a_len], m_len, nonce, s0);
+
+        for (i = 0; i < mic_len; i++)
+        {
+            mic_ptr[i] = mic[i] ^ s0[i];
+        }
+    }
+    else
+    {
+        uint8_t diff = 0;
+
+        ctr_crypt(&buffer[a_len], m_len, nonce, s0);
+
+        if (mic_len > 0)
+        {
+            compute_mic(buffer, nonce, mic_len, a_len, m_len, mic);
+
+            /* Compare without early exit. */
+            for (i = 0; i < mic_len; i++)
+            {
+                diff |= mic[i] ^ mic_ptr[i] ^ s0[i];
+            }
+        }
+
+        if (diff != 0)
+        {
+            return STB_CCM_MICERR;
+        }
+    }
+
+    return STB_CCM_OK;
+}
+
+#endif /* STB_ON_SAL */
+
+/* EOF */
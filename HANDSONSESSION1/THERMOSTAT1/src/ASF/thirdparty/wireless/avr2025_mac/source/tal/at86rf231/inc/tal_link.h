@@ -0,0 +1,190 @@
+/**
+ * @file tal_link.h
+ *
+ * @brief Link quality table and adaptive transmit power for AT86RF231
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+
+#ifdef ENABLE_LINK_TABLE
+
+/* Prevent double inclusion */
+#ifndef TAL_LINK_H
+#define TAL_LINK_H
+
+/**
+ * \ingroup group_tal_231
+ * \defgroup group_tal_link_231 Link Quality Table
+ * Tracks LQI/ED per neighbor and adapts the transmit power of acknowledged
+ * unicast frames to the weakest level that still reaches the neighbor.
+ *  @{
+ */
+
+/* === INCLUDES ============================================================ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "return_val.h"
+
+/* === MACROS ============================================================== */
+
+/** Number of neighbors tracked by the link table */
+#ifndef TAL_LINK_TABLE_SIZE
+#define TAL_LINK_TABLE_SIZE             (8)
+#endif
+
+/**
+ * Link margin (ED level in dB above the receiver base value, reduced by the
+ * current power back-off) above which the transmit power may be lowered.
+ */
+#ifndef TAL_LINK_MARGIN_HIGH_DB
+#define TAL_LINK_MARGIN_HIGH_DB         (30)
+#endif
+
+/** Link margin below which the transmit power is raised again */
+#ifndef TAL_LINK_MARGIN_LOW_DB
+#define TAL_LINK_MARGIN_LOW_DB          (15)
+#endif
+
+/** Consecutive first-attempt successes required before stepping down */
+#ifndef TAL_LINK_STEP_DOWN_STREAK
+#define TAL_LINK_STEP_DOWN_STREAK       (8)
+#endif
+
+/** Number of TX_PWR register steps to raise the power by on a weak link */
+#ifndef TAL_LINK_STEP_UP
+#define TAL_LINK_STEP_UP                (2)
+#endif
+
+/** Weight of a new sample in the LQI/ED moving averages (1/2^n) */
+#define TAL_LINK_AVG_SHIFT              (3)
+
+/* === TYPES =============================================================== */
+
+/**
+ * Link table entry
+ */
+typedef struct tal_link_tag
+{
+    /** Neighbor address, short addresses are stored zero-extended */
+    uint64_t addr;
+    /** FCF_SHORT_ADDR or FCF_LONG_ADDR, FCF_NO_ADDR marks an unused entry */
+    uint8_t addr_mode;
+    /** Moving average of the normalized LQI, scaled by 2^TAL_LINK_AVG_SHIFT */
+    uint16_t lqi_avg;
+    /** Moving average of the ED level, scaled by 2^TAL_LINK_AVG_SHIFT */
+    uint16_t ed_avg;
+    /** Number of frames received from this neighbor */
+    uint16_t rx_count;
+    /** TX_PWR register value used towards this neighbor */
+    uint8_t pwr_reg;
+    /** Consecutive acknowledged transmissions without retries */
+    uint8_t streak;
+    /** Number of acknowledged-unicast transmissions towards this neighbor */
+    uint16_t tx_count;
+    /** Number of those transmissions that ended with NO_ACK */
+    uint16_t tx_no_ack;
+    /** Number of frame retries, only counted with SW_CONTROLLED_CSMA */
+    uint16_t tx_retries;
+    /** Age stamp used for least-recently-used replacement */
+    uint16_t last_used;
+} tal_link_t;
+
+/* === PROTOTYPES ========================================================== */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * \brief Clears the link table
+     */
+    void tal_link_init(void);
+
+    /**
+     * \brief Updates the link entry of the sender of a received frame
+     *
+     * \param mpdu Received frame, mpdu[0] holding the frame length
+     * \param lqi Normalized LQI of the frame
+     * \param ed_level ED level measured during frame reception
+     */
+    void tal_link_rx_update(uint8_t *mpdu, uint8_t lqi, uint8_t ed_level);
+
+    /**
+     * \brief Selects the transmit power for the frame to be transmitted
+     *
+     * \param mpdu Frame to be transmitted, mpdu[0] holding the frame length
+     */
+    void tal_link_tx_prepare(uint8_t *mpdu);
+
+    /**
+     * \brief Adapts the link entry to the outcome of a transmission
+     *
+     * \param mpdu Transmitted frame
+     * \param status Status reported to the MAC for this frame
+     * \param retries Number of retries needed, if known by the TAL
+     */
+    void tal_link_tx_done(uint8_t *mpdu, retval_t status, uint8_t retries);
+
+    /**
+     * \brief Reads the link entry of a neighbor
+     *
+     * \param addr_mode FCF_SHORT_ADDR or FCF_LONG_ADDR
+     * \param addr Address of the neighbor
+     * \param entry Receives a copy of the link entry
+     *
+     * \return MAC_SUCCESS if the neighbor is known, otherwise MAC_INVALID_PARAMETER
+     */
+    retval_t tal_link_get(uint8_t addr_mode, uint64_t addr, tal_link_t *entry);
+
+    //! @}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* TAL_LINK_H */
+
+#endif /* ENABLE_LINK_TABLE */
+
+/* EOF */
@@ -68,6 +68,9 @@
 #ifdef BEACON_SUPPORT
 #include "tal_slotted_csma.h"
 #endif  /* BEACON_SUPPORT */
+#ifdef ENABLE_LINK_TABLE
+#include "tal_link.h"
+#endif  /* ENABLE_LINK_TABLE */
 #ifdef ENABLE_TFA
 #include "tfa.h"
 #endif
@@ -403,6 +406,10 @@ static retval_t internal_tal_reset(bool set_default_pib)
 
     tal_rx_on_required = false;
 
+#ifdef ENABLE_LINK_TABLE
+    tal_link_init();
+#endif
+
     return MAC_SUCCESS;
 }
 
@@ -86,11 +86,14 @@
  *
  * This function handles the transceiver generated interrupts.
  */
-void trx_irq_handler_cb(void)
+PAL_RAMFUNC void trx_irq_handler_cb(void)
 {
     trx_irq_reason_t trx_irq_cause;
 
+    CACHE_PROF_BEGIN(CACHE_PROF_TAL_IRQ);
+
     trx_irq_cause = (trx_irq_reason_t)pal_trx_reg_read(RG_IRQ_STATUS);
+    PAL_TRACE2(PAL_TRACE_TRX_IRQ, trx_irq_cause, tal_state);
 
 #if (defined BEACON_SUPPORT) || (defined ENABLE_TSTAMP)
 #if (ANTENNA_DIVERSITY == 1) || (DISABLE_TSTAMP_IRQ == 1)
@@ -164,6 +167,8 @@ void trx_irq_handler_cb(void)
         }
     }
 #endif
+
+    CACHE_PROF_END(CACHE_PROF_TAL_IRQ);
 }/* trx_irq_handler_cb() */
 
 
@@ -0,0 +1,430 @@
+/**
+ * @file tal_link.c
+ *
+ * @brief Link quality table and adaptive transmit power for AT86RF231
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+/*
+ * Copyright (c) 2013, Atmel Corporation All rights reserved.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+
+#ifdef ENABLE_LINK_TABLE
+
+/* === INCLUDES ============================================================ */
+
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include "pal.h"
+#include "return_val.h"
+#include "tal.h"
+#include "ieee_const.h"
+#include "tal_constants.h"
+#include "tal_pib.h"
+#include "at86rf231.h"
+#include "tal_internal.h"
+#include "tal_link.h"
+
+/* === TYPES =============================================================== */
+
+
+/* === MACROS ============================================================== */
+
+/* Weakest TX_PWR register value of the AT86RF231 (-17 dBm) */
+#define TAL_LINK_PWR_REG_MIN            (15)
+
+/* Address mode bits of the frame control field */
+#define LINK_ADDR_MODE(fcf, offset)     (((fcf) >> (offset)) & 0x03)
+
+/* === GLOBALS ============================================================= */
+
+static tal_link_t link_table[TAL_LINK_TABLE_SIZE];
+static uint16_t link_age;
+
+/* Register to dBm translation table, see tal_pib.c */
+FLASH_EXTERN(int8_t tx_pwr_table[16]);
+
+/* === PROTOTYPES ========================================================== */
+
+uint8_t convert_phyTransmitPower_to_reg_value(uint8_t phyTransmitPower_value);
+static bool link_addr_parse(uint8_t *mpdu, bool source, uint8_t *addr_mode,
+                            uint64_t *addr);
+static tal_link_t *link_find(uint8_t addr_mode, uint64_t addr, bool create);
+static uint8_t link_pwr_ceiling(void);
+
+/* === IMPLEMENTATION ====================================================== */
+
+/*
+ * \brief Clears the link table
+ */
+void tal_link_init(void)
+{
+    memset(link_table, 0, sizeof(link_table));
+    link_age = 0;
+}
+
+
+/*
+ * \brief Updates the link entry of the sender of a received frame
+ *
+ * Frames without a source address (i.e. acknowledgements) are ignored.
+ *
+ * \param mpdu Received frame, mpdu[0] holding the frame length
+ * \param lqi Normalized LQI of the frame
+ * \param ed_level ED level measured during frame reception
+ */
+void tal_link_rx_update(uint8_t *mpdu, uint8_t lqi, uint8_t ed_level)
+{
+    uint8_t addr_mode;
+    uint64_t addr;
+    tal_link_t *entry;
+
+    if (!link_addr_parse(mpdu, true, &addr_mode, &addr))
+    {
+        return;
+    }
+
+    entry = link_find(addr_mode, addr, true);
+
+    if (entry->rx_count == 0)
+    {
+        /* First sample seeds the averages. */
+        entry->lqi_avg = (uint16_t)lqi << TAL_LINK_AVG_SHIFT;
+        entry->ed_avg = (uint16_t)ed_level << TAL_LINK_AVG_SHIFT;
+    }
+    else
+    {
+        entry->lqi_avg = entry->lqi_avg - (entry->lqi_avg >> TAL_LINK_AVG_SHIFT) + lqi;
+        entry->ed_avg = entry->ed_avg - (entry->ed_avg >> TAL_LINK_AVG_SHIFT) + ed_level;
+    }
+
+    if (entry->rx_count < UINT16_MAX)
+    {
+        entry->rx_count++;
+    }
+}
+
+
+/*
+ * \brief Selects the transmit power for the frame to be transmitted
+ *
+ * Only acknowledged unicast frames are sent with reduced power, since only
+ * those report back whether the neighbor still receives them. Everything
+ * else goes out at the power configured by phyTransmitPower.
+ *
+ * \param mpdu Frame to be transmitted, mpdu[0] holding the frame length
+ */
+void tal_link_tx_prepare(uint8_t *mpdu)
+{
+    uint8_t ceiling = link_pwr_ceiling();
+    uint8_t pwr_reg = ceiling;
+    uint8_t addr_mode;
+    uint64_t addr;
+
+    if ((mpdu[PL_POS_FCF_1] & FCF_ACK_REQUEST) &&
+        link_addr_parse(mpdu, false, &addr_mode, &addr))
+    {
+        tal_link_t *entry = link_find(addr_mode, addr, true);
+
+        /* phyTransmitPower may have been lowered since the last frame. */
+        if (entry->pwr_reg < ceiling)
+        {
+            entry->pwr_reg = ceiling;
+        }
+        pwr_reg = entry->pwr_reg;
+    }
+
+    pal_trx_bit_write(SR_TX_PWR, pwr_reg);
+}
+
+
+/*
+ * \brief Adapts the link entry to the outcome of a transmission
+ *
+ * The power towards a neighbor is raised on a missing ACK, on retries or if
+ * the received ED level indicates a weak link. It is lowered one step at a
+ * time after TAL_LINK_STEP_DOWN_STREAK first-attempt successes while the
+ * link margin is still high. Without SW_CONTROLLED_CSMA the transceiver
+ * handles retries itself and does not report them, so only NO_ACK counts.
+ *
+ * \param mpdu Transmitted frame
+ * \param status Status reported to the MAC for this frame
+ * \param retries Number of retries needed, if known by the TAL
+ */
+void tal_link_tx_done(uint8_t *mpdu, retval_t status, uint8_t retries)
+{
+    uint8_t ceiling = link_pwr_ceiling();
+    uint8_t addr_mode;
+    uint64_t addr;
+    tal_link_t *entry;
+
+    /*
+     * Restore the configured power, automatically transmitted ACKs for
+     * other neighbors must not use the reduced level.
+     */
+    pal_trx_bit_write(SR_TX_PWR, ceiling);
+
+    if (!(mpdu[PL_POS_FCF_1] & FCF_ACK_REQUEST) ||
+        !link_addr_parse(mpdu, false, &addr_mode, &addr))
+    {
+        return;
+    }
+
+    entry = link_find(addr_mode, addr, false);
+    if ((entry == NULL) || (status == MAC_CHANNEL_ACCESS_FAILURE))
+    {
+        /* Nothing has been learned about the link itself. */
+        return;
+    }
+
+    entry->tx_count++;
+    entry->tx_retries += retries;
+
+    /* Margin left at the neighbor if the link is symmetric. */
+    int16_t margin = (int16_t)(entry->ed_avg >> TAL_LINK_AVG_SHIFT) -
+                     ((int8_t)PGM_READ_BYTE(&tx_pwr_table[ceiling]) -
+                      (int8_t)PGM_READ_BYTE(&tx_pwr_table[entry->pwr_reg]));
+
+    if ((status == MAC_NO_ACK) || (retries > 0) ||
+        ((entry->rx_count != 0) && (margin < TAL_LINK_MARGIN_LOW_DB)))
+    {
+        if (status == MAC_NO_ACK)
+        {
+            entry->tx_no_ack++;
+        }
+        entry->streak = 0;
+        if (entry->pwr_reg >= ceiling + TAL_LINK_STEP_UP)
+        {
+            entry->pwr_reg -= TAL_LINK_STEP_UP;
+        }
+        else
+        {
+            entry->pwr_reg = ceiling;
+        }
+        return;
+    }
+
+    if (entry->streak < UINT8_MAX)
+    {
+        entry->streak++;
+    }
+
+    if ((entry->streak >= TAL_LINK_STEP_DOWN_STREAK) &&
+        (margin > TAL_LINK_MARGIN_HIGH_DB) &&
+        (entry->pwr_reg < TAL_LINK_PWR_REG_MIN))
+    {
+        entry->pwr_reg++;
+        entry->streak = 0;
+    }
+}
+
+
+/*
+ * \brief Reads the link entry of a neighbor
+ *
+ * \param addr_mode FCF_SHORT_ADDR or FCF_LONG_ADDR
+ * \param addr Address of the neighbor
+ * \param entry Receives a copy of the link entry
+ *
+ * \return MAC_SUCCESS if the neighbor is known, otherwise MAC_INVALID_PARAMETER
+ */
+retval_t tal_link_get(uint8_t addr_mode, uint64_t addr, tal_link_t *entry)
+{
+    tal_link_t *link = link_find(addr_mode, addr, false);
+
+    if (link == NULL)
+    {
+        return MAC_INVALID_PARAMETER;
+    }
+
+    *entry = *link;
+
+    return MAC_SUCCESS;
+}
+
+
+/*
+ * \brief Extracts the source or destination address of a frame
+ *
+ * \param mpdu Frame, mpdu[0] holding the frame length
+ * \param source true for the source address, false for the destination
+ * \param addr_mode Returns the address mode
+ * \param addr Returns the address, short addresses zero-extended
+ *
+ * \return true if the frame carries a unicast address of the requested kind
+ */
+static bool link_addr_parse(uint8_t *mpdu, bool source, uint8_t *addr_mode,
+                            uint64_t *addr)
+{
+    uint16_t fcf = convert_byte_array_to_16_bit(&mpdu[PL_POS_FCF_1]);
+    uint8_t dst_mode = LINK_ADDR_MODE(fcf, FCF_DEST_ADDR_OFFSET);
+    uint8_t src_mode = LINK_ADDR_MODE(fcf, FCF_SOURCE_ADDR_OFFSET);
+    uint8_t *ptr = &mpdu[PL_POS_DST_PAN_ID_START];
+    uint8_t mode;
+
+    if (dst_mode != FCF_NO_ADDR)
+    {
+        ptr += sizeof(uint16_t);
+    }
+
+    if (source)
+    {
+        mode = src_mode;
+        if (dst_mode == FCF_SHORT_ADDR)
+        {
+            ptr += sizeof(uint16_t);
+        }
+        else if (dst_mode == FCF_LONG_ADDR)
+        {
+            ptr += sizeof(uint64_t);
+        }
+        if (!(fcf & FCF_PAN_ID_COMPRESSION))
+        {
+            ptr += sizeof(uint16_t);
+        }
+    }
+    else
+    {
+        mode = dst_mode;
+    }
+
+    if ((mode != FCF_SHORT_ADDR) && (mode != FCF_LONG_ADDR))
+    {
+        return false;
+    }
+
+    /* Guard against truncated or malformed frames. */
+    if ((ptr - mpdu) + ((mode == FCF_SHORT_ADDR) ? 2 : 8) > mpdu[0] + 1)
+    {
+        return false;
+    }
+
+    *addr = 0;
+    if (mode == FCF_SHORT_ADDR)
+    {
+        memcpy(addr, ptr, sizeof(uint16_t));
+        if (*addr == BROADCAST)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        memcpy(addr, ptr, sizeof(uint64_t));
+    }
+
+    *addr_mode = mode;
+
+    return true;
+}
+
+
+/*
+ * \brief Looks up the link entry of a neighbor
+ *
+ * \param addr_mode Address mode of the neighbor
+ * \param addr Address of the neighbor
+ * \param create Replace the least recently used entry if not found
+ *
+ * \return Pointer to the entry or NULL
+ */
+static tal_link_t *link_find(uint8_t addr_mode, uint64_t addr, bool create)
+{
+    tal_link_t *oldest = NULL;
+    tal_link_t *unused = NULL;
+
+    link_age++;
+
+    for (uint8_t i = 0; i < TAL_LINK_TABLE_SIZE; i++)
+    {
+        tal_link_t *entry = &link_table[i];
+
+        if (entry->addr_mode == FCF_NO_ADDR)
+        {
+            if (unused == NULL)
+            {
+                unused = entry;
+            }
+        }
+        else if ((entry->addr_mode == addr_mode) && (entry->addr == addr))
+        {
+            entry->last_used = link_age;
+            return entry;
+        }
+        else if ((oldest == NULL) ||
+                 ((uint16_t)(link_age - entry->last_used) >
+                  (uint16_t)(link_age - oldest->last_used)))
+        {
+            oldest = entry;
+        }
+    }
+
+    if (!create)
+    {
+        return NULL;
+    }
+
+    if (unused != NULL)
+    {
+        oldest = unused;
+    }
+
+    memset(oldest, 0, sizeof(tal_link_t));
+    oldest->addr_mode = addr_mode;
+    oldest->addr = addr;
+    oldest->pwr_reg = link_pwr_ceiling();
+    oldest->last_used = link_age;
+
+    return oldest;
+}
+
+
+/*
+ * \brief Returns the TX_PWR register value configured by phyTransmitPower
+ */
+static uint8_t link_pwr_ceiling(void)
+{
+    return convert_phyTransmitPower_to_reg_value(tal_pib.TransmitPower);
+}
+
+#endif /* ENABLE_LINK_TABLE */
+
+/* EOF */
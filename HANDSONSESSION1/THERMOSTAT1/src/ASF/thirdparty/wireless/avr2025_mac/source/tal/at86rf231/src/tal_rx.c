@@ -66,6 +66,9 @@
 #ifdef BEACON_SUPPORT
 #include "tal_slotted_csma.h"
 #endif  /* BEACON_SUPPORT */
+#ifdef ENABLE_LINK_TABLE
+#include "tal_link.h"
+#endif  /* ENABLE_LINK_TABLE */
 
 
 
@@ -149,6 +152,8 @@ void handle_received_frame_irq(void)
     /* Get frame length from transceiver. */
     pal_trx_frame_read(&phy_frame_len, LENGTH_FIELD_LEN);
 
+    PAL_TRACE2(PAL_TRACE_TRX_RX_FRAME, phy_frame_len, ed_value);
+
     /* Check for valid frame length. */
     if (phy_frame_len > 127)
     {
@@ -326,6 +331,10 @@ void process_incoming_frame(buffer_t *buf_ptr)
     /* Store normalized LQI value again. */
     frame_ptr--;
     *frame_ptr = lqi;
+
+#ifdef ENABLE_LINK_TABLE
+    tal_link_rx_update(receive_frame->mpdu, lqi, ed_level);
+#endif
 #endif  /* #ifndef TRX_REG_RAW_VALUE */
 
 #if (defined TX_OCTET_COUNTER) && (defined SW_CONTROLLED_CSMA)
@@ -70,6 +70,9 @@
 #ifdef BEACON_SUPPORT
 #include "tal_slotted_csma.h"
 #endif  /* BEACON_SUPPORT */
+#ifdef ENABLE_LINK_TABLE
+#include "tal_link.h"
+#endif  /* ENABLE_LINK_TABLE */
 #include "mac_build_config.h"
 
 
@@ -143,6 +146,11 @@ retval_t tal_tx_frame(frame_info_t *tx_frame, csma_mode_t csma_mode,
         return MAC_INVALID_PARAMETER;
     }
 
+#ifdef ENABLE_LINK_TABLE
+    /* Select the transmit power towards the destination. */
+    tal_link_tx_prepare(tal_frame_to_tx);
+#endif
+
 #ifdef BEACON_SUPPORT
     /* Check if beacon mode is used */
     if (csma_mode == CSMA_SLOTTED)
@@ -303,6 +311,14 @@ void tx_done_handling(void)
             break;
     }
 
+#ifdef ENABLE_LINK_TABLE
+#ifdef SW_CONTROLLED_CSMA
+    tal_link_tx_done(tal_frame_to_tx, status, number_of_tx_retries);
+#else
+    tal_link_tx_done(tal_frame_to_tx, status, 0);
+#endif
+#endif  /* ENABLE_LINK_TABLE */
+
     tal_tx_frame_done_cb(status, mac_frame_ptr);
 } /* tx_done_handling() */
 
@@ -432,6 +448,7 @@ void handle_tx_end_irq(bool underrun_occured)
         {
             trx_trac_status = (trx_trac_status_t)pal_trx_bit_read(SR_TRAC_STATUS);
         }
+        PAL_TRACE1(PAL_TRACE_TRX_TX_END, trx_trac_status);
 
 #ifdef BEACON_SUPPORT
         if (tal_csma_state == FRAME_SENDING)    // Transmission was issued by slotted CSMA
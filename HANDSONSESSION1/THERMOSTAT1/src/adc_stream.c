@@ -0,0 +1,189 @@
+/**
+ * \file
+ *
+ * \brief Continuous ADC capture into PDCA ping-pong buffers
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#include <asf.h>
+#include "pal.h"
+#include "adc_stream.h"
+
+/** Sample blocks filled alternately by the PDCA */
+static uint16_t stream_buf[2][ADC_STREAM_BLOCK_SIZE];
+/** Index of the block currently held in the PDCA reload registers */
+static volatile uint8_t reload_idx;
+/** Last completed block not yet taken by the application */
+static uint16_t *volatile ready_block;
+/** Number of blocks completed before the previous one was taken */
+static volatile uint16_t overruns;
+
+static adc_stream_callback_t stream_callback;
+
+/**
+ * \brief PDCA reload counter reached zero
+ *
+ * The PDCA has moved on to the block held in the reload registers, so the
+ * block it just completed is handed to the application and queued again
+ * as the next reload. Writing the reload registers also clears the
+ * interrupt.
+ */
+PAL_RAMFUNC static void adc_stream_pdca_cb(enum pdca_channel_status status)
+{
+	uint16_t *done;
+
+	if (status != PDCA_CH_COUNTER_RELOAD_IS_ZERO) {
+		return;
+	}
+
+	CACHE_PROF_BEGIN(CACHE_PROF_ADC_CB);
+
+	/* The PDCA now fills stream_buf[reload_idx]. */
+	done = stream_buf[reload_idx ^ 1];
+	pdca_channel_write_reload(ADC_STREAM_PDCA_CHANNEL, done,
+			ADC_STREAM_BLOCK_SIZE);
+	reload_idx ^= 1;
+
+	if (ready_block != NULL) {
+		overruns++;
+	}
+	ready_block = done;
+
+	if (stream_callback) {
+		stream_callback();
+	}
+
+	CACHE_PROF_END(CACHE_PROF_ADC_CB);
+}
+
+/**
+ * \brief Start continuous capture on the configured sequencer channel
+ *
+ * The ADC must be initialized and enabled and its channel configured with
+ * adc_ch_set_config() before. The trigger is switched to the internal
+ * timer, whose period is derived from the prescaled APB clock.
+ *
+ * \param[in]  dev_inst  ADC instance
+ * \param[in]  callback  Called from interrupt context once per full block
+ *
+ * \return true if the capture was started
+ */
+bool adc_stream_start(struct adc_dev_inst *const dev_inst,
+		adc_stream_callback_t callback)
+{
+	uint32_t adc_hz;
+
+	pdca_channel_config_t pdca_cfg = {
+		/* First block */
+		.addr = (void *)stream_buf[0],
+		/* Conversion results of the ADC */
+		.pid = ADCIFE_PDCA_ID_RX,
+		.size = ADC_STREAM_BLOCK_SIZE,
+		/* Second block, taken over by the PDCA when the first is full */
+		.r_addr = (void *)stream_buf[1],
+		.r_size = ADC_STREAM_BLOCK_SIZE,
+		/* LCV.LDATA */
+		.transfer_size = PDCA_MR_SIZE_HALF_WORD
+	};
+
+	adc_hz = sysclk_get_pba_hz() >> (dev_inst->adc_cfg->prescal + 2);
+	if ((adc_hz / ADC_STREAM_SAMPLE_HZ) == 0 ||
+			(adc_hz / ADC_STREAM_SAMPLE_HZ) > (ADCIFE_ITIMER_ITMC_Msk + 1)) {
+		return false;
+	}
+
+	stream_callback = callback;
+	reload_idx = 1;
+	ready_block = NULL;
+	overruns = 0;
+
+	pdca_enable(PDCA);
+	pdca_channel_set_config(ADC_STREAM_PDCA_CHANNEL, &pdca_cfg);
+	pdca_channel_set_callback(ADC_STREAM_PDCA_CHANNEL, adc_stream_pdca_cb,
+			PDCA_0_IRQn + ADC_STREAM_PDCA_CHANNEL, 1, PDCA_IER_RCZ);
+	pdca_channel_enable(ADC_STREAM_PDCA_CHANNEL);
+
+	/* The PDCA is an HSB master and stops with the HSB clock. */
+	sleepmgr_lock_mode(SLEEPMGR_SLEEP_0);
+
+	adc_configure_trigger(dev_inst, ADC_TRIG_INTL_TIMER);
+	adc_configure_itimer_period(dev_inst, (adc_hz / ADC_STREAM_SAMPLE_HZ) - 1);
+	adc_start_itimer(dev_inst);
+
+	return true;
+}
+
+/**
+ * \brief Stop continuous capture
+ *
+ * \param[in]  dev_inst  ADC instance
+ */
+void adc_stream_stop(struct adc_dev_inst *const dev_inst)
+{
+	adc_stop_itimer(dev_inst);
+	pdca_channel_disable_interrupt(ADC_STREAM_PDCA_CHANNEL, PDCA_IDR_RCZ);
+	pdca_channel_disable(ADC_STREAM_PDCA_CHANNEL);
+	sleepmgr_unlock_mode(SLEEPMGR_SLEEP_0);
+	ready_block = NULL;
+}
+
+/**
+ * \brief Take the last completed block
+ *
+ * \return Pointer to \ref ADC_STREAM_BLOCK_SIZE samples, or NULL if no new
+ *         block was completed since the last call
+ */
+uint16_t *adc_stream_get_block(void)
+{
+	uint16_t *block;
+
+	cpu_irq_disable();
+	block = ready_block;
+	ready_block = NULL;
+	cpu_irq_enable();
+
+	return block;
+}
+
+/**
+ * \brief Number of blocks that were replaced before the application took them
+ */
+uint16_t adc_stream_get_overruns(void)
+{
+	return overruns;
+}
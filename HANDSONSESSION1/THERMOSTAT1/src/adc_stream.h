@@ -0,0 +1,90 @@
+/**
+ * \file
+ *
+ * \brief Continuous ADC capture into PDCA ping-pong buffers
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#ifndef ADC_STREAM_H_INCLUDED
+#define ADC_STREAM_H_INCLUDED
+
+#include <compiler.h>
+#include <adcife.h>
+
+/**
+ * \defgroup adc_stream_group Continuous ADC capture
+ *
+ * The ADC internal timer triggers the conversions and the PDCA moves each
+ * result into one of two sample blocks. When a block is full the PDCA
+ * continues with the other one from its reload registers and the
+ * application is notified once per block, so no interrupt is taken per
+ * sample.
+ *
+ * A completed block stays valid until the other block is full, i.e. for
+ * \ref ADC_STREAM_BLOCK_SIZE sample periods.
+ *
+ * @{
+ */
+
+/** Number of samples per block */
+#ifndef ADC_STREAM_BLOCK_SIZE
+#define ADC_STREAM_BLOCK_SIZE           (256)
+#endif
+
+/** Conversion rate in Hz */
+#ifndef ADC_STREAM_SAMPLE_HZ
+#define ADC_STREAM_SAMPLE_HZ            (256UL)
+#endif
+
+/** PDCA channel receiving the conversion results */
+#ifndef ADC_STREAM_PDCA_CHANNEL
+#define ADC_STREAM_PDCA_CHANNEL         CONFIG_ADC_PDCA_RX_CHANNEL
+#endif
+
+/** Callback invoked from the PDCA interrupt when a block is full */
+typedef void (*adc_stream_callback_t)(void);
+
+bool adc_stream_start(struct adc_dev_inst *const dev_inst,
+		adc_stream_callback_t callback);
+void adc_stream_stop(struct adc_dev_inst *const dev_inst);
+uint16_t *adc_stream_get_block(void);
+uint16_t adc_stream_get_overruns(void);
+
+/** @} */
+
+#endif /* ADC_STREAM_H_INCLUDED */
@@ -46,4 +46,9 @@ module that acts as a USB CDC gateway over the USB JLink plug. */
 /* Initialize the DACC VOUT pin */
 #define CONF_BOARD_DACC_VOUT
 
+#ifdef ENABLE_TRACE
+/* Initialize the virtual COM port used for the binary trace */
+#define CONF_BOARD_COM_PORT
+#endif
+
 #endif // CONF_BOARD_H_INCLUDED
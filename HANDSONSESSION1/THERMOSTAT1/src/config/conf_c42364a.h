@@ -77,4 +77,10 @@
 /** Text scrolling configuration. */
 #define CONF_C42364A_TEXT_SCROLLING_TIMER        LCDCA_TIMER_FC0
 
+/**
+ * Commit numeric and battery updates from the LCDCA frame interrupt
+ * instead of immediately.
+ */
+//#define CONF_C42364A_FRAME_SYNC
+
 #endif /* CONF_C42364A_H_INCLUDED */
@@ -0,0 +1,237 @@
+/**
+ * \file
+ *
+ * \brief CPU clock and power scaling governor
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#include <asf.h>
+#include "common_sw_timer.h"
+#include "dvfs.h"
+
+/** Current CPU clock in Hz */
+static uint32_t dvfs_cpu_hz = DVFS_LOW_HZ;
+
+/** Number of outstanding requests for the high level */
+static uint8_t request_count;
+
+/** PAL time of the last level switch */
+static uint32_t level_since;
+/** Charge used up to \ref level_since, in pC */
+static uint64_t charge_pc;
+
+/** PAL time and charge at dvfs_task_begin() */
+static uint32_t task_start;
+static uint64_t task_start_pc;
+
+/**
+ * \brief Charge used up to now, in pC
+ *
+ * This is an estimate, not a measurement: the time spent at the current
+ * level is multiplied by the configured run current of the level
+ * (\ref DVFS_LOW_RUN_UA or \ref DVFS_HIGH_RUN_UA). Sleep currents and the
+ * current drawn by the peripherals are not accounted for.
+ */
+static uint64_t dvfs_charge_now(uint32_t now)
+{
+	uint32_t run_ua = (dvfs_cpu_hz == DVFS_HIGH_HZ) ?
+			DVFS_HIGH_RUN_UA : DVFS_LOW_RUN_UA;
+
+	return charge_pc + (uint64_t)(now - level_since) * run_ua;
+}
+
+/**
+ * \brief Close the charge integral of the current level
+ */
+static void dvfs_account(void)
+{
+	uint32_t now = sw_timer_get_time();
+
+	charge_pc = dvfs_charge_now(now);
+	level_since = now;
+}
+
+/**
+ * \brief Set the flash and the regulator for the low level
+ *
+ * The CPU must already run at \ref DVFS_LOW_HZ.
+ */
+static void dvfs_enter_ps1(void)
+{
+	flash_set_bus_freq(DVFS_LOW_HZ, BPM_PS_1,
+			DVFS_LOW_HZ > FLASH_FREQ_PS1_FWS_0_MAX_FREQ);
+
+	bpm_configure_power_scaling(BPM, BPM_PS_1, BPM_PSCM_CPU_NOT_HALT);
+	while ((bpm_get_status(BPM) & BPM_SR_PSOK) == 0);
+}
+
+/**
+ * \brief Switch the CPU to PLL0 in power scaling mode 0
+ *
+ * The flash gets its wait state before the clock rises. The source is
+ * switched before the peripheral bus dividers, so the buses are never
+ * slower than nominal.
+ */
+static void dvfs_raise(void)
+{
+	irqflags_t flags;
+
+	dvfs_account();
+
+	bpm_configure_power_scaling(BPM, BPM_PS_0, BPM_PSCM_CPU_NOT_HALT);
+	while ((bpm_get_status(BPM) & BPM_SR_PSOK) == 0);
+
+	pll_enable_config_defaults(0);
+	flash_set_bus_freq(DVFS_HIGH_HZ, BPM_PS_0, false);
+
+	/* The clock sources must keep running while sleeping */
+	sleepmgr_lock_mode(SLEEPMGR_SLEEP_2);
+
+	flags = cpu_irq_save();
+	sysclk_set_source(SYSCLK_SRC_PLL0);
+	sysclk_set_prescalers(0,
+			CONFIG_SYSCLK_PBA_DIV + DVFS_HIGH_PB_SHIFT,
+			CONFIG_SYSCLK_PBB_DIV + DVFS_HIGH_PB_SHIFT,
+			CONFIG_SYSCLK_PBC_DIV + DVFS_HIGH_PB_SHIFT,
+			CONFIG_SYSCLK_PBD_DIV + DVFS_HIGH_PB_SHIFT);
+	dvfs_cpu_hz = DVFS_HIGH_HZ;
+	cpu_irq_restore(flags);
+}
+
+/**
+ * \brief Return the CPU to OSC0 in power scaling mode 1
+ *
+ * Mirrors dvfs_raise(): the dividers are restored before the source, and
+ * the flash wait state is reduced once the clock is down.
+ */
+static void dvfs_lower(void)
+{
+	irqflags_t flags;
+
+	dvfs_account();
+
+	flags = cpu_irq_save();
+	sysclk_set_prescalers(0,
+			CONFIG_SYSCLK_PBA_DIV,
+			CONFIG_SYSCLK_PBB_DIV,
+			CONFIG_SYSCLK_PBC_DIV,
+			CONFIG_SYSCLK_PBD_DIV);
+	sysclk_set_source(SYSCLK_SRC_OSC0);
+	dvfs_cpu_hz = DVFS_LOW_HZ;
+	cpu_irq_restore(flags);
+
+	sleepmgr_unlock_mode(SLEEPMGR_SLEEP_2);
+
+	pll_disable(0);
+	dvfs_enter_ps1();
+}
+
+/**
+ * \brief Initialize the governor at the low level
+ *
+ * sysclk_init() leaves the part in power scaling mode 0, it is switched to
+ * mode 1 here. Must be called after sysclk_init(), sleepmgr_init() and
+ * sw_timer_init(), and before the first dvfs_request().
+ */
+void dvfs_init(void)
+{
+	request_count = 0;
+	dvfs_cpu_hz = DVFS_LOW_HZ;
+	dvfs_enter_ps1();
+	charge_pc = 0;
+	level_since = sw_timer_get_time();
+}
+
+/**
+ * \brief Request the high level
+ *
+ * Switches the clock when called for the first time. Must not be called
+ * from interrupt context, the switch waits for the PLL and the regulator.
+ */
+void dvfs_request(void)
+{
+	Assert(request_count < UINT8_MAX);
+
+	if (request_count++ == 0) {
+		dvfs_raise();
+	}
+}
+
+/**
+ * \brief Release a request taken with dvfs_request()
+ */
+void dvfs_release(void)
+{
+	Assert(request_count > 0);
+
+	if (--request_count == 0) {
+		dvfs_lower();
+	}
+}
+
+/**
+ * \brief Return the current CPU clock in Hz
+ */
+uint32_t dvfs_get_cpu_hz(void)
+{
+	return dvfs_cpu_hz;
+}
+
+/**
+ * \brief Start measuring a task
+ */
+void dvfs_task_begin(void)
+{
+	task_start = sw_timer_get_time();
+	task_start_pc = dvfs_charge_now(task_start);
+}
+
+/**
+ * \brief Add the task measured since dvfs_task_begin() to \a stats
+ *
+ * \param stats  Statistics of the task
+ */
+void dvfs_task_end(struct dvfs_task_stats *stats)
+{
+	uint32_t now = sw_timer_get_time();
+
+	stats->runs++;
+	stats->time_us += now - task_start;
+	stats->charge_nc += (uint32_t)((dvfs_charge_now(now) - task_start_pc)
+			/ 1000);
+}
@@ -0,0 +1,126 @@
+/**
+ * \file
+ *
+ * \brief CPU clock and power scaling governor
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#ifndef DVFS_H_INCLUDED
+#define DVFS_H_INCLUDED
+
+#include <compiler.h>
+#include <sysclk.h>
+
+/**
+ * \defgroup dvfs_group CPU clock and power scaling governor
+ *
+ * The CPU runs from OSC0 in power scaling mode 1 while idle. As long as
+ * at least one dvfs_request() is outstanding it runs from PLL0 in power
+ * scaling mode 0 instead, e.g. while the MAC builds a frame or a sample
+ * block is filtered.
+ *
+ * Only the CPU and HSB clocks change. The peripheral buses are divided
+ * down from PLL0 to the OSC0 frequency, so the rates the drivers derive
+ * from conf_clock.h (sysclk_get_pba_hz() etc.) stay valid at both
+ * levels. Flash wait states and read mode follow each switch. The loop
+ * delays keep using the low clock from conf_clock.h, so at the high level
+ * they last up to DVFS_HIGH_HZ / DVFS_LOW_HZ times longer than asked;
+ * dvfs_get_cpu_hz() returns the clock actually used.
+ *
+ * While the CPU runs from PLL0 the sleep manager is held in SLEEP_2 or
+ * shallower, where the clock sources keep running.
+ *
+ * One task at a time can be measured with dvfs_task_begin() and
+ * dvfs_task_end(). The time is taken from the PAL timer, the charge is
+ * estimated from the time spent at each level and the run currents
+ * \ref DVFS_LOW_RUN_UA and \ref DVFS_HIGH_RUN_UA.
+ *
+ * @{
+ */
+
+/** CPU clock while idle */
+#define DVFS_LOW_HZ                     (BOARD_OSC0_HZ)
+
+/** CPU clock on request */
+#define DVFS_HIGH_HZ                    \
+	(BOARD_OSC0_HZ * CONFIG_PLL0_MUL / CONFIG_PLL0_DIV)
+
+/** Peripheral bus divider at \ref DVFS_HIGH_HZ, as a power of two */
+#define DVFS_HIGH_PB_SHIFT              (2)
+
+/**
+ * Run current at \ref DVFS_LOW_HZ in uA. The default is a rough typical
+ * value, replace it with one measured with the board monitor.
+ */
+#ifndef DVFS_LOW_RUN_UA
+#define DVFS_LOW_RUN_UA                 (1500UL)
+#endif
+
+/** Run current at \ref DVFS_HIGH_HZ in uA, see \ref DVFS_LOW_RUN_UA */
+#ifndef DVFS_HIGH_RUN_UA
+#define DVFS_HIGH_RUN_UA                (7000UL)
+#endif
+
+#if (CONFIG_SYSCLK_SOURCE != SYSCLK_SRC_OSC0) || (CONFIG_SYSCLK_CPU_DIV != 0)
+#error "DVFS requires the CPU to be clocked from OSC0 without divider"
+#endif
+
+#if (DVFS_HIGH_HZ >> DVFS_HIGH_PB_SHIFT) != DVFS_LOW_HZ
+#error "DVFS_HIGH_PB_SHIFT must keep the peripheral bus clocks"
+#endif
+
+/** Time and estimated charge of a measured task */
+struct dvfs_task_stats {
+	/** Number of measured runs */
+	uint32_t runs;
+	/** Total run time in us */
+	uint32_t time_us;
+	/** Total estimated charge in nC */
+	uint32_t charge_nc;
+};
+
+void dvfs_init(void);
+void dvfs_request(void);
+void dvfs_release(void);
+uint32_t dvfs_get_cpu_hz(void);
+void dvfs_task_begin(void);
+void dvfs_task_end(struct dvfs_task_stats *stats);
+
+/** @} */
+
+#endif /* DVFS_H_INCLUDED */
@@ -41,10 +41,23 @@
  */
 #include <asf.h>
 #include "temp_sensor.h"
+#include "slot_schedule.h"
 
 /** Flag to set when radio is ready to operate */
 extern bool radio_ready;
 
+#ifdef ENABLE_TSTAMP
+/** Transmit time of the last acknowledged data frame */
+extern volatile uint32_t radio_tx_timestamp;
+/** Receive time of the last data frame */
+extern volatile uint32_t radio_rx_timestamp;
+#endif  /* ENABLE_TSTAMP */
+
+#if (APP_SAMPLE_LOG == 1)
+/** Hands the result of a data request to the application */
+extern void app_tx_confirm(bool success);
+#endif
+
 /**
  * \brief Callback function indicating network search
  *
@@ -56,8 +69,9 @@ extern bool radio_ready;
  *
  * \param[in] msduHandle  Handle of MSDU handed over to MAC earlier
  * \param[in] status      Result for requested data transmission request
- * \param[in] Timestamp   The time, in symbols, at which the data were transmitted
- *                    (only if timestamping is enabled).
+ * \param[in] Timestamp   The time, in microseconds of the PAL timer, at which
+ *                        the data were transmitted (only if timestamping is
+ *                        enabled).
  *
  */
 #ifdef ENABLE_TSTAMP
@@ -71,6 +85,22 @@ void usr_mcps_data_conf(
 		uint8_t status)
 #endif  /* ENABLE_TSTAMP */
 {
+#ifdef ENABLE_TSTAMP
+	if (status == MAC_SUCCESS) {
+		radio_tx_timestamp = Timestamp;
+	}
+#endif  /* ENABLE_TSTAMP */
+#if (APP_SLOT_SCHEDULE == 1)
+	/* Sync frames of the coordinator are not acknowledged */
+	if (msduHandle == SLOT_SYNC_MSDU_HANDLE) {
+		return;
+	}
+#endif
+	/* Taken in send_data() */
+	sleepmgr_unlock_mode(SLEEPMGR_SLEEP_1);
+#if (APP_SAMPLE_LOG == 1)
+	app_tx_confirm(status == MAC_SUCCESS);
+#endif
 }
 
 /**
@@ -243,8 +273,9 @@ void usr_mlme_rx_enable_conf(
  * @param msdu             Pointer to MSDU
  * @param mpduLinkQuality  LQI measured during reception of the MPDU
  * @param DSN              DSN of the received data frame.
- * @param Timestamp        The time, in symbols, at which the data were received
- *                         (only if timestamping is enabled).
+ * @param Timestamp        The time, in microseconds of the PAL timer, at which
+ *                         the data were received (only if timestamping is
+ *                         enabled).
  */
 void usr_mcps_data_ind(
 		wpan_addr_spec_t *SrcAddrSpec,
@@ -259,6 +290,21 @@ void usr_mcps_data_ind(
 		uint8_t DSN)
 #endif /* ENABLE_TSTAMP */
 {
+#ifdef ENABLE_TSTAMP
+	radio_rx_timestamp = Timestamp;
+#endif  /* ENABLE_TSTAMP */
+#if (APP_COORDINATOR == 1)
+	/* Data packets carry the node ID after the start symbol */
+	if ((msduLength > 1) && (msdu[0] != SLOT_SYNC_FRAME_ID)) {
+		slot_schedule_coord_node_heard(msdu[1]);
+	}
+#elif (APP_SLOT_SCHEDULE == 1)
+	/* Sync frames from the coordinator mark the start of a slot frame */
+	if ((SrcAddrSpec->AddrMode == WPAN_ADDRMODE_SHORT) &&
+			(SrcAddrSpec->Addr.short_address == DESTINATION_SHORT_ADDR)) {
+		slot_schedule_rx_frame(msdu, msduLength, Timestamp);
+	}
+#endif  /* (APP_SLOT_SCHEDULE == 1) */
 }
 
 void usr_mlme_set_conf(
@@ -296,10 +342,25 @@ void usr_mlme_set_conf(
 		*
 		* This request leads to a set confirm message -> usr_mlme_set_conf
 		*/
+#if (APP_SLOT_SCHEDULE == 1) && (APP_COORDINATOR != 1)
+		/* The receiver is only enabled for the sync window */
+		bool rx_on_when_idle = false;
+#else
 		bool rx_on_when_idle = true;
+#endif
 
 		wpan_mlme_set_req(macRxOnWhenIdle, &rx_on_when_idle);
 	} else if ((status == MAC_SUCCESS) && (PIBAttribute == macRxOnWhenIdle)) {
+#if (APP_SLOT_SCHEDULE == 1)
+		/*
+		* Our slot is not shared, so skip the random backoff and
+		* transmit after a single CCA.
+		*/
+		uint8_t min_be = 0;
+
+		wpan_mlme_set_req(macMinBE, &min_be);
+	} else if ((status == MAC_SUCCESS) && (PIBAttribute == macMinBE)) {
+#endif
 		radio_ready = true;
 		c42364a_show_icon(C42364A_ICON_WLESS);
 	} else {
@@ -31,11 +31,44 @@
 #include "pal.h"
 #include "temp_sensor.h"
 #include "data_protocol.h"
+#include "slot_schedule.h"
+#include "sleep_loop.h"
+#include "dvfs.h"
+#if (APP_SAMPLE_LOG == 1)
+#include "sample_log.h"
+#endif
+#if (APP_ADC_STREAM == 1)
+#include "adc_stream.h"
+#include "sensor_filter.h"
 
+#if (ADC_STREAM_BLOCK_SIZE != SENSOR_FILTER_BLOCK_SIZE)
+#error "ADC blocks must match the filter block size"
+#endif
+
+/* Readings carry fractional bits below the ADC LSB */
+#define APP_READING_FRAC_BITS SENSOR_FILTER_FRAC_BITS
+#else
+#define APP_READING_FRAC_BITS 0
+#endif
+
+/* The window monitor replaces the per-alarm conversion when not streaming */
+#define APP_ADC_WINDOW   ((APP_ADC_STREAM != 1) && (APP_REPORT_ON_CHANGE == 1))
+
+/* Node ID in the data packets, the coordinator assigns the slot to it */
 #define PROTOCOL_ADDRESS 0x25
 
 volatile bool radio_ready = false;
 
+#ifdef ENABLE_TSTAMP
+/*
+ * Transceiver IRQ timestamps of the last sent and received data frame, in
+ * microseconds of the PAL timer. Used for one-way latency measurements and
+ * as the reference for time synchronized wakeups.
+ */
+volatile uint32_t radio_tx_timestamp;
+volatile uint32_t radio_rx_timestamp;
+#endif
+
 wpan_addr_spec_t dst_addr = {
 	.AddrMode = WPAN_ADDRMODE_SHORT,
 	.PANId = DESTINATION_PAN_ID,
@@ -44,18 +77,54 @@ wpan_addr_spec_t dst_addr = {
 
 enum protocol_channels {
 	PROTOCOL_LIGHT,
+	/* Age in seconds of a reading uploaded from the sample log */
+	PROTOCOL_AGE,
 };
 
 enum app_state {
 	APP_STATE_RADIO_TX,
 	APP_STATE_DISPLAY_RESULT,
+	APP_STATE_REPORT,
+	APP_STATE_UPLOAD,
+#if (APP_SAMPLE_LOG == 1)
+	APP_STATE_LOG_FLUSH,
+#endif
+#ifdef ENABLE_CACHE_PROF
+	APP_STATE_PROF_REPORT,
+#endif
 };
 volatile uint16_t app_state_flags = 0;
 
+#ifdef ENABLE_CACHE_PROF
+/* Interval of the cache profiling report, in seconds */
+#define APP_PROF_REPORT_S 60
+static uint8_t prof_seconds;
+#endif
+
 #define APP_ADC_SAMPLES 1
+#define APP_ADC_MAX_CODE 0xFFF
 uint16_t g_adc_sample_data[APP_ADC_SAMPLES];
 struct adc_dev_inst g_adc_inst;
 
+#if (APP_REPORT_ON_CHANGE == 1)
+/* Reading sent last, in the units of g_adc_sample_data */
+static uint16_t last_report;
+/* Seconds since the last report */
+static volatile uint16_t heartbeat_count;
+#endif
+
+#if (APP_SAMPLE_LOG == 1)
+/* Seconds counted by the AST, continued from the log after a reset */
+static volatile uint32_t app_seconds;
+/* Reading in the last data request, and whether it came from the log */
+static struct sample_log_entry tx_entry;
+static bool tx_from_log;
+/* Logged readings sent in the current slot */
+static uint8_t upload_burst;
+/* Seconds since the staged log entries were last written to flash */
+static uint16_t log_flush_seconds;
+#endif
+
 static void ast_callback(void);
 
 
@@ -125,9 +194,124 @@ static void ast_callback(void)
 {
 	ast_clear_interrupt_flag(AST, AST_INTERRUPT_ALARM);
 	ioport_toggle_pin_level(LED0_GPIO);
+#if (APP_SAMPLE_LOG == 1)
+	app_seconds++;
+	if (++log_flush_seconds >= APP_LOG_FLUSH_S) {
+		log_flush_seconds = 0;
+		set_app_state(APP_STATE_LOG_FLUSH);
+	}
+#endif
+#ifdef ENABLE_CACHE_PROF
+	if (++prof_seconds >= APP_PROF_REPORT_S) {
+		prof_seconds = 0;
+		set_app_state(APP_STATE_PROF_REPORT);
+	}
+#endif
+#if (APP_REPORT_ON_CHANGE == 1)
+	if (heartbeat_count < APP_HEARTBEAT_S) {
+		heartbeat_count++;
+	}
+#endif
+#if APP_ADC_WINDOW
+	if (heartbeat_count >= APP_HEARTBEAT_S) {
+		/* The last conversion is still valid, no new one is needed */
+		g_adc_sample_data[0] = adc_get_last_conv_value(&g_adc_inst);
+		set_app_state(APP_STATE_DISPLAY_RESULT);
+	}
+#elif (APP_ADC_STREAM != 1)
 	adc_start_software_conversion(&g_adc_inst);
+#endif
+}
+
+#if (APP_REPORT_ON_CHANGE == 1)
+/**
+ * \brief Decide whether a new reading has to be sent
+ *
+ * \param value  Reading in the units of g_adc_sample_data
+ * \param band   Change that triggers a report, in the same units
+ */
+static bool report_is_due(uint16_t value, uint16_t band)
+{
+	uint16_t diff = (value > last_report) ?
+			(value - last_report) : (last_report - value);
+
+	return (diff > band) || (heartbeat_count >= APP_HEARTBEAT_S);
+}
+#endif
+
+#if APP_ADC_WINDOW
+/**
+ * \brief Center the window monitor band on a reading
+ *
+ * The window monitor raises its interrupt once a conversion falls outside
+ * of [value - APP_REPORT_BAND, value + APP_REPORT_BAND].
+ */
+static void adc_window_center(uint16_t value)
+{
+	uint16_t low = (value > APP_REPORT_BAND) ? (value - APP_REPORT_BAND) : 0;
+	uint16_t high = value + APP_REPORT_BAND;
+
+	if (high > APP_ADC_MAX_CODE) {
+		high = APP_ADC_MAX_CODE;
+	}
+	adc_configure_wm_threshold(&g_adc_inst, low, high);
+}
+
+static void adc_window_callback(void)
+{
+	if (adc_get_status(&g_adc_inst) & ADCIFE_SR_WM) {
+		g_adc_sample_data[0] = adc_get_last_conv_value(&g_adc_inst);
+		adc_window_center(g_adc_sample_data[0]);
+		adc_clear_status(&g_adc_inst, ADCIFE_SCR_WM);
+		set_app_state(APP_STATE_DISPLAY_RESULT);
+	}
 }
+#endif
 
+#if (APP_ADC_STREAM == 1)
+static void adc_block_callback(void)
+{
+	set_app_state(APP_STATE_DISPLAY_RESULT);
+}
+
+/* Time and charge spent filtering, for the energy per reading */
+static struct dvfs_task_stats filter_stats;
+
+/* Number of filtered blocks averaged in each report of filter_stats */
+#define APP_FILTER_STATS_RUNS 64
+
+/**
+ * \brief Reduce the last captured block to a single filtered reading
+ *
+ * The reading has SENSOR_FILTER_FRAC_BITS bits of resolution below the
+ * ADC LSB. The filter runs at the high DVFS level.
+ *
+ * \return false if no new block was available
+ */
+static bool adc_process_block(void)
+{
+	uint16_t *block = adc_stream_get_block();
+
+	if (block == NULL) {
+		return false;
+	}
+	dvfs_request();
+	dvfs_task_begin();
+	g_adc_sample_data[0] = sensor_filter_process(block);
+	dvfs_task_end(&filter_stats);
+	dvfs_release();
+
+	/* Report the time and estimated charge per reading in the trace */
+	if (filter_stats.runs >= APP_FILTER_STATS_RUNS) {
+		PAL_TRACE3(PAL_TRACE_APP_TASK, filter_stats.runs,
+				filter_stats.time_us / filter_stats.runs,
+				filter_stats.charge_nc / filter_stats.runs);
+		memset(&filter_stats, 0, sizeof(filter_stats));
+	}
+
+	return true;
+}
+#elif !APP_ADC_WINDOW
 static void adcife_read_conv_result(void)
 {
 	// Check the ADC conversion status
@@ -137,6 +321,16 @@ static void adcife_read_conv_result(void)
 		set_app_state(APP_STATE_DISPLAY_RESULT);
 	}
 }
+#endif
+
+static void alert(void)
+{
+	cpu_irq_disable();
+	ioport_set_pin_level(LED0_GPIO, LED0_ACTIVE_LEVEL);
+	while (true) {
+		/* Do nothing */
+	}
+}
 
 static void adc_setup(void)
 {
@@ -174,32 +368,148 @@ static void adc_setup(void)
 		.seq_cfg = &adc_seq_cfg,
 		/* Internal Timer Max Counter */
 		.internal_timer_max_count = 60,
+#if APP_ADC_WINDOW
+		/* Wake up when a conversion leaves the band, the first one always does */
+		.window_mode = ADC_WM_MODE_4,
+#else
 		/* Window monitor mode is off */
 		.window_mode = 0,
+#endif
 		.low_threshold = 0,
 		.high_threshold = 0,
 	};
 	adc_init(&g_adc_inst, ADCIFE, &adc_cfg);
 	adc_enable(&g_adc_inst);
 	adc_ch_set_config(&g_adc_inst, &adc_ch_cfg);
+#if (APP_ADC_STREAM == 1)
+	sensor_filter_init();
+	if (!adc_stream_start(&g_adc_inst, adc_block_callback)) {
+		alert();
+	}
+#elif APP_ADC_WINDOW
+	/* Conversions are triggered by the ADC internal timer */
+	adc_configure_trigger(&g_adc_inst, ADC_TRIG_INTL_TIMER);
+	adc_configure_itimer_period(&g_adc_inst,
+			((sysclk_get_pba_hz() >> (adc_cfg.prescal + 2)) /
+			APP_ADC_WINDOW_SAMPLE_HZ) - 1);
+	adc_set_callback(&g_adc_inst, ADC_WINDOW_MONITOR, adc_window_callback,
+	ADCIFE_IRQn, 1);
+	/* The ADC and its internal timer run on the APB clock, off in SLEEP_2 */
+	sleepmgr_lock_mode(SLEEPMGR_SLEEP_1);
+	adc_start_itimer(&g_adc_inst);
+#else
 	adc_set_callback(&g_adc_inst, ADC_SEQ_SEOC, adcife_read_conv_result,
 	ADCIFE_IRQn, 1);
+#endif
 }
 
-static void alert(void)
+#if (APP_SAMPLE_LOG == 1)
+/**
+ * \brief Send the oldest reading of the sample log
+ *
+ * The reading is removed from the log when its confirm reports success.
+ */
+static void app_send_logged(void)
 {
-	cpu_irq_disable();
-	ioport_set_pin_level(LED0_GPIO, LED0_ACTIVE_LEVEL);
-	while (true) {
-		/* Do nothing */
+	struct sample_log_entry entry;
+	uint16_t age;
+
+	if (!sample_log_peek(&entry)) {
+		clear_app_state(APP_STATE_UPLOAD);
+		return;
+	}
+	age = min(app_seconds - entry.time, UINT16_MAX);
+
+	protocol_set_channel_data(entry.channel, &entry.value);
+	protocol_set_channel_data(PROTOCOL_AGE, &age);
+	tx_entry = entry;
+	tx_from_log = true;
+	upload_burst++;
+	protocol_send_packet();
+}
+
+/**
+ * \brief Result of the last data request, called from usr_mcps_data_conf()
+ *
+ * A live reading that was not acknowledged goes to the sample log. Every
+ * acknowledged frame continues the upload of the log, up to APP_LOG_BURST
+ * logged readings in a row.
+ *
+ * \param success  true if the frame was acknowledged
+ */
+void app_tx_confirm(bool success)
+{
+	if (!success) {
+		if (!tx_from_log) {
+			sample_log_append(&tx_entry);
+		}
+		clear_app_state(APP_STATE_UPLOAD);
+		return;
+	}
+
+	if (tx_from_log) {
+		sample_log_drop();
+	} else {
+		upload_burst = 0;
+	}
+
+	if (sample_log_get_pending() == 0) {
+		clear_app_state(APP_STATE_UPLOAD);
+		return;
 	}
+	set_app_state(APP_STATE_UPLOAD);
+#if (APP_SLOT_SCHEDULE == 1)
+	/* The rest of the log waits for the next slot */
+	if (!slot_schedule_tx_fits()) {
+		return;
+	}
+#endif
+	if (upload_burst < APP_LOG_BURST) {
+		set_app_state(APP_STATE_RADIO_TX);
+	}
+}
+#endif
+
+#if (APP_SLOT_SCHEDULE == 1) && (APP_COORDINATOR != 1)
+static void slot_callback(void)
+{
+#if (APP_SAMPLE_LOG == 1)
+	if (is_app_state_set(APP_STATE_UPLOAD)) {
+		upload_burst = 0;
+		set_app_state(APP_STATE_RADIO_TX);
+		return;
+	}
+#endif
+#if (APP_REPORT_ON_CHANGE == 1)
+	/* Keep the slot unused unless there is something to report */
+	if (!is_app_state_set(APP_STATE_REPORT)) {
+		return;
+	}
+#endif
+	set_app_state(APP_STATE_RADIO_TX);
 }
+#endif
 
 static void send_data(uint8_t *data, uint8_t size)
 {
 	static uint8_t msduHandle = 0;
-	wpan_mcps_data_req (WPAN_ADDRMODE_SHORT, &dst_addr, size, 
-	                    data, msduHandle++, WPAN_TXOPT_ACK);
+#if (APP_SLOT_SCHEDULE == 1)
+	if (msduHandle == SLOT_SYNC_MSDU_HANDLE) {
+		msduHandle = 0;
+	}
+#endif
+	if (wpan_mcps_data_req (WPAN_ADDRMODE_SHORT, &dst_addr, size, 
+	                    data, msduHandle++, WPAN_TXOPT_ACK)) {
+		/* Keep the SPI and transceiver IRQ clocked until the confirm */
+		sleepmgr_lock_mode(SLEEPMGR_SLEEP_1);
+		/*
+		 * Build and upload the frame at the high clock, then wait for
+		 * the confirm at the low one.
+		 */
+		dvfs_request();
+		wpan_task();
+		dvfs_release();
+	}
 }
 
 int main (void)
@@ -207,6 +517,13 @@ int main (void)
 	irq_initialize_vectors();
 	board_init();				// Initialize all board settings (I/O, etc.)
 	sysclk_init();				// Initialize clock system
+	sleepmgr_init();			// Before any driver takes a sleep lock
+#ifdef ENABLE_CACHE_PROF
+	pal_cache_prof_init();
+#endif
+#ifdef ENABLE_TRACE
+	pal_trace_init();
+#endif
 	ast_setup();				// Initialize AST module
 	ast_callback_setup();
 	
@@ -238,26 +555,119 @@ int main (void)
 	}
 
 	uint8_t string_buf[8];
+#if (APP_SAMPLE_LOG == 1)
+	uint32_t log_time;
+#endif
 	snprintf(string_buf, 8, "No 0x%2X", PROTOCOL_ADDRESS);
 	c42364a_write_alphanum_packet(string_buf);	
 	
 	protocol_tx_init(send_data, PROTOCOL_ADDRESS);
-	
+
+#if (APP_COORDINATOR == 1)
+	/* Only send the slot frame sync and hand out the slots */
+	sleep_loop_init();
+	if (!slot_schedule_coord_init(SOURCE_PAN_ID)) {
+		alert();
+	}
+	while (1) {
+		wpan_task();
+		sleep_loop_sleep();
+	}
+#elif (APP_SLOT_SCHEDULE == 1)
+	if (!slot_schedule_init(PROTOCOL_ADDRESS, slot_callback)) {
+		alert();
+	}
+#endif
+
+	/*
+	 * The sleep loop keeps the TC of the PAL timer clocked while a timer
+	 * is running, a pending transmission holds its own lock.
+	 */
+	sleep_loop_init();
+	dvfs_init();
+
+#if (APP_SAMPLE_LOG == 1)
+	sample_log_init();
+	if (sample_log_get_last_time(&log_time)) {
+		app_seconds = log_time + 1;
+	}
+#endif
+
 	while(1)
 	{
 		wpan_task();
 		
 		if (is_app_state_set(APP_STATE_DISPLAY_RESULT)) {
 			clear_app_state(APP_STATE_DISPLAY_RESULT);
-			c42364a_show_numeric_dec(g_adc_sample_data[0]);
+#if (APP_ADC_STREAM == 1)
+			if (!adc_process_block()) {
+				continue;
+			}
+#endif
+			c42364a_show_numeric_dec(g_adc_sample_data[0] >> APP_READING_FRAC_BITS);
 			
 			protocol_set_channel_data(PROTOCOL_LIGHT, &g_adc_sample_data[0]);
+#if (APP_REPORT_ON_CHANGE == 1)
+			if (report_is_due(g_adc_sample_data[0],
+					APP_REPORT_BAND << APP_READING_FRAC_BITS)) {
+				set_app_state(APP_STATE_REPORT);
+			}
+#else
+			set_app_state(APP_STATE_REPORT);
+#endif
+		}
+
+		if (is_app_state_set(APP_STATE_REPORT)) {
+#if (APP_SLOT_SCHEDULE == 1)
+			/* When synchronized the data is sent in our slot */
+			if (!slot_schedule_is_synced()) {
+				set_app_state(APP_STATE_RADIO_TX);
+			}
+#else
 			set_app_state(APP_STATE_RADIO_TX);
+#endif
 		}
 		
 		if (is_app_state_set(APP_STATE_RADIO_TX)) {
 			clear_app_state(APP_STATE_RADIO_TX);
+#if (APP_SAMPLE_LOG == 1)
+			/* Live readings go first, the log fills the remaining sends */
+			if (!is_app_state_set(APP_STATE_REPORT)) {
+				app_send_logged();
+				continue;
+			}
+			tx_entry.time = app_seconds;
+			tx_entry.value = g_adc_sample_data[0];
+			tx_entry.channel = PROTOCOL_LIGHT;
+			tx_from_log = false;
+#endif
+			clear_app_state(APP_STATE_REPORT);
+#if (APP_REPORT_ON_CHANGE == 1)
+			last_report = g_adc_sample_data[0];
+			heartbeat_count = 0;
+#endif
+#if APP_ADC_WINDOW
+			adc_window_center(last_report);
+#endif
 			protocol_send_packet();
 		}
+
+#if (APP_SAMPLE_LOG == 1)
+		if (is_app_state_set(APP_STATE_LOG_FLUSH)) {
+			clear_app_state(APP_STATE_LOG_FLUSH);
+			/* Keep the staged readings across a reset */
+			sample_log_flush();
+		}
+#endif
+
+#ifdef ENABLE_CACHE_PROF
+		if (is_app_state_set(APP_STATE_PROF_REPORT)) {
+			clear_app_state(APP_STATE_PROF_REPORT);
+			pal_cache_prof_report();
+		}
+#endif
+
+		/* Wake up on the next transceiver, timer or AST interrupt */
+		sleep_loop_sleep();
 	}
 }
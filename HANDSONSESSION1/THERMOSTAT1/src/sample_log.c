@@ -0,0 +1,432 @@
+/**
+ * \file
+ *
+ * \brief Flash ring log of sensor readings
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#include <asf.h>
+#include <string.h>
+#include "pal.h"
+#include "sample_log.h"
+
+#define SAMPLE_LOG_MAGIC                (0x534C4F47UL)
+
+/** Value of \ref sample_log_header.uploaded until the page is uploaded */
+#define SAMPLE_LOG_NOT_UPLOADED         (0xFFFFFFFFUL)
+
+/** Header at the start of each log page */
+struct sample_log_header {
+	uint32_t magic;
+	/** Incremented for every page written */
+	uint32_t seq;
+	/** Number of times this page has been erased */
+	uint32_t erase_count;
+	/** Number of entries in the page */
+	uint16_t count;
+	/** Inverted \ref count */
+	uint16_t count_check;
+	/** Programmed to zero once the page has been uploaded */
+	uint32_t uploaded;
+	uint32_t reserved;
+};
+
+#define SAMPLE_LOG_ENTRIES_PER_PAGE     \
+	((FLASH_PAGE_SIZE - sizeof(struct sample_log_header)) / \
+	sizeof(struct sample_log_entry))
+
+/** Layout of a log page, in flash and in the staging buffer */
+struct sample_log_page {
+	struct sample_log_header header;
+	struct sample_log_entry entry[SAMPLE_LOG_ENTRIES_PER_PAGE];
+};
+
+/** Page images written to flash must fill exactly one page */
+typedef char sample_log_page_size_check[
+		(sizeof(struct sample_log_page) <= FLASH_PAGE_SIZE) ? 1 : -1];
+
+/** Page written next */
+static uint8_t head;
+/** Oldest page not yet uploaded, valid if \ref pending_pages is not zero */
+static uint8_t tail;
+/** Next entry to be read from the \ref tail page */
+static uint16_t tail_idx;
+/** Number of written pages not yet uploaded */
+static uint8_t pending_pages;
+/** Sequence number of the next page written */
+static uint32_t next_seq;
+/** Number of entries lost to a full ring */
+static uint32_t dropped;
+
+/* Flash kept out of the program image, from the linker script */
+extern uint32_t _snvm;
+
+/** Entries waiting for a page write */
+static struct sample_log_page stage;
+/** Next entry to be read from \ref stage */
+static uint16_t stage_idx;
+
+/** True while the entry returned by sample_log_peek() may be dropped */
+static bool peek_valid;
+/** Sequence number of the page of that entry, 0 while it is staged */
+static uint32_t peek_seq;
+/** Index of that entry in its page */
+static uint16_t peek_idx;
+
+/**
+ * \brief Flash page number of a log page
+ *
+ * The log lies directly below the PAL persistent counter pages.
+ */
+static uint32_t sample_log_page_number(uint8_t page)
+{
+	return flashcalw_get_page_count() - (STACK_FLASH_SIZE / FLASH_PAGE_SIZE) -
+			PS_COUNTER_PAGES - SAMPLE_LOG_PAGES + page;
+}
+
+static const struct sample_log_page *sample_log_page(uint8_t page)
+{
+	return (const struct sample_log_page *)(FLASH_ADDR +
+			sample_log_page_number(page) * FLASH_PAGE_SIZE);
+}
+
+/**
+ * \brief Program flash and drop the stale lines from the PicoCache
+ *
+ * The cache does not see flash writes, reads of the log must not return
+ * the content from before the write.
+ */
+static void sample_log_program(volatile void *dst, const void *src,
+		size_t nbytes, bool erase)
+{
+	flashcalw_memcpy(dst, src, nbytes, erase);
+	flashcalw_picocache_invalid_all();
+}
+
+static bool sample_log_page_valid(const struct sample_log_page *page)
+{
+	return (page->header.magic == SAMPLE_LOG_MAGIC) &&
+			((page->header.count ^ page->header.count_check) == 0xFFFF) &&
+			(page->header.count <= SAMPLE_LOG_ENTRIES_PER_PAGE);
+}
+
+static bool sample_log_page_pending(const struct sample_log_page *page)
+{
+	return sample_log_page_valid(page) &&
+			(page->header.uploaded == SAMPLE_LOG_NOT_UPLOADED);
+}
+
+/**
+ * \brief Resume the log from the page headers in flash
+ *
+ * Finds the newest page and the oldest page not yet uploaded. Pages are
+ * written in ring order, so the pending pages follow each other and end
+ * with the newest page.
+ */
+void sample_log_init(void)
+{
+	const struct sample_log_page *page;
+	bool found = false;
+	uint32_t newest_seq = 0;
+	uint8_t newest = 0;
+	uint8_t i;
+
+	/* The linker script must reserve the whole ring */
+	Assert((uint32_t)&_snvm <= FLASH_ADDR +
+			sample_log_page_number(0) * FLASH_PAGE_SIZE);
+
+	for (i = 0; i < SAMPLE_LOG_PAGES; i++) {
+		page = sample_log_page(i);
+		if (sample_log_page_valid(page) && (!found ||
+				((int32_t)(page->header.seq - newest_seq) > 0))) {
+			newest_seq = page->header.seq;
+			newest = i;
+			found = true;
+		}
+	}
+
+	head = found ? (newest + 1) % SAMPLE_LOG_PAGES : 0;
+	next_seq = found ? newest_seq + 1 : 1;
+	pending_pages = 0;
+	tail_idx = 0;
+
+	/* Walk from the oldest page towards the newest one */
+	for (i = 0; i < SAMPLE_LOG_PAGES; i++) {
+		uint8_t idx = (head + i) % SAMPLE_LOG_PAGES;
+
+		if (sample_log_page_pending(sample_log_page(idx))) {
+			if (pending_pages++ == 0) {
+				tail = idx;
+			}
+		}
+	}
+
+	memset(&stage, 0, sizeof(stage));
+	stage_idx = 0;
+	dropped = 0;
+	peek_valid = false;
+}
+
+/**
+ * \brief Write the staged entries to the page at \ref head
+ *
+ * The oldest pending page is given up if the ring is full. A page that
+ * does not verify is invalidated and the next one is tried.
+ */
+static bool sample_log_write_stage(void)
+{
+	const struct sample_log_page *page;
+	uint32_t zero = 0;
+	uint8_t tries;
+
+	/* Entries already read from the stage are not written */
+	if (stage_idx > 0) {
+		stage.header.count -= stage_idx;
+		memmove(stage.entry, &stage.entry[stage_idx],
+				stage.header.count * sizeof(stage.entry[0]));
+		stage_idx = 0;
+	}
+
+	for (tries = 0; tries < SAMPLE_LOG_PAGES; tries++) {
+		page = sample_log_page(head);
+
+		if ((pending_pages > 0) && (head == tail)) {
+			/* An entry of this page being sent can no longer be dropped */
+			if (peek_valid && (peek_seq == page->header.seq)) {
+				peek_valid = false;
+			}
+			dropped += page->header.count - tail_idx;
+			tail = (tail + 1) % SAMPLE_LOG_PAGES;
+			tail_idx = 0;
+			pending_pages--;
+		}
+
+		stage.header.magic = SAMPLE_LOG_MAGIC;
+		stage.header.seq = next_seq;
+		stage.header.erase_count = sample_log_page_valid(page) ?
+				page->header.erase_count + 1 : 1;
+		stage.header.count_check = ~stage.header.count;
+		stage.header.uploaded = SAMPLE_LOG_NOT_UPLOADED;
+		stage.header.reserved = 0xFFFFFFFFUL;
+
+		sample_log_program((volatile void *)page, &stage, sizeof(stage), true);
+
+		if (!flashcalw_is_lock_error() && !flashcalw_is_programming_error() &&
+				(memcmp((const void *)page, &stage, sizeof(stage)) == 0)) {
+			if (pending_pages++ == 0) {
+				tail = head;
+				tail_idx = 0;
+			}
+			/* A staged entry being sent is now the first of this page */
+			if (peek_valid && (peek_seq == 0)) {
+				peek_seq = next_seq;
+				peek_idx = 0;
+			}
+			head = (head + 1) % SAMPLE_LOG_PAGES;
+			next_seq++;
+			stage.header.count = 0;
+			return true;
+		}
+
+		/* Make sure the resume scan does not pick up the broken page */
+		sample_log_program((volatile void *)&page->header.magic, &zero,
+				sizeof(zero), false);
+		head = (head + 1) % SAMPLE_LOG_PAGES;
+		next_seq++;
+	}
+	return false;
+}
+
+/**
+ * \brief Append an entry to the log
+ *
+ * The entry is staged in RAM and written with the next full page.
+ *
+ * \return false if the page could not be written to flash
+ */
+bool sample_log_append(const struct sample_log_entry *entry)
+{
+	stage.entry[stage.header.count++] = *entry;
+
+	if (stage.header.count < SAMPLE_LOG_ENTRIES_PER_PAGE) {
+		return true;
+	}
+	if (!sample_log_write_stage()) {
+		/* No usable page left, make room for new entries */
+		if (peek_valid && (peek_seq == 0)) {
+			peek_valid = false;
+		}
+		dropped += stage.header.count;
+		stage.header.count = 0;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * \brief Write the staged entries as a partial page
+ *
+ * Uses up a whole flash page, call it only when the staged entries must
+ * survive a reset, e.g. before entering backup mode.
+ */
+bool sample_log_flush(void)
+{
+	if (stage.header.count == stage_idx) {
+		return true;
+	}
+	return sample_log_write_stage();
+}
+
+/**
+ * \brief Read the oldest entry not yet dropped
+ *
+ * \param entry  Returns the entry
+ *
+ * \return false if the log is empty
+ */
+bool sample_log_peek(struct sample_log_entry *entry)
+{
+	const struct sample_log_page *page;
+
+	if (pending_pages > 0) {
+		page = sample_log_page(tail);
+		*entry = page->entry[tail_idx];
+		peek_seq = page->header.seq;
+		peek_idx = tail_idx;
+		peek_valid = true;
+		return true;
+	}
+	if (stage_idx < stage.header.count) {
+		*entry = stage.entry[stage_idx];
+		peek_seq = 0;
+		peek_valid = true;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * \brief Remove the entry returned by sample_log_peek()
+ *
+ * Marks the page in flash as uploaded when its last entry is removed.
+ * Does nothing if the entry has been overwritten since it was read, so
+ * that the entry now at the tail is not lost.
+ */
+void sample_log_drop(void)
+{
+	const struct sample_log_page *page;
+	uint32_t zero = 0;
+
+	if (!peek_valid) {
+		return;
+	}
+	peek_valid = false;
+
+	if (pending_pages == 0) {
+		if ((peek_seq == 0) && (stage_idx < stage.header.count)) {
+			if (++stage_idx == stage.header.count) {
+				stage.header.count = 0;
+				stage_idx = 0;
+			}
+		}
+		return;
+	}
+
+	page = sample_log_page(tail);
+	if ((page->header.seq != peek_seq) || (tail_idx != peek_idx)) {
+		return;
+	}
+	if (++tail_idx < page->header.count) {
+		return;
+	}
+
+	sample_log_program((volatile void *)&page->header.uploaded, &zero,
+			sizeof(zero), false);
+	tail = (tail + 1) % SAMPLE_LOG_PAGES;
+	tail_idx = 0;
+	pending_pages--;
+}
+
+/**
+ * \brief Return the number of entries not yet dropped
+ */
+uint32_t sample_log_get_pending(void)
+{
+	uint32_t pending = stage.header.count - stage_idx;
+	uint8_t i;
+
+	for (i = 0; i < pending_pages; i++) {
+		pending += sample_log_page((tail + i) % SAMPLE_LOG_PAGES)->header.count;
+	}
+	return pending - ((pending_pages > 0) ? tail_idx : 0);
+}
+
+/**
+ * \brief Return the number of entries overwritten before they were read
+ */
+uint32_t sample_log_get_dropped(void)
+{
+	return dropped;
+}
+
+/**
+ * \brief Get the time of the newest entry
+ *
+ * Lets the application continue its clock after a reset, so that the
+ * entry times keep increasing across restarts.
+ *
+ * \param time  Returns the time of the newest entry
+ *
+ * \return false if the log is empty
+ */
+bool sample_log_get_last_time(uint32_t *time)
+{
+	const struct sample_log_page *page;
+
+	if (stage.header.count > 0) {
+		*time = stage.entry[stage.header.count - 1].time;
+		return true;
+	}
+
+	page = sample_log_page((head + SAMPLE_LOG_PAGES - 1) % SAMPLE_LOG_PAGES);
+	if (!sample_log_page_valid(page) || (page->header.count == 0)) {
+		return false;
+	}
+	*time = page->entry[page->header.count - 1].time;
+	return true;
+}
@@ -0,0 +1,101 @@
+/**
+ * \file
+ *
+ * \brief Flash ring log of sensor readings
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#ifndef SAMPLE_LOG_H_INCLUDED
+#define SAMPLE_LOG_H_INCLUDED
+
+#include <compiler.h>
+
+/**
+ * \defgroup sample_log_group Flash sample log
+ *
+ * Readings that could not be sent are appended to a RAM staging page.
+ * Full pages are written to a ring of \ref SAMPLE_LOG_PAGES flash pages
+ * below the PAL persistent storage, one erase and one page write per page
+ * of entries. Pages are used strictly in ring order, so every page is
+ * erased once per lap and the wear is spread evenly; each page header
+ * keeps its erase count. A page that fails to verify is skipped.
+ *
+ * When the ring is full the oldest page is overwritten and its entries
+ * are counted as dropped. An entry read with sample_log_peek() that is
+ * overwritten before sample_log_drop() is not dropped a second time.
+ *
+ * At boot only the page headers are scanned to find the newest page and
+ * the oldest page not yet uploaded. Entries are read back oldest first
+ * with sample_log_peek() and sample_log_drop(); a page is marked uploaded
+ * in flash once its last entry is dropped. Entries dropped from a page
+ * that is not finished when the device resets are read again after the
+ * restart.
+ *
+ * Staged entries not yet written to flash are lost on reset, unless
+ * sample_log_flush() writes them as a partial page.
+ *
+ * @{
+ */
+
+/** Number of flash pages in the ring, reserved by the nvm region of flash.ld */
+#ifndef SAMPLE_LOG_PAGES
+#define SAMPLE_LOG_PAGES                (64)
+#endif
+
+/** One logged reading */
+struct sample_log_entry {
+	/** Time of the reading, in seconds */
+	uint32_t time;
+	/** Reading */
+	uint16_t value;
+	/** Channel the reading belongs to */
+	uint16_t channel;
+};
+
+void sample_log_init(void);
+bool sample_log_append(const struct sample_log_entry *entry);
+bool sample_log_flush(void);
+bool sample_log_peek(struct sample_log_entry *entry);
+void sample_log_drop(void);
+uint32_t sample_log_get_pending(void);
+uint32_t sample_log_get_dropped(void);
+bool sample_log_get_last_time(uint32_t *time);
+
+/** @} */
+
+#endif /* SAMPLE_LOG_H_INCLUDED */
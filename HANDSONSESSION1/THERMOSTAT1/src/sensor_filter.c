@@ -0,0 +1,254 @@
+/**
+ * \file
+ *
+ * \brief Decimation filter for blocks of sensor samples
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef SENSOR_FILTER_HOST
+#include <time.h>
+typedef int16_t q15_t;
+#else
+#include <asf.h>
+#include <arm_math.h>
+#endif
+#include "sensor_filter.h"
+
+/** ADC codes are scaled to Q15 by this shift, 12 + 3 = 15 bits */
+#define SENSOR_FILTER_Q15_SHIFT         (3)
+
+#define SENSOR_FILTER_OUT_SIZE \
+	(SENSOR_FILTER_BLOCK_SIZE / SENSOR_FILTER_DECIMATION)
+
+/**
+ * Hamming windowed sinc low-pass with its cutoff at the output Nyquist
+ * frequency, DC gain 1.0 (coefficients sum to 32768).
+ */
+static const q15_t filter_coeffs[SENSOR_FILTER_TAPS] = {
+	6, 23, 51, 104, 189, 313, 482, 692,
+	940, 1213, 1497, 1774, 2026, 2234, 2382, 2458,
+	2458, 2382, 2234, 2026, 1774, 1497, 1213, 940,
+	692, 482, 313, 189, 104, 51, 23, 6
+};
+
+/** Delay line of the FIR stage */
+static q15_t filter_state[SENSOR_FILTER_TAPS + SENSOR_FILTER_BLOCK_SIZE - 1];
+static q15_t filter_in[SENSOR_FILTER_BLOCK_SIZE];
+static q15_t filter_out[SENSOR_FILTER_OUT_SIZE];
+
+/** Last two input samples of the previous block, for the median */
+static uint16_t median_hist[2];
+/** The state is primed from the first block */
+static bool filter_primed;
+static uint32_t filter_cycles;
+
+#ifdef SENSOR_FILTER_HOST
+/**
+ * \brief Portable equivalent of arm_fir_decimate_q15()
+ *
+ * Same Q15 arithmetic: 64-bit accumulation, result shifted by 15 and
+ * saturated. Only every SENSOR_FILTER_DECIMATION'th output is computed.
+ */
+static void filter_decimate(q15_t *src, q15_t *dst)
+{
+	memcpy(&filter_state[SENSOR_FILTER_TAPS - 1], src, sizeof(filter_in));
+
+	for (uint16_t i = 0; i < SENSOR_FILTER_OUT_SIZE; i++) {
+		/* Window of the i'th output, oldest sample first */
+		const q15_t *x = &filter_state[i * SENSOR_FILTER_DECIMATION];
+		int64_t acc = 0;
+
+		for (uint16_t k = 0; k < SENSOR_FILTER_TAPS; k++) {
+			acc += (int32_t)filter_coeffs[k] * x[k];
+		}
+		acc >>= 15;
+		if (acc > INT16_MAX) {
+			acc = INT16_MAX;
+		} else if (acc < INT16_MIN) {
+			acc = INT16_MIN;
+		}
+		dst[i] = (q15_t)acc;
+	}
+
+	memmove(filter_state, &filter_state[SENSOR_FILTER_BLOCK_SIZE],
+			(SENSOR_FILTER_TAPS - 1) * sizeof(q15_t));
+}
+
+static void filter_cycles_start(void)
+{
+	filter_cycles = (uint32_t)clock();
+}
+
+static void filter_cycles_stop(void)
+{
+	filter_cycles = (uint32_t)clock() - filter_cycles;
+}
+#else
+static arm_fir_decimate_instance_q15 filter_inst;
+
+static void filter_decimate(q15_t *src, q15_t *dst)
+{
+	arm_fir_decimate_q15(&filter_inst, src, dst, SENSOR_FILTER_BLOCK_SIZE);
+}
+
+static void filter_cycles_start(void)
+{
+	filter_cycles = DWT->CYCCNT;
+}
+
+static void filter_cycles_stop(void)
+{
+	filter_cycles = DWT->CYCCNT - filter_cycles;
+}
+#endif
+
+static inline uint16_t median3(uint16_t a, uint16_t b, uint16_t c)
+{
+	if (a > b) {
+		uint16_t t = a;
+		a = b;
+		b = t;
+	}
+	/* a <= b */
+	if (c <= a) {
+		return a;
+	}
+	return (c < b) ? c : b;
+}
+
+/**
+ * \brief Reset the filter state and, on the target, enable the DWT cycle
+ *        counter used to measure the filter
+ */
+void sensor_filter_init(void)
+{
+	memset(filter_state, 0, sizeof(filter_state));
+	median_hist[0] = 0;
+	median_hist[1] = 0;
+	filter_primed = false;
+	filter_cycles = 0;
+
+#ifndef SENSOR_FILTER_HOST
+	arm_fir_decimate_init_q15(&filter_inst, SENSOR_FILTER_TAPS,
+			SENSOR_FILTER_DECIMATION, (q15_t *)filter_coeffs, filter_state,
+			SENSOR_FILTER_BLOCK_SIZE);
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/**
+ * \brief Fill the median history and the FIR delay line with the level of
+ *        the first block, as if it had been measured forever
+ *
+ * Without this, the first readings ramp up from zero.
+ */
+static void filter_prime(const uint16_t *block)
+{
+	uint16_t level = median3(block[0], block[1], block[2]);
+
+	median_hist[0] = level;
+	median_hist[1] = level;
+	for (uint16_t i = 0; i < SENSOR_FILTER_TAPS - 1; i++) {
+		filter_state[i] = (q15_t)(level << SENSOR_FILTER_Q15_SHIFT);
+	}
+	filter_primed = true;
+}
+
+/**
+ * \brief Filter one block of ADC samples
+ *
+ * The median is centered one sample back, so the output lags the input by
+ * one sample plus the FIR group delay.
+ *
+ * \param[in]  block  \ref SENSOR_FILTER_BLOCK_SIZE 12-bit ADC codes
+ *
+ * \return Reading in units of 2^-SENSOR_FILTER_FRAC_BITS ADC codes
+ */
+uint16_t sensor_filter_process(const uint16_t *block)
+{
+	uint32_t sum = 0;
+	uint16_t prev;
+	uint16_t curr;
+
+	filter_cycles_start();
+
+	if (!filter_primed) {
+		filter_prime(block);
+	}
+	prev = median_hist[0];
+	curr = median_hist[1];
+
+	for (uint16_t i = 0; i < SENSOR_FILTER_BLOCK_SIZE; i++) {
+		filter_in[i] = (q15_t)(median3(prev, curr, block[i])
+				<< SENSOR_FILTER_Q15_SHIFT);
+		prev = curr;
+		curr = block[i];
+	}
+	median_hist[0] = prev;
+	median_hist[1] = curr;
+
+	filter_decimate(filter_in, filter_out);
+
+	for (uint16_t i = 0; i < SENSOR_FILTER_OUT_SIZE; i++) {
+		if (filter_out[i] > 0) {
+			sum += filter_out[i];
+		}
+	}
+
+	filter_cycles_stop();
+
+	/* Average of the outputs, rescaled from Q15 to FRAC_BITS */
+	return (uint16_t)((sum << SENSOR_FILTER_FRAC_BITS) /
+			(SENSOR_FILTER_OUT_SIZE << SENSOR_FILTER_Q15_SHIFT));
+}
+
+/**
+ * \brief Time spent in the last call to sensor_filter_process()
+ *
+ * \return CPU cycles on the target, clock() ticks in a host build
+ */
+uint32_t sensor_filter_get_cycles(void)
+{
+	return filter_cycles;
+}
@@ -0,0 +1,95 @@
+/**
+ * \file
+ *
+ * \brief Decimation filter for blocks of sensor samples
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#ifndef SENSOR_FILTER_H_INCLUDED
+#define SENSOR_FILTER_H_INCLUDED
+
+#include <stdint.h>
+
+/**
+ * \defgroup sensor_filter_group Sensor decimation filter
+ *
+ * Reduces a block of 12-bit ADC codes to one reading:
+ * -# a 3-point median removes single-sample spikes,
+ * -# a low-pass FIR decimates the block by \ref SENSOR_FILTER_DECIMATION
+ *    (arm_fir_decimate_q15() from CMSIS-DSP),
+ * -# the decimated samples are averaged.
+ *
+ * The reading carries \ref SENSOR_FILTER_FRAC_BITS bits below the ADC LSB.
+ * Filter state is kept between blocks, so consecutive blocks must be
+ * contiguous in time. The first block after sensor_filter_init() primes
+ * the state with its level.
+ *
+ * Built with SENSOR_FILTER_HOST defined, the module does not depend on ASF
+ * or CMSIS and uses an equivalent C implementation of the decimator, e.g.
+ * to run recorded sample blocks through the filter on a PC. Both builds
+ * measure the time spent per block: CPU cycles from the DWT cycle counter
+ * on the target, clock() ticks on the host.
+ *
+ * @{
+ */
+
+/** Number of ADC samples per block */
+#ifndef SENSOR_FILTER_BLOCK_SIZE
+#define SENSOR_FILTER_BLOCK_SIZE        (256)
+#endif
+
+/** Decimation factor of the FIR stage */
+#define SENSOR_FILTER_DECIMATION        (16)
+
+/** Number of FIR coefficients */
+#define SENSOR_FILTER_TAPS              (32)
+
+/** Fractional bits of the reading, i.e. reading = ADC code * 2^FRAC_BITS */
+#define SENSOR_FILTER_FRAC_BITS         (4)
+
+#if (SENSOR_FILTER_BLOCK_SIZE % SENSOR_FILTER_DECIMATION) != 0
+#error "SENSOR_FILTER_BLOCK_SIZE must be a multiple of SENSOR_FILTER_DECIMATION"
+#endif
+
+void sensor_filter_init(void);
+uint16_t sensor_filter_process(const uint16_t *block);
+uint32_t sensor_filter_get_cycles(void);
+
+/** @} */
+
+#endif /* SENSOR_FILTER_H_INCLUDED */
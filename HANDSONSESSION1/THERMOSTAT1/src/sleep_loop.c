@@ -0,0 +1,252 @@
+/**
+ * \file
+ *
+ * \brief Tickless sleep for the application main loop
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#include <asf.h>
+#include <string.h>
+#include "common_sw_timer.h"
+#include "sleep_loop.h"
+
+/** Time spent in each mode, SLEEPMGR_ACTIVE counts the time awake */
+static struct sleep_loop_residency mode_residency[SLEEPMGR_NR_OF_MODES];
+/** AST counter value at the last wakeup */
+static uint32_t last_wakeup;
+
+/** Shortest time to the next deadline for each mode to pay off, in us */
+static const uint32_t sleep_loop_min_us[SLEEPMGR_NR_OF_MODES] = {
+	[SLEEPMGR_SLEEP_3] = SLEEP_LOOP_MIN_US_SLEEP_3,
+	[SLEEPMGR_WAIT]    = SLEEP_LOOP_MIN_US_WAIT,
+	[SLEEPMGR_RET]     = SLEEP_LOOP_MIN_US_RET,
+};
+
+uint32_t sleep_loop_get_tick_hz(void)
+{
+	uint32_t psel = (AST->AST_CR & AST_CR_PSEL_Msk) >> AST_CR_PSEL_Pos;
+
+	return SLEEP_LOOP_AST_SRC_HZ >> (psel + 1);
+}
+
+/**
+ * \brief AST ticks between two counter values
+ *
+ * When the counter is cleared on alarm it wraps at the alarm value. The
+ * alarm also wakes the device, so no interval spans more than one wrap.
+ */
+static uint32_t sleep_loop_elapsed(uint32_t from, uint32_t to)
+{
+	if ((to < from) && (AST->AST_CR & AST_CR_CA0)) {
+		return (AST->AST_AR0 + 1 - from) + to;
+	}
+	return to - from;
+}
+
+/**
+ * \brief Time until the AST alarm fires
+ *
+ * \return Time in us, or UINT32_MAX if the alarm interrupt is disabled
+ */
+static uint32_t sleep_loop_ast_deadline(void)
+{
+	uint32_t hz = sleep_loop_get_tick_hz();
+	uint32_t ticks;
+
+	if (!(ast_read_interrupt_mask(AST) & AST_IMR_ALARM0) || (hz == 0)) {
+		return UINT32_MAX;
+	}
+
+	ticks = AST->AST_AR0 - ast_read_counter_value(AST);
+	return (uint32_t)min((uint64_t)ticks * 1000000UL / hz,
+			(uint64_t)UINT32_MAX);
+}
+
+/** Clear the periodic event that ended a deep sleep */
+static void sleep_loop_per_callback(void)
+{
+	ast_clear_interrupt_flag(AST, AST_INTERRUPT_PER);
+}
+
+/**
+ * \brief Wake up from a deep mode before a software timer expires
+ *
+ * The AST alarm belongs to the application, so the periodic event is used.
+ * It is the longest period that fits in \a budget; as the phase of the
+ * prescaler is unknown the first event comes at most one period later.
+ *
+ * \param budget Time until the device has to be awake, in us
+ */
+static void sleep_loop_arm_wakeup(uint32_t budget)
+{
+	uint32_t pir = 0;
+
+	while ((pir < AST_PSEL_32KHZ_1HZ) && ((2ULL << (pir + 1)) * 1000000UL
+			/ SLEEP_LOOP_AST_SRC_HZ <= budget)) {
+		pir++;
+	}
+
+	ast_write_periodic0_value(AST, pir);
+	ast_clear_interrupt_flag(AST, AST_INTERRUPT_PER);
+	ast_set_callback(AST, AST_INTERRUPT_PER, sleep_loop_per_callback,
+			AST_PER_IRQn, 0);
+	ast_enable_wakeup(AST, AST_WAKEUP_PER);
+}
+
+/** Stop the periodic wakeup armed by sleep_loop_arm_wakeup() */
+static void sleep_loop_disarm_wakeup(void)
+{
+	ast_disable_wakeup(AST, AST_WAKEUP_PER);
+	ast_disable_interrupt(AST, AST_INTERRUPT_PER);
+	ast_clear_interrupt_flag(AST, AST_INTERRUPT_PER);
+}
+
+/**
+ * \brief Initialize the sleep loop
+ *
+ * Must be called after the AST has been configured and after
+ * sleepmgr_init().
+ */
+void sleep_loop_init(void)
+{
+	memset(mode_residency, 0, sizeof(mode_residency));
+
+	/* Let the alarm end the modes where the interrupt controller sleeps */
+	ast_enable_wakeup(AST, AST_WAKEUP_ALARM);
+
+	last_wakeup = ast_read_counter_value(AST);
+}
+
+/**
+ * \brief Sleep until the next interrupt
+ *
+ * Returns right away if a software timer has already expired, so that
+ * its callback is run by the next sw_timer_service().
+ *
+ * \return The mode that was entered, SLEEPMGR_ACTIVE if none
+ */
+enum sleepmgr_mode sleep_loop_sleep(void)
+{
+	enum sleepmgr_mode mode;
+	uint32_t deadline;
+	uint32_t residual;
+	uint32_t sleep_start;
+	uint32_t ticks;
+	bool timer_running;
+	bool timer_stopped;
+
+	cpu_irq_disable();
+
+	mode = sleepmgr_get_sleep_mode();
+	/* Backup mode ends in a reset, it is never entered from here */
+	if (mode > SLEEPMGR_RET) {
+		mode = SLEEPMGR_RET;
+	}
+
+	deadline = sleep_loop_ast_deadline();
+	timer_running = sw_timer_get_residual_time(&residual);
+	if (timer_running) {
+		/*
+		 * The timer counter stops in the deeper modes. They are only
+		 * worth the AST wakeup and the time correction when the next
+		 * timer is far enough away.
+		 */
+		if ((mode > SLEEP_LOOP_TIMER_MODE)
+				&& (residual < SLEEP_LOOP_MIN_US_TIMER_STOP)) {
+			mode = SLEEP_LOOP_TIMER_MODE;
+		}
+		if (residual == 0) {
+			mode = SLEEPMGR_ACTIVE;
+		}
+		deadline = min(deadline, residual);
+	}
+
+	while ((mode > SLEEPMGR_SLEEP_0) && (deadline < sleep_loop_min_us[mode])) {
+		mode--;
+	}
+
+	if (mode == SLEEPMGR_ACTIVE) {
+		cpu_irq_enable();
+		return SLEEPMGR_ACTIVE;
+	}
+
+	timer_stopped = timer_running && (mode > SLEEP_LOOP_TIMER_MODE);
+	if (timer_stopped) {
+		sleep_loop_arm_wakeup(residual - SLEEP_LOOP_WAKEUP_MARGIN_US);
+	}
+
+	sleep_start = ast_read_counter_value(AST);
+	mode_residency[SLEEPMGR_ACTIVE].ticks +=
+			sleep_loop_elapsed(last_wakeup, sleep_start);
+
+	/* Returns with interrupts enabled, after the wakeup interrupt ran */
+	sleepmgr_sleep(mode);
+
+	cpu_irq_disable();
+	last_wakeup = ast_read_counter_value(AST);
+	ticks = sleep_loop_elapsed(sleep_start, last_wakeup);
+	if (timer_stopped) {
+		/* Give the software timers the time their counter missed */
+		sw_timer_advance((uint32_t)((uint64_t)ticks * 1000000UL
+				/ sleep_loop_get_tick_hz()));
+	}
+	cpu_irq_enable();
+
+	if (timer_stopped) {
+		sleep_loop_disarm_wakeup();
+	}
+
+	mode_residency[mode].ticks += ticks;
+	mode_residency[mode].entries++;
+
+	return mode;
+}
+
+/**
+ * \brief Read the time spent in a sleep mode
+ *
+ * \param mode       Sleep mode, SLEEPMGR_ACTIVE for the time awake
+ * \param residency  Returns the entries and AST ticks of \a mode
+ */
+void sleep_loop_get_residency(enum sleepmgr_mode mode,
+		struct sleep_loop_residency *residency)
+{
+	irqflags_t flags = cpu_irq_save();
+	*residency = mode_residency[mode];
+	cpu_irq_restore(flags);
+}
@@ -0,0 +1,131 @@
+/**
+ * \file
+ *
+ * \brief Tickless sleep for the application main loop
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#ifndef SLEEP_LOOP_H_INCLUDED
+#define SLEEP_LOOP_H_INCLUDED
+
+#include <compiler.h>
+#include <sleepmgr.h>
+
+/**
+ * \defgroup sleep_loop_group Tickless sleep loop
+ *
+ * Replaces sleepmgr_enter_sleep() at the end of the main loop. Before each
+ * sleep the time to the next deadline is taken from the running PAL
+ * software timers and the AST alarm, and the deepest mode allowed by the
+ * sleep manager locks is reduced to one that
+ * - keeps the timer counter of the software timers clocked while the next
+ *   of them expires within \ref SLEEP_LOOP_MIN_US_TIMER_STOP, and
+ * - pays off its wakeup time before the deadline.
+ *
+ * The AST alarm is enabled as a wakeup source so that it ends the deep
+ * modes as well. When a deep mode is entered with a software timer running,
+ * the AST periodic event is armed to wake up before it expires and the
+ * time asleep, measured in AST ticks, is added to the timer time with
+ * sw_timer_advance(). That correction is only as fine as one AST tick.
+ * The time spent in each mode is counted in AST ticks.
+ *
+ * @{
+ */
+
+/** Clock of the AST prescaler in Hz */
+#ifndef SLEEP_LOOP_AST_SRC_HZ
+#define SLEEP_LOOP_AST_SRC_HZ           (32768UL)
+#endif
+
+/** Deepest mode in which the timer counter of the PAL timers runs */
+#ifndef SLEEP_LOOP_TIMER_MODE
+#define SLEEP_LOOP_TIMER_MODE           SLEEPMGR_SLEEP_1
+#endif
+
+/**
+ * Shortest time to the next software timer for which the timer counter is
+ * let stop in a deeper mode than \ref SLEEP_LOOP_TIMER_MODE, in us
+ */
+#ifndef SLEEP_LOOP_MIN_US_TIMER_STOP
+#define SLEEP_LOOP_MIN_US_TIMER_STOP    (10000UL)
+#endif
+
+/**
+ * Time before the next software timer to be awake again after a deep
+ * mode, in us. Covers the wakeup time and the AST tick of the correction.
+ */
+#ifndef SLEEP_LOOP_WAKEUP_MARGIN_US
+#define SLEEP_LOOP_WAKEUP_MARGIN_US     (3000UL)
+#endif
+
+#if SLEEP_LOOP_MIN_US_TIMER_STOP <= SLEEP_LOOP_WAKEUP_MARGIN_US
+#error "SLEEP_LOOP_MIN_US_TIMER_STOP must exceed the wakeup margin"
+#endif
+
+/** Shortest time to the next deadline worth entering SLEEP_3, in us */
+#ifndef SLEEP_LOOP_MIN_US_SLEEP_3
+#define SLEEP_LOOP_MIN_US_SLEEP_3       (200UL)
+#endif
+
+/** Shortest time to the next deadline worth entering WAIT, in us */
+#ifndef SLEEP_LOOP_MIN_US_WAIT
+#define SLEEP_LOOP_MIN_US_WAIT          (1000UL)
+#endif
+
+/** Shortest time to the next deadline worth entering RETENTION, in us */
+#ifndef SLEEP_LOOP_MIN_US_RET
+#define SLEEP_LOOP_MIN_US_RET           (2000UL)
+#endif
+
+/** Time spent in one sleep mode */
+struct sleep_loop_residency {
+	/** Number of times the mode was entered */
+	uint32_t entries;
+	/** Time spent in the mode in AST ticks */
+	uint32_t ticks;
+};
+
+void sleep_loop_init(void);
+enum sleepmgr_mode sleep_loop_sleep(void);
+void sleep_loop_get_residency(enum sleepmgr_mode mode,
+		struct sleep_loop_residency *residency);
+uint32_t sleep_loop_get_tick_hz(void);
+
+/** @} */
+
+#endif /* SLEEP_LOOP_H_INCLUDED */
@@ -0,0 +1,316 @@
+/**
+ * \file
+ *
+ * \brief Scheduled transmit slot handling for the smart sensor application
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#include <asf.h>
+#include <string.h>
+#include "avr2025_mac.h"
+#include "pal.h"
+#include "tal.h"
+#include "slot_schedule.h"
+
+/** Timer firing at the start of our own slot */
+static uint8_t slot_timer;
+/** Timer opening the receive window for the next sync frame */
+static uint8_t sync_timer;
+
+/** Node ID looked up in the sync frames */
+static uint8_t own_id;
+/** Slot assigned by the coordinator, \ref SLOT_NONE if none */
+static uint8_t own_slot = SLOT_NONE;
+static slot_callback_t slot_callback;
+
+/** Start time of the current slot frame */
+static uint32_t frame_start;
+/** Number of sync frames missed since the last one received */
+static volatile uint8_t missed_sync = SLOT_MAX_MISSED_SYNC;
+
+/** Coordinator: node ID owning each slot from slot 1 on */
+static uint8_t coord_nodes[SLOT_MAX_NODES];
+static uint8_t coord_node_count;
+/** Coordinator: sync frame, sent to all nodes */
+static uint8_t coord_sync_frame[1 + SLOT_MAX_NODES];
+static wpan_addr_spec_t coord_sync_addr = {
+	.AddrMode = WPAN_ADDRMODE_SHORT,
+	.Addr.short_address = BROADCAST,
+};
+
+static void slot_timer_cb(void *parameter);
+static void sync_timer_cb(void *parameter);
+
+/**
+ * \brief Start the timers for the slot frame beginning at \ref frame_start
+ */
+static void slot_schedule_start_frame(void)
+{
+	uint32_t slot_time;
+	uint32_t listen_time;
+
+	slot_time = pal_add_time_us(frame_start,
+			(uint32_t)own_slot * SLOT_LENGTH_US);
+	listen_time = pal_add_time_us(frame_start,
+			SLOT_FRAME_US - SLOT_SYNC_GUARD_US);
+
+	pal_timer_stop(slot_timer);
+	pal_timer_stop(sync_timer);
+	if (own_slot != SLOT_NONE) {
+		pal_timer_start(slot_timer, slot_time, TIMEOUT_ABSOLUTE,
+				(FUNC_PTR)slot_timer_cb, NULL);
+	}
+	pal_timer_start(sync_timer, listen_time, TIMEOUT_ABSOLUTE,
+			(FUNC_PTR)sync_timer_cb, NULL);
+}
+
+/**
+ * \brief Own slot has started
+ *
+ * The frame is handed to the MAC right away; with macMinBE set to 0 the
+ * MAC transmits after a single CCA without random backoff.
+ */
+static void slot_timer_cb(void *parameter)
+{
+	UNUSED(parameter);
+
+	if (slot_schedule_is_synced()) {
+		slot_callback();
+	}
+}
+
+/**
+ * \brief Sync frame is due, enable the receiver for the guard window
+ *
+ * The timers of the next frame are started from the expected sync time,
+ * so the node keeps its slot for a few frames even if sync frames are lost.
+ * Once out of sync the receiver is kept on for whole frames until a sync
+ * frame is received again.
+ */
+static void sync_timer_cb(void *parameter)
+{
+	uint32_t rx_on_us;
+
+	UNUSED(parameter);
+
+	if (missed_sync < SLOT_MAX_MISSED_SYNC) {
+		missed_sync++;
+	}
+
+	if (missed_sync < SLOT_MAX_MISSED_SYNC) {
+		rx_on_us = 2 * SLOT_SYNC_GUARD_US;
+	} else {
+		rx_on_us = SLOT_FRAME_US;
+	}
+	wpan_mlme_rx_enable_req(false, 0, TAL_CONVERT_US_TO_SYMBOLS(rx_on_us));
+
+	frame_start = pal_add_time_us(frame_start, SLOT_FRAME_US);
+	slot_schedule_start_frame();
+}
+
+/**
+ * \brief Initialize scheduled transmission
+ *
+ * Must be called after wpan_init(), since the timers are allocated from
+ * the PAL timer pool shared with the stack. The receiver is enabled for a
+ * full frame to acquire the first sync frame.
+ *
+ * \param[in]  node_id   ID the coordinator assigns the slot to
+ * \param[in]  callback  Function called at the start of the slot
+ *
+ * \return true if the timers could be allocated
+ */
+bool slot_schedule_init(uint8_t node_id, slot_callback_t callback)
+{
+	if (pal_timer_get_id(&slot_timer) != MAC_SUCCESS) {
+		return false;
+	}
+	if (pal_timer_get_id(&sync_timer) != MAC_SUCCESS) {
+		return false;
+	}
+
+	own_id = node_id;
+	own_slot = SLOT_NONE;
+	slot_callback = callback;
+	missed_sync = SLOT_MAX_MISSED_SYNC;
+
+	pal_get_current_time(&frame_start);
+	slot_schedule_start_frame();
+	wpan_mlme_rx_enable_req(false, 0,
+			TAL_CONVERT_US_TO_SYMBOLS(SLOT_FRAME_US));
+
+	return true;
+}
+
+/**
+ * \brief Align the slot frame to a sync frame from the coordinator
+ *
+ * Frames that are not sync frames are ignored, so other traffic from the
+ * coordinator does not move the schedule.
+ *
+ * \param[in]  msdu     Payload of the received frame
+ * \param[in]  length   Length of the payload
+ * \param[in]  rx_time  Receive timestamp of the frame
+ *
+ * \return true if the frame was a sync frame
+ */
+bool slot_schedule_rx_frame(const uint8_t *msdu, uint8_t length,
+		uint32_t rx_time)
+{
+	uint8_t i;
+
+	if ((length == 0) || (msdu[0] != SLOT_SYNC_FRAME_ID)) {
+		return false;
+	}
+
+	own_slot = SLOT_NONE;
+	for (i = 1; (i < length) && (i <= SLOT_MAX_NODES); i++) {
+		if (msdu[i] == own_id) {
+			own_slot = i;
+			break;
+		}
+	}
+
+	missed_sync = 0;
+	frame_start = rx_time;
+	slot_schedule_start_frame();
+	return true;
+}
+
+/**
+ * \brief Check whether the node transmits in its own slot
+ *
+ * \return true if a sync frame assigning a slot was received recently
+ */
+bool slot_schedule_is_synced(void)
+{
+	return (missed_sync < SLOT_MAX_MISSED_SYNC) && (own_slot != SLOT_NONE);
+}
+
+/**
+ * \brief Check whether another data frame fits in the current slot
+ *
+ * Frames that do not fit are left for the next slot, so that a backlog
+ * does not run into the slot of the next node. Without a slot frames are
+ * sent unscheduled and always fit.
+ *
+ * \return true if a frame started now ends before the slot does
+ */
+bool slot_schedule_tx_fits(void)
+{
+	uint32_t slot_start;
+	uint32_t now;
+
+	if (!slot_schedule_is_synced()) {
+		return true;
+	}
+	slot_start = pal_add_time_us(frame_start,
+			(uint32_t)own_slot * SLOT_LENGTH_US);
+	pal_get_current_time(&now);
+
+	/* Before the slot the difference wraps and is too large as well */
+	return (pal_sub_time_us(now, slot_start) + SLOT_TX_TIME_US) <=
+			SLOT_LENGTH_US;
+}
+
+/**
+ * \brief Coordinator: send the sync frame and start the next slot frame
+ */
+static void coord_timer_cb(void *parameter)
+{
+	UNUSED(parameter);
+
+	coord_sync_frame[0] = SLOT_SYNC_FRAME_ID;
+	memcpy(&coord_sync_frame[1], coord_nodes, coord_node_count);
+	wpan_mcps_data_req(WPAN_ADDRMODE_SHORT, &coord_sync_addr,
+			1 + coord_node_count, coord_sync_frame,
+			SLOT_SYNC_MSDU_HANDLE, WPAN_TXOPT_OFF);
+
+	frame_start = pal_add_time_us(frame_start, SLOT_FRAME_US);
+	pal_timer_start(sync_timer, frame_start, TIMEOUT_ABSOLUTE,
+			(FUNC_PTR)coord_timer_cb, NULL);
+}
+
+/**
+ * \brief Start sending sync frames as the coordinator
+ *
+ * A sync frame is sent at the start of every slot frame, in slot 0. The
+ * receiver of the coordinator has to stay on to hear the nodes.
+ *
+ * \param[in]  pan_id  PAN the sync frames are sent to
+ *
+ * \return true if the timer could be allocated
+ */
+bool slot_schedule_coord_init(uint16_t pan_id)
+{
+	if (pal_timer_get_id(&sync_timer) != MAC_SUCCESS) {
+		return false;
+	}
+
+	coord_sync_addr.PANId = pan_id;
+	coord_node_count = 0;
+
+	pal_get_current_time(&frame_start);
+	frame_start = pal_add_time_us(frame_start, SLOT_FRAME_US);
+	pal_timer_start(sync_timer, frame_start, TIMEOUT_ABSOLUTE,
+			(FUNC_PTR)coord_timer_cb, NULL);
+
+	return true;
+}
+
+/**
+ * \brief Coordinator: give a slot to a node heard for the first time
+ *
+ * Slots are handed out in the order the nodes are first heard. Once all
+ * SLOT_MAX_NODES slots are taken, further nodes stay unscheduled.
+ *
+ * \param[in]  node_id  ID of the node that sent a data frame
+ */
+void slot_schedule_coord_node_heard(uint8_t node_id)
+{
+	uint8_t i;
+
+	for (i = 0; i < coord_node_count; i++) {
+		if (coord_nodes[i] == node_id) {
+			return;
+		}
+	}
+	if (coord_node_count < SLOT_MAX_NODES) {
+		coord_nodes[coord_node_count++] = node_id;
+	}
+}
@@ -0,0 +1,131 @@
+/**
+ * \file
+ *
+ * \brief Scheduled transmit slot handling for the smart sensor application
+ *
+ * Copyright (c) 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ */
+
+#ifndef SLOT_SCHEDULE_H_INCLUDED
+#define SLOT_SCHEDULE_H_INCLUDED
+
+#include <compiler.h>
+
+/**
+ * \defgroup slot_schedule_group Scheduled transmit slots
+ *
+ * The coordinator sends a sync frame at the start of every slot frame.
+ * Each node owns one slot relative to that frame start, transmits only in
+ * that slot and keeps the receiver off except for a short window around
+ * the next expected sync frame.
+ *
+ * The sync frame is a broadcast starting with \ref SLOT_SYNC_FRAME_ID,
+ * followed by the node ID owning each slot from slot 1 on. The coordinator
+ * gives the next free slot to every node it hears from, so no two nodes
+ * share a slot. A node without a slot sends unscheduled until the
+ * coordinator has heard it and lists it in a sync frame.
+ *
+ * All times are in microseconds of the PAL timer, the same timebase as
+ * the transceiver timestamps.
+ *
+ * @{
+ */
+
+/** Length of one slot frame, i.e. the interval between sync frames */
+#ifndef SLOT_FRAME_US
+#define SLOT_FRAME_US                   (1000000UL)
+#endif
+
+/** Length of one transmit slot */
+#ifndef SLOT_LENGTH_US
+#define SLOT_LENGTH_US                  (10000UL)
+#endif
+
+/** Number of slots per frame; slot 0 carries the sync frame */
+#define SLOT_COUNT                      (SLOT_FRAME_US / SLOT_LENGTH_US)
+
+/** Receiver is enabled this long before and after the expected sync frame */
+#ifndef SLOT_SYNC_GUARD_US
+#define SLOT_SYNC_GUARD_US              (2000UL)
+#endif
+
+/** Number of missed sync frames after which the node is out of sync */
+#ifndef SLOT_MAX_MISSED_SYNC
+#define SLOT_MAX_MISSED_SYNC            (4)
+#endif
+
+/** Number of slots the coordinator assigns, from slot 1 on */
+#ifndef SLOT_MAX_NODES
+#define SLOT_MAX_NODES                  (16)
+#endif
+
+#if (SLOT_MAX_NODES >= SLOT_COUNT)
+#error "SLOT_MAX_NODES must leave slot 0 to the coordinator"
+#endif
+
+/**
+ * Slot time taken by one data frame: CCA, the frame, the turnaround and
+ * the acknowledgment
+ */
+#ifndef SLOT_TX_TIME_US
+#define SLOT_TX_TIME_US                 (3000UL)
+#endif
+
+/** First octet of a sync frame, data protocol packets start with 0xFF */
+#define SLOT_SYNC_FRAME_ID              (0xFE)
+
+/** MSDU handle of the sync frames, never used for data frames */
+#define SLOT_SYNC_MSDU_HANDLE           (0xFF)
+
+/** Slot number of a node that has not been assigned a slot */
+#define SLOT_NONE                       (0)
+
+/** Callback invoked at the start of the node's own slot */
+typedef void (*slot_callback_t)(void);
+
+bool slot_schedule_init(uint8_t node_id, slot_callback_t callback);
+bool slot_schedule_rx_frame(const uint8_t *msdu, uint8_t length,
+		uint32_t rx_time);
+bool slot_schedule_is_synced(void);
+bool slot_schedule_tx_fits(void);
+
+bool slot_schedule_coord_init(uint16_t pan_id);
+void slot_schedule_coord_node_heard(uint8_t node_id);
+
+/** @} */
+
+#endif /* SLOT_SCHEDULE_H_INCLUDED */
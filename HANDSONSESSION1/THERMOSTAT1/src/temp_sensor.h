@@ -51,8 +51,19 @@
 #define DEFAULT_CHANNEL                 (20)
 #define DEFAULT_CHANNEL_PAGE            (0)
 
+/**
+ * Build the coordinator of the slot schedule instead of a sensor node. It
+ * sends the sync frame of every slot frame, assigns the slots and does not
+ * report readings itself.
+ */
+#define APP_COORDINATOR                 (0)
+
 /** Defines the short address of this node. */
+#if (APP_COORDINATOR == 1)
+#define SOURCE_SHORT_ADDR               (0x0001)
+#else
 #define SOURCE_SHORT_ADDR               (0x8001)
+#endif
 /** Defines the short address of the other neighbor node. */
 //#define DESTINATION_SHORT_ADDR          (0x8002)
 #define DESTINATION_SHORT_ADDR          (0x0001)
@@ -64,4 +75,55 @@
 //#define DESTINATION_PAN_ID              (0xBEEF)
 #define DESTINATION_PAN_ID              (0xCAFE)
 
+/**
+ * Transmit in a slot assigned relative to the coordinator's sync frame
+ * instead of at unsynchronized intervals. The receiver is switched off
+ * outside the sync window.
+ */
+#define APP_SLOT_SCHEDULE               (1)
+
+/**
+ * Sample the sensor continuously with the ADC internal timer and PDCA and
+ * report one filtered reading per block, instead of one software triggered
+ * conversion per AST alarm. The reading is sent with 4 fractional bits.
+ * Off by default: the stream keeps the CPU in SLEEP_0 and wakes it for
+ * every block, while the window monitor of APP_REPORT_ON_CHANGE only wakes
+ * it when the reading leaves the band.
+ */
+#define APP_ADC_STREAM                  (0)
+
+/**
+ * Send a reading only when it moved more than APP_REPORT_BAND ADC codes
+ * away from the last one sent, and otherwise every APP_HEARTBEAT_S
+ * seconds. Without APP_ADC_STREAM the ADC window monitor does the compare
+ * and the CPU is woken only when the reading leaves the band.
+ */
+#define APP_REPORT_ON_CHANGE            (1)
+#define APP_REPORT_BAND                 (16)
+#define APP_HEARTBEAT_S                 (60)
+
+/** Conversion rate of the window monitor, in Hz */
+#define APP_ADC_WINDOW_SAMPLE_HZ        (16)
+
+/**
+ * Keep readings that were not acknowledged in a flash log and upload them,
+ * oldest first, once frames are acknowledged again. Up to APP_LOG_BURST
+ * logged readings are sent back to back in each transmit slot.
+ *
+ * Readings staged in RAM are written to flash as a partial page every
+ * APP_LOG_FLUSH_S seconds, so a reset loses at most that much of the log.
+ * Each flush uses up a flash page, shorter intervals wear the ring faster.
+ */
+#define APP_SAMPLE_LOG                  (1)
+#define APP_LOG_BURST                   (4)
+#define APP_LOG_FLUSH_S                 (900)
+
+#if (APP_SLOT_SCHEDULE == 1) && !defined(ENABLE_TSTAMP)
+#error "APP_SLOT_SCHEDULE requires ENABLE_TSTAMP"
+#endif
+
+#if (APP_COORDINATOR == 1) && (APP_SLOT_SCHEDULE != 1)
+#error "APP_COORDINATOR requires APP_SLOT_SCHEDULE"
+#endif
+
 #endif /* SMART_SENSOR_H_INCLUDED */
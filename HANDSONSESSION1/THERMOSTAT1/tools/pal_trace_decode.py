@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Decode the binary trace written by pal_trace.c.
+
+The event table is read from PAL_TRACE_EVENTS in pal_trace.h, so the
+decoder follows the firmware it was built from. Records are COBS encoded
+and end with a zero byte; the decoder starts at the first zero byte and
+resynchronizes on the next one after a damaged record. Input is either a
+captured byte stream or a serial port (requires pyserial):
+
+    pal_trace_decode.py capture.bin
+    pal_trace_decode.py --port /dev/ttyACM0 --baud 115200
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HEADER = os.path.join(os.path.dirname(__file__), '..', 'src', 'ASF',
+                      'thirdparty', 'wireless', 'avr2025_mac', 'source',
+                      'pal', 'pal_trace.h')
+
+
+def load_events(path):
+    with open(path) as f:
+        text = f.read()
+    table = text[text.index('#define PAL_TRACE_EVENTS(X)'):]
+    table = table[:table.index('\n\n')]
+    return [(name, fmt) for name, fmt in
+            re.findall(r'X\((\w+),\s*"((?:[^"\\]|\\.)*)"\)', table)]
+
+
+def varints(data):
+    value = shift = 0
+    for byte in data:
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            yield value
+            value = shift = 0
+
+
+def unsigned_args(fmt, args):
+    """Undo PAL_TRACE_SIGNED() for %d and %i conversions."""
+    convs = re.findall(r'%[-+ #0]*\d*(?:\.\d+)?([a-zA-Z%])', fmt)
+    convs = [c for c in convs if c != '%']
+    out = []
+    for conv, value in zip(convs, args):
+        if conv in 'di':
+            value = (value >> 1) ^ -(value & 1)
+        out.append(value)
+    return tuple(out)
+
+
+def cobs_decode(frame):
+    """Undo the COBS encoding of a frame, None if it is malformed."""
+    out = bytearray()
+    pos = 0
+    while pos < len(frame):
+        code = frame[pos]
+        if code == 0 or pos + code > len(frame):
+            return None
+        out += frame[pos + 1:pos + code]
+        pos += code
+        if pos < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def records(stream, out):
+    """Yield the payload of each zero-delimited COBS record.
+
+    The bytes before the first delimiter may be the tail of a record, so
+    they are skipped. A frame that does not decode is reported and the
+    decoder continues with the next one.
+    """
+    synced = False
+    frame = bytearray()
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            return
+        if byte[0] != 0:
+            frame += byte
+            continue
+        if synced and frame:
+            payload = cobs_decode(frame)
+            if payload is None:
+                out.write('?? bad frame %s\n' % frame.hex())
+            else:
+                yield payload
+        synced = True
+        frame = bytearray()
+
+
+def decode(stream, events, out):
+    now = None
+    for payload in records(stream, out):
+        fields = list(varints(payload))
+        if len(fields) < 2:
+            out.write('?? malformed record %s\n' % payload.hex())
+            continue
+        event, stamp, args = fields[0], fields[1], fields[2:]
+        # The PAL time is a 32 bit microsecond counter. Records of nested
+        # interrupts may be slightly out of order, so only a large step
+        # back is taken as a wrap.
+        if now is None:
+            now = stamp
+        else:
+            step = (stamp - now) & 0xFFFFFFFF
+            now += step if step < (1 << 31) else step - (1 << 32)
+        if event >= len(events):
+            out.write('%12d  ?? event %d %s\n' % (now, event, args))
+            continue
+        name, fmt = events[event]
+        try:
+            text = fmt % unsigned_args(fmt, args)
+        except TypeError:
+            text = '%s %s' % (fmt, args)
+        out.write('%12d  %s\n' % (now, text))
+        out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('capture', nargs='?', help='captured byte stream')
+    parser.add_argument('--port', help='serial port to read from')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--header', default=HEADER,
+                        help='pal_trace.h holding the event table')
+    opts = parser.parse_args()
+
+    events = load_events(opts.header)
+    if opts.port:
+        import serial
+        stream = serial.Serial(opts.port, opts.baud)
+    elif opts.capture:
+        stream = open(opts.capture, 'rb')
+    else:
+        stream = sys.stdin.buffer
+    try:
+        decode(stream, events, sys.stdout)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,178 @@
+/**
+ * \file
+ *
+ * \brief Host benchmark of the sensor decimation filter.
+ *
+ * Copyright (c) 2012-2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/*
+ * Runs blocks of ADC codes through sensor_filter.c built with
+ * SENSOR_FILTER_HOST, prints the reading of each block and the time spent
+ * per block.
+ *
+ * Build and run on the host:
+ *   cc -O2 -DSENSOR_FILTER_HOST -I../src -o sensor_filter_bench \
+ *       sensor_filter_bench.c ../src/sensor_filter.c
+ *   ./sensor_filter_bench [-l level] [-b blocks] [-n repeat] [codes.txt]
+ *
+ * codes.txt holds ADC codes separated by white space, e.g. a dump of the
+ * ADC stream buffers. Without it, a constant level with +/-2 LSB of noise
+ * and a full scale spike every 97 samples is generated. Each reading must
+ * then be within 1 LSB of the level, from the first block on, and the exit
+ * status is 1 otherwise.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sensor_filter.h"
+
+//! Default level of the generated signal, in ADC codes.
+#define BENCH_LEVEL        1000
+//! Default number of generated blocks.
+#define BENCH_BLOCKS       8
+//! Period of the generated spikes, in samples.
+#define BENCH_SPIKE_PERIOD 97
+//! Highest ADC code.
+#define BENCH_MAX_CODE     0xFFF
+
+static uint16_t bench_block[SENSOR_FILTER_BLOCK_SIZE];
+
+/**
+ * \brief Generate the next block of the test signal.
+ */
+static void bench_generate(uint16_t level, uint32_t *sample)
+{
+	static uint32_t seed = 1;
+
+	for (int i = 0; i < SENSOR_FILTER_BLOCK_SIZE; i++, (*sample)++) {
+		seed = seed * 1103515245 + 12345;
+		if (*sample % BENCH_SPIKE_PERIOD == BENCH_SPIKE_PERIOD - 1) {
+			bench_block[i] = BENCH_MAX_CODE;
+		} else {
+			bench_block[i] = level + (int)((seed >> 16) % 5) - 2;
+		}
+	}
+}
+
+/**
+ * \brief Read the next block of codes from a file.
+ *
+ * \return false once the file holds no complete block anymore.
+ */
+static bool bench_read(FILE *f)
+{
+	unsigned code;
+
+	for (int i = 0; i < SENSOR_FILTER_BLOCK_SIZE; i++) {
+		if (fscanf(f, "%u", &code) != 1) {
+			return false;
+		}
+		bench_block[i] = (uint16_t)code;
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	uint16_t level = BENCH_LEVEL;
+	unsigned long blocks = BENCH_BLOCKS;
+	unsigned long repeat = 1;
+	unsigned long count = 0;
+	unsigned long ticks = 0;
+	uint32_t sample = 0;
+	FILE *f = NULL;
+	int failed = 0;
+	int opt;
+
+	for (opt = 1; opt < argc; opt++) {
+		if (!strcmp(argv[opt], "-l") && opt + 1 < argc) {
+			level = (uint16_t)strtoul(argv[++opt], NULL, 0);
+		} else if (!strcmp(argv[opt], "-b") && opt + 1 < argc) {
+			blocks = strtoul(argv[++opt], NULL, 0);
+		} else if (!strcmp(argv[opt], "-n") && opt + 1 < argc) {
+			repeat = strtoul(argv[++opt], NULL, 0);
+		} else if (argv[opt][0] != '-' && f == NULL) {
+			f = fopen(argv[opt], "r");
+			if (f == NULL) {
+				perror(argv[opt]);
+				return 2;
+			}
+		} else {
+			fprintf(stderr, "usage: %s [-l level] [-b blocks] [-n repeat]"
+					" [codes.txt]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (repeat == 0) {
+		repeat = 1;
+	}
+
+	sensor_filter_init();
+	while (f ? bench_read(f) : count < blocks) {
+		uint16_t reading = 0;
+
+		if (f == NULL) {
+			bench_generate(level, &sample);
+		}
+		// Repeat on the same block to time it, only the last run counts
+		for (unsigned long r = 0; r < repeat; r++) {
+			reading = sensor_filter_process(bench_block);
+			ticks += sensor_filter_get_cycles();
+		}
+		printf("block %lu: reading %u (%.2f codes)\n", count, reading,
+				(double)reading / (1 << SENSOR_FILTER_FRAC_BITS));
+		if (f == NULL && abs((int)reading - (level << SENSOR_FILTER_FRAC_BITS))
+				> (1 << SENSOR_FILTER_FRAC_BITS)) {
+			printf("  FAILED: more than 1 LSB away from %u\n", level);
+			failed++;
+		}
+		count++;
+	}
+	if (f != NULL) {
+		fclose(f);
+	}
+	if (count > 0) {
+		printf("%lu block(s) of %d samples, %.2f us per block\n", count,
+				SENSOR_FILTER_BLOCK_SIZE,
+				1e6 * ticks / CLOCKS_PER_SEC / (count * repeat));
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,295 @@
+/**
+ * \file
+ *
+ * \brief Host test and benchmark of the CCM* security toolbox.
+ *
+ * Copyright (c) 2012-2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/*
+ * Runs stb_ccm_secure() on top of the software AES engine against the
+ * CCM* test vectors of IEEE 802.15.4-2006 Annex C.2, then checks that a
+ * modified frame is rejected with STB_CCM_MICERR, and measures the time
+ * spent per frame.
+ *
+ * Build and run on the host:
+ *   S=../src/ASF/thirdparty/wireless/avr2025_mac/source
+ *   cc -O2 -DSTB_ON_SAL -DSAL_TYPE=SW_AES -I$S/sal/inc -I$S/stb/inc \
+ *       -o stb_ccm_test stb_ccm_test.c $S/stb/src/stb.c \
+ *       $S/sal/sw/src/sal_sw.c
+ *   ./stb_ccm_test [-n repeat]
+ *
+ * The exit status is 0 if all the vectors pass.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sal.h"
+#include "stb.h"
+
+//! Largest secured frame of the vectors.
+#define TEST_MAX_FRAME     64
+
+//! CCM* test vector.
+typedef struct {
+	const char *name;
+	uint8_t sec_level;
+	uint8_t hdr_len;
+	uint8_t pld_len;
+	uint8_t mic_len;
+	//! Header followed by the plaintext payload.
+	uint8_t plain[TEST_MAX_FRAME];
+	//! Header followed by the ciphertext payload and the encrypted MIC.
+	uint8_t secured[TEST_MAX_FRAME];
+} test_vector_t;
+
+//! Key of all the Annex C vectors.
+static uint8_t test_key[AES_KEYSIZE] = {
+	0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+	0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF
+};
+
+//! Source address and frame counter of all the Annex C vectors.
+static const uint8_t test_nonce[12] = {
+	0xAC, 0xDE, 0x48, 0x00, 0x00, 0x00, 0x00, 0x01,
+	0x00, 0x00, 0x00, 0x05
+};
+
+static const test_vector_t test_vectors[] = {
+	{
+		"C.2.1 beacon, MIC-64", 2, 26, 0, 8,
+		{
+			0x08, 0xD0, 0x84, 0x21, 0x43, 0x01, 0x00, 0x00,
+			0x00, 0x00, 0x48, 0xDE, 0xAC, 0x02, 0x05, 0x00,
+			0x00, 0x00, 0x55, 0xCF, 0x00, 0x00, 0x51, 0x52,
+			0x53, 0x54
+		},
+		{
+			0x08, 0xD0, 0x84, 0x21, 0x43, 0x01, 0x00, 0x00,
+			0x00, 0x00, 0x48, 0xDE, 0xAC, 0x02, 0x05, 0x00,
+			0x00, 0x00, 0x55, 0xCF, 0x00, 0x00, 0x51, 0x52,
+			0x53, 0x54, 0x22, 0x3B, 0xC1, 0xEC, 0x84, 0x1A,
+			0xB5, 0x53
+		}
+	},
+	{
+		"C.2.2 data, ENC", 4, 26, 4, 0,
+		{
+			0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+			0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+			0x00, 0x00, 0x48, 0xDE, 0xAC, 0x04, 0x05, 0x00,
+			0x00, 0x00, 0x61, 0x62, 0x63, 0x64
+		},
+		{
+			0x69, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+			0x00, 0x00, 0x48, 0xDE, 0xAC, 0x01, 0x00, 0x00,
+			0x00, 0x00, 0x48, 0xDE, 0xAC, 0x04, 0x05, 0x00,
+			0x00, 0x00, 0xD4, 0x3E, 0x02, 0x2B
+		}
+	},
+	{
+		"C.2.3 command, ENC-MIC-64", 6, 29, 1, 8,
+		{
+			0x2B, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+			0x00, 0x00, 0x48, 0xDE, 0xAC, 0xFF, 0xFF, 0x01,
+			0x00, 0x00, 0x00, 0x00, 0x48, 0xDE, 0xAC, 0x06,
+			0x05, 0x00, 0x00, 0x00, 0x01, 0xCE
+		},
+		{
+			0x2B, 0xDC, 0x84, 0x21, 0x43, 0x02, 0x00, 0x00,
+			0x00, 0x00, 0x48, 0xDE, 0xAC, 0xFF, 0xFF, 0x01,
+			0x00, 0x00, 0x00, 0x00, 0x48, 0xDE, 0xAC, 0x06,
+			0x05, 0x00, 0x00, 0x00, 0x01, 0xD8, 0x4F, 0xDE,
+			0x52, 0x90, 0x61, 0xF9, 0xC6, 0xF1
+		}
+	},
+};
+
+#define TEST_NB_VECTORS    (sizeof(test_vectors) / sizeof(test_vectors[0]))
+
+/**
+ * \brief Build the nonce block of a vector: source address, frame counter
+ *        and security level at STB_NONCE_OFFSET.
+ */
+static void test_nonce_block(uint8_t nonce[AES_BLOCKSIZE], uint8_t sec_level)
+{
+	memset(nonce, 0, AES_BLOCKSIZE);
+	memcpy(&nonce[STB_NONCE_OFFSET], test_nonce, sizeof(test_nonce));
+	nonce[STB_NONCE_OFFSET + sizeof(test_nonce)] = sec_level;
+}
+
+/**
+ * \brief Secure or unsecure one frame of a vector in place.
+ */
+static stb_ccm_t test_run(const test_vector_t *v, uint8_t *frame,
+		uint8_t aes_dir)
+{
+	uint8_t nonce[AES_BLOCKSIZE];
+
+	test_nonce_block(nonce, v->sec_level);
+	return stb_ccm_secure(frame, nonce, test_key, v->hdr_len, v->pld_len,
+			v->sec_level, aes_dir);
+}
+
+/**
+ * \brief Print the first difference between two frames.
+ */
+static void test_report(const char *what, const uint8_t *got,
+		const uint8_t *expected, uint8_t len)
+{
+	uint8_t i;
+
+	for (i = 0; i < len; i++) {
+		if (got[i] != expected[i]) {
+			printf("  %s: octet %u is 0x%02X, expected 0x%02X\n",
+					what, i, got[i], expected[i]);
+			return;
+		}
+	}
+}
+
+/**
+ * \brief Check one vector: encryption, decryption, and MIC error on a
+ *        modified frame.
+ *
+ * \return Number of failed checks.
+ */
+static int test_vector(const test_vector_t *v)
+{
+	uint8_t frame[TEST_MAX_FRAME];
+	uint8_t len = v->hdr_len + v->pld_len + v->mic_len;
+	stb_ccm_t status;
+	int failed = 0;
+
+	memcpy(frame, v->plain, v->hdr_len + v->pld_len);
+	status = test_run(v, frame, AES_DIR_ENCRYPT);
+	if (status != STB_CCM_OK || memcmp(frame, v->secured, len)) {
+		printf("%s: encryption FAILED (status %d)\n", v->name, status);
+		test_report("encrypted", frame, v->secured, len);
+		failed++;
+	}
+
+	memcpy(frame, v->secured, len);
+	status = test_run(v, frame, AES_DIR_DECRYPT);
+	if (status != STB_CCM_OK ||
+			memcmp(frame, v->plain, v->hdr_len + v->pld_len)) {
+		printf("%s: decryption FAILED (status %d)\n", v->name, status);
+		test_report("decrypted", frame, v->plain, v->hdr_len + v->pld_len);
+		failed++;
+	}
+
+	// Without a MIC, a modified frame cannot be detected
+	if (v->mic_len > 0) {
+		memcpy(frame, v->secured, len);
+		frame[v->hdr_len - 1] ^= 0x01;
+		status = test_run(v, frame, AES_DIR_DECRYPT);
+		if (status != STB_CCM_MICERR) {
+			printf("%s: modified header accepted (status %d)\n",
+					v->name, status);
+			failed++;
+		}
+		memcpy(frame, v->secured, len);
+		frame[len - 1] ^= 0x80;
+		status = test_run(v, frame, AES_DIR_DECRYPT);
+		if (status != STB_CCM_MICERR) {
+			printf("%s: modified MIC accepted (status %d)\n",
+					v->name, status);
+			failed++;
+		}
+	}
+
+	if (!failed) {
+		printf("%s: ok\n", v->name);
+	}
+	return failed;
+}
+
+/**
+ * \brief Measure the time spent to secure and unsecure the frame of a
+ *        vector.
+ */
+static void test_bench(const test_vector_t *v, unsigned long repeat)
+{
+	uint8_t frame[TEST_MAX_FRAME];
+	uint8_t len = v->hdr_len + v->pld_len + v->mic_len;
+	struct timespec start, stop;
+	unsigned long i;
+	double ns;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < repeat; i++) {
+		memcpy(frame, v->plain, v->hdr_len + v->pld_len);
+		test_run(v, frame, AES_DIR_ENCRYPT);
+		test_run(v, frame, AES_DIR_DECRYPT);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	ns = (stop.tv_sec - start.tv_sec) * 1e9 +
+			(stop.tv_nsec - start.tv_nsec);
+	printf("%s: %u octets, %.0f ns per secure + unsecure\n",
+			v->name, len, ns / repeat);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned long repeat = 0;
+	int failed = 0;
+	unsigned i;
+
+	if (argc == 3 && !strcmp(argv[1], "-n")) {
+		repeat = strtoul(argv[2], NULL, 0);
+	} else if (argc != 1) {
+		fprintf(stderr, "usage: %s [-n repeat]\n", argv[0]);
+		return 2;
+	}
+
+	stb_init();
+	for (i = 0; i < TEST_NB_VECTORS; i++) {
+		failed += test_vector(&test_vectors[i]);
+	}
+	if (failed) {
+		printf("%d check(s) FAILED\n", failed);
+		return 1;
+	}
+
+	for (i = 0; repeat && i < TEST_NB_VECTORS; i++) {
+		test_bench(&test_vectors[i], repeat);
+	}
+	return 0;
+}
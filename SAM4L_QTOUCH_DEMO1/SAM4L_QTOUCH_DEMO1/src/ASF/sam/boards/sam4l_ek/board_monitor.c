@@ -44,51 +44,6 @@
 #include "board_monitor.h"
 #include "delay.h"
 
-/** Board Monitor Message Start pattern. */
-#define BM_MSG_START_PATTERN                0x75
-/** Board Monitor Message Stop pattern. */
-#define BM_MSG_STOP_PATTERN                 0xa3
-/** Board Monitor Message Number of bytes to transfer. */
-#define BM_MSG_LENGTH_DEFAULT               9
-/** Board Monitor Message Default ID Message. */
-#define BM_MSG_ID_DEFAULT                   0
-/** Enable/disable the board monitor mouse-like pointer. */
-#define BM_POINTER_CTRL                     0x01
-/** Send new mouse pointer position. */
-#define BM_POINTER_MOVE                     0x02
-/** Enable/disable the board monitor. */
-#define BM_CTRL                             0x03
-/** Turn-on a LED of the board monitor. */
-#define BM_LED_SET                          0x04
-/** Turn-off a LED of the board monitor. */
-#define BM_LED_CLR                          0x05
-/** Toggle a LED of the board monitor. */
-#define BM_LED_TGL                          0x06
-/** Send MCU power saving information to the board monitor. */
-#define BM_MCU_STATUS                       0x07
-/** Enable/disable the pull-up on TWI lines. */
-#define BM_PULLUP_TWI                       0x08
-/** Send PicoUart Frame. */
-#define BM_PICOUART_SEND                    0x09
-/** Send Current Consumption Measured Request. */
-#define BM_MCU_GET_CURRENT                  0x0A
-/** Force Toggle of Button Line. */
-#define BM_TGL_BUTTON                       0x0B
-/** Return Current Consumption Measured. */
-#define BM_MCU_RET_CURRENT                  0x0C
-/** Send free size (in byte) of the board monitor command fifo request. */
-#define BM_MCU_GET_FIFO_FREE_SIZE           0x0D
-/** Return the free size (in byte) of the board monitor command fifo. */
-#define BM_MCU_RET_FIFO_FREE_SIZE           0x0E
-/** Print Text On Board Monitor. */
-#define BM_PRINT_TEXT                       0x0F
-/** Clear Print Text Area On Board Monitor. */
-#define BM_PRINT_CLEAR                      0x10
-/** Send Firmware Version Request. */
-#define BM_GET_FIRMWARE_VERSION             0x11
-/** Return Firmware Version value . */
-#define BM_RET_FIRMWARE_VERSION             0x12
-
 /**
  *  \brief Configure the USART.
  */
@@ -363,8 +318,6 @@ void bm_print_clear(void)
 
 void bm_print_txt(uint8_t* str, uint8_t str_length)
 {
-#define BM_PRINT_TEXT_SIZE                  21
-#define BM_PRINT_TEXT_DEEP                  6
 	usart_enable_tx(BM_USART_USART);
 	usart_putchar(BM_USART_USART, BM_MSG_START_PATTERN);
 	usart_putchar(BM_USART_USART, BM_PRINT_TEXT_SIZE + 3 /* length */);
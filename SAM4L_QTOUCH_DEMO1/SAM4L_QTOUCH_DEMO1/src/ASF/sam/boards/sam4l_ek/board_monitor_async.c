@@ -0,0 +1,487 @@
+/**
+ * \file
+ *
+ * \brief SAM4L-EK Board Monitor Control, asynchronous interface.
+ *
+ * Copyright (c) 2012 - 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+#include "board_monitor_async.h"
+#include "pdca.h"
+#include "sleepmgr.h"
+
+//! PDCA peripheral ID of the board monitor USART transmitter
+#define BM_ASYNC_PDCA_ID_TX                 USART0_PDCA_ID_TX
+//! Interrupt line of the board monitor USART
+#define BM_ASYNC_USART_IRQn                 USART0_IRQn
+
+//! Size of a MCU status frame
+#define BM_ASYNC_STATUS_SIZE                11
+//! Size of the largest response frame (current), without the start pattern
+#define BM_ASYNC_RX_SIZE                    7
+
+//! Outstanding query
+typedef struct {
+	//! Expected response command
+	uint8_t response;
+	bm_async_current_callback_t current;
+	bm_async_fifo_free_size_callback_t fifo_free_size;
+} bm_async_query_t;
+
+//! Response parser states
+enum bm_async_rx_state {
+	BM_ASYNC_RX_START,
+	BM_ASYNC_RX_LENGTH,
+	BM_ASYNC_RX_BODY,
+};
+
+//! Transmit buffer, read by the PDCA
+static uint8_t bm_async_tx_buf[BM_ASYNC_TX_SIZE];
+static volatile uint16_t bm_async_tx_head;
+static volatile uint16_t bm_async_tx_tail;
+static volatile uint16_t bm_async_tx_count;
+//! Number of bytes loaded in the PDCA channel, 0 while waiting for TXEMPTY
+static volatile uint16_t bm_async_tx_len;
+//! The transmitter is enabled, until the last frame is shifted out
+static volatile bool bm_async_tx_active;
+
+//! Latest MCU status frame, queued once the transmit buffer is empty
+static uint8_t bm_async_status[BM_ASYNC_STATUS_SIZE];
+static volatile bool bm_async_status_pending;
+
+static bm_async_query_t bm_async_queries[BM_ASYNC_QUERY_DEPTH];
+static volatile uint8_t bm_async_query_head;
+static volatile uint8_t bm_async_query_count;
+
+static enum bm_async_rx_state bm_async_rx_state;
+static uint8_t bm_async_rx_buf[BM_ASYNC_RX_SIZE];
+static uint8_t bm_async_rx_length;
+static uint8_t bm_async_rx_index;
+
+//! The USART (and PDCA) clocks are enabled by the driver
+static bool bm_async_clocked;
+//! The PDCA clock has been enabled by the driver
+static bool bm_async_pdca_owned;
+
+/**
+ * \brief Enable the USART clock, and the PDCA clock if the application has
+ *        disabled it.
+ */
+static void bm_async_clocks_on(void)
+{
+	if (bm_async_clocked) {
+		return;
+	}
+	sysclk_enable_peripheral_clock(BM_USART_USART);
+	if (!(PM->PM_HSBMASK & (1u << SYSCLK_PDCA_HSB))) {
+		sysclk_enable_peripheral_clock(PDCA);
+		bm_async_pdca_owned = true;
+	}
+	bm_async_clocked = true;
+}
+
+/**
+ * \brief Disable the clocks enabled by bm_async_clocks_on() once all frames
+ *        are sent and all queries answered.
+ */
+static void bm_async_clocks_off_if_idle(void)
+{
+	if (!bm_async_clocked || bm_async_tx_active || bm_async_query_count) {
+		return;
+	}
+	if (bm_async_pdca_owned) {
+		sysclk_disable_peripheral_clock(PDCA);
+		bm_async_pdca_owned = false;
+	}
+	sysclk_disable_peripheral_clock(BM_USART_USART);
+	bm_async_clocked = false;
+}
+
+/**
+ * \brief Copy a frame in the transmit buffer. Called with interrupts
+ *        disabled.
+ */
+static bool bm_async_put(const uint8_t *frame, uint16_t length)
+{
+	if (BM_ASYNC_TX_SIZE - bm_async_tx_count < length) {
+		return false;
+	}
+	for (uint16_t i = 0; i < length; i++) {
+		bm_async_tx_buf[bm_async_tx_head] = frame[i];
+		bm_async_tx_head = (bm_async_tx_head + 1) % BM_ASYNC_TX_SIZE;
+	}
+	bm_async_tx_count += length;
+	return true;
+}
+
+/**
+ * \brief Load the next contiguous block of the transmit buffer in the PDCA
+ *        channel. The pending status frame is only queued once the buffer is
+ *        empty, so that all the updates done meanwhile are sent at once.
+ *        When there is nothing left, wait for the last byte to be shifted out.
+ */
+static void bm_async_tx_start(void)
+{
+	uint16_t length;
+
+	if ((bm_async_tx_count == 0) && bm_async_status_pending) {
+		bm_async_put(bm_async_status, BM_ASYNC_STATUS_SIZE);
+		bm_async_status_pending = false;
+	}
+	if (bm_async_tx_count == 0) {
+		bm_async_tx_len = 0;
+		usart_enable_interrupt(BM_USART_USART, US_IER_TXEMPTY);
+		return;
+	}
+	length = BM_ASYNC_TX_SIZE - bm_async_tx_tail;
+	if (length > bm_async_tx_count) {
+		length = bm_async_tx_count;
+	}
+	bm_async_tx_len = length;
+	pdca_channel_write_load(BM_ASYNC_PDCA_TX,
+			&bm_async_tx_buf[bm_async_tx_tail], length);
+	pdca_channel_enable_interrupt(BM_ASYNC_PDCA_TX, PDCA_IER_TRC);
+}
+
+/**
+ * \brief Start the transmitter, or restart it while it waits for TXEMPTY.
+ *        Called with interrupts disabled.
+ */
+static void bm_async_tx_kick(void)
+{
+	if (!bm_async_tx_active) {
+		bm_async_clocks_on();
+		usart_enable_tx(BM_USART_USART);
+		bm_async_tx_active = true;
+		bm_async_tx_start();
+	} else if (bm_async_tx_len == 0) {
+		usart_disable_interrupt(BM_USART_USART, US_IDR_TXEMPTY);
+		bm_async_tx_start();
+	}
+}
+
+/**
+ * \brief PDCA transmit channel callback: a block has been sent.
+ */
+static void bm_async_tx_done(enum pdca_channel_status status)
+{
+	if (status != PDCA_CH_TRANSFER_COMPLETED) {
+		return;
+	}
+	pdca_channel_disable_interrupt(BM_ASYNC_PDCA_TX, PDCA_IDR_TRC);
+
+	bm_async_tx_tail = (bm_async_tx_tail + bm_async_tx_len) % BM_ASYNC_TX_SIZE;
+	bm_async_tx_count -= bm_async_tx_len;
+	bm_async_tx_start();
+}
+
+/**
+ * \brief Stop receiving once no query is outstanding.
+ */
+static void bm_async_rx_stop(void)
+{
+	usart_disable_interrupt(BM_USART_USART, US_IDR_RXRDY | US_IDR_TIMEOUT);
+	usart_disable_rx(BM_USART_USART);
+	bm_async_rx_state = BM_ASYNC_RX_START;
+}
+
+/**
+ * \brief Queue a query frame. The receiver is started with the first
+ *        outstanding query.
+ */
+static bool bm_async_query(const uint8_t *frame, uint16_t length,
+		bm_async_query_t *query)
+{
+	irqflags_t flags;
+	bool queued = false;
+
+	flags = cpu_irq_save();
+	if ((bm_async_query_count < BM_ASYNC_QUERY_DEPTH)
+			&& bm_async_put(frame, length)) {
+		bm_async_queries[(bm_async_query_head + bm_async_query_count)
+				% BM_ASYNC_QUERY_DEPTH] = *query;
+		if (bm_async_query_count++ == 0) {
+			bm_async_clocks_on();
+			usart_reset_status(BM_USART_USART);
+			usart_enable_rx(BM_USART_USART);
+			usart_restart_rx_timeout(BM_USART_USART);
+			usart_enable_interrupt(BM_USART_USART,
+					US_IER_RXRDY | US_IER_TIMEOUT);
+		}
+		bm_async_tx_kick();
+		queued = true;
+	}
+	cpu_irq_restore(flags);
+	return queued;
+}
+
+/**
+ * \brief Pass a complete response frame to the oldest outstanding query.
+ *        Frames which do not answer it are ignored.
+ */
+static void bm_async_rx_frame(void)
+{
+	bm_async_query_t *query = &bm_async_queries[bm_async_query_head];
+	union {
+		uint32_t u32;
+		float f;
+	} current;
+
+	if ((bm_async_query_count == 0)
+			|| (bm_async_rx_buf[0] != query->response)) {
+		return;
+	}
+	bm_async_query_head = (bm_async_query_head + 1) % BM_ASYNC_QUERY_DEPTH;
+	bm_async_query_count--;
+
+	if ((query->response == BM_MCU_RET_CURRENT)
+			&& (bm_async_rx_length == 7)) {
+		current.u32 = ((uint32_t)bm_async_rx_buf[2] << 24)
+				| ((uint32_t)bm_async_rx_buf[3] << 16)
+				| ((uint32_t)bm_async_rx_buf[4] << 8)
+				| bm_async_rx_buf[5];
+		query->current(bm_async_rx_buf[1], current.f);
+	} else if ((query->response == BM_MCU_RET_FIFO_FREE_SIZE)
+			&& (bm_async_rx_length == 4)) {
+		query->fifo_free_size(((uint16_t)bm_async_rx_buf[1] << 8)
+				| bm_async_rx_buf[2]);
+	}
+
+	if (bm_async_query_count) {
+		usart_restart_rx_timeout(BM_USART_USART);
+	} else {
+		bm_async_rx_stop();
+	}
+}
+
+/**
+ * \brief Response parser, fed with each received byte.
+ */
+static void bm_async_rx(uint8_t c)
+{
+	switch (bm_async_rx_state) {
+	case BM_ASYNC_RX_START:
+		// A stop pattern may be received before the start pattern
+		if (c == BM_MSG_START_PATTERN) {
+			bm_async_rx_state = BM_ASYNC_RX_LENGTH;
+		}
+		break;
+	case BM_ASYNC_RX_LENGTH:
+		// The length includes itself and the stop pattern
+		if ((c < 3) || (c - 1 > BM_ASYNC_RX_SIZE)) {
+			bm_async_rx_state = BM_ASYNC_RX_START;
+			break;
+		}
+		bm_async_rx_length = c - 1;
+		bm_async_rx_index = 0;
+		bm_async_rx_state = BM_ASYNC_RX_BODY;
+		break;
+	case BM_ASYNC_RX_BODY:
+		bm_async_rx_buf[bm_async_rx_index++] = c;
+		if (bm_async_rx_index == bm_async_rx_length) {
+			bm_async_rx_state = BM_ASYNC_RX_START;
+			if (c == BM_MSG_STOP_PATTERN) {
+				bm_async_rx_frame();
+			}
+		}
+		break;
+	}
+}
+
+/**
+ * \brief Board monitor USART interrupt: responses, response timeout and end
+ *        of transmission.
+ */
+void USART0_Handler(void)
+{
+	uint32_t status;
+	uint32_t c;
+
+	status = usart_get_status(BM_USART_USART)
+			& usart_get_interrupt_mask(BM_USART_USART);
+
+	if (status & US_CSR_RXRDY) {
+		usart_read(BM_USART_USART, &c);
+		bm_async_rx(c);
+	}
+	if (status & US_CSR_TIMEOUT) {
+		// The board monitor did not answer: drop the outstanding queries
+		usart_start_rx_timeout(BM_USART_USART);
+		bm_async_query_count = 0;
+		bm_async_rx_stop();
+	}
+	if (status & US_CSR_TXEMPTY) {
+		usart_disable_interrupt(BM_USART_USART, US_IDR_TXEMPTY);
+		usart_disable_tx(BM_USART_USART);
+		bm_async_tx_active = false;
+	}
+	bm_async_clocks_off_if_idle();
+}
+
+void bm_async_init(void)
+{
+	const pdca_channel_config_t tx_cfg = {
+		.addr = (void *)bm_async_tx_buf,
+		.pid = BM_ASYNC_PDCA_ID_TX,
+		.size = 0,
+		.transfer_size = PDCA_MR_SIZE_BYTE
+	};
+
+	bm_async_clocks_on();
+	usart_set_rx_timeout(BM_USART_USART, BM_ASYNC_RX_TIMEOUT);
+	pdca_channel_set_config(BM_ASYNC_PDCA_TX, &tx_cfg);
+	pdca_channel_set_callback(BM_ASYNC_PDCA_TX, bm_async_tx_done,
+			PDCA_0_IRQn + BM_ASYNC_PDCA_TX, BM_ASYNC_IRQ_LEVEL, 0);
+	pdca_channel_enable(BM_ASYNC_PDCA_TX);
+	irq_register_handler(BM_ASYNC_USART_IRQn, BM_ASYNC_IRQ_LEVEL);
+	bm_async_clocks_off_if_idle();
+}
+
+void bm_async_send_mcu_status(uint32_t power_scaling, uint32_t sleep_mode,
+		uint32_t cpu_freq, uint32_t cpu_src)
+{
+	irqflags_t flags;
+
+	flags = cpu_irq_save();
+	bm_async_status[0] = BM_MSG_START_PATTERN;
+	bm_async_status[1] = 10 /* length */;
+	bm_async_status[2] = BM_MCU_STATUS;
+	bm_async_status[3] = power_scaling;
+	bm_async_status[4] = sleep_mode;
+	bm_async_status[5] = cpu_freq >> 24;
+	bm_async_status[6] = (cpu_freq >> 16) & 0xff;
+	bm_async_status[7] = (cpu_freq >> 8 ) & 0xff;
+	bm_async_status[8] = cpu_freq & 0xff;
+	bm_async_status[9] = cpu_src;
+	bm_async_status[10] = BM_MSG_STOP_PATTERN;
+	bm_async_status_pending = true;
+	bm_async_tx_kick();
+	cpu_irq_restore(flags);
+}
+
+bool bm_async_print_clear(void)
+{
+	const uint8_t frame[] = {
+		BM_MSG_START_PATTERN, 3 /* length */, BM_PRINT_CLEAR,
+		BM_MSG_STOP_PATTERN
+	};
+	irqflags_t flags;
+	bool queued;
+
+	flags = cpu_irq_save();
+	queued = bm_async_put(frame, sizeof(frame));
+	if (queued) {
+		bm_async_tx_kick();
+	}
+	cpu_irq_restore(flags);
+	return queued;
+}
+
+bool bm_async_print_txt(const uint8_t* str, uint8_t str_length)
+{
+	uint8_t frame[BM_PRINT_TEXT_SIZE + 4];
+	irqflags_t flags;
+	bool queued;
+
+	frame[0] = BM_MSG_START_PATTERN;
+	frame[1] = BM_PRINT_TEXT_SIZE + 3 /* length */;
+	frame[2] = BM_PRINT_TEXT;
+	for (uint8_t i = 0; i < BM_PRINT_TEXT_SIZE; i++) {
+		frame[3 + i] = (i < str_length) ? str[i] : '\0';
+	}
+	frame[BM_PRINT_TEXT_SIZE + 3] = BM_MSG_STOP_PATTERN;
+
+	flags = cpu_irq_save();
+	queued = bm_async_put(frame, sizeof(frame));
+	if (queued) {
+		bm_async_tx_kick();
+	}
+	cpu_irq_restore(flags);
+	return queued;
+}
+
+bool bm_async_get_mcu_current(uint32_t sleep_mode,
+		bm_async_current_callback_t callback)
+{
+	const uint8_t frame[] = {
+		BM_MSG_START_PATTERN, 4 /* length */, BM_MCU_GET_CURRENT,
+		sleep_mode, BM_MSG_STOP_PATTERN
+	};
+	bm_async_query_t query = {
+		.response = BM_MCU_RET_CURRENT,
+		.current = callback,
+	};
+
+	return bm_async_query(frame, sizeof(frame), &query);
+}
+
+bool bm_async_get_fifo_free_size(bm_async_fifo_free_size_callback_t callback)
+{
+	const uint8_t frame[] = {
+		BM_MSG_START_PATTERN, 3 /* length */, BM_MCU_GET_FIFO_FREE_SIZE,
+		BM_MSG_STOP_PATTERN
+	};
+	bm_async_query_t query = {
+		.response = BM_MCU_RET_FIFO_FREE_SIZE,
+		.fifo_free_size = callback,
+	};
+
+	return bm_async_query(frame, sizeof(frame), &query);
+}
+
+bool bm_async_is_idle(void)
+{
+	return !bm_async_tx_active && !bm_async_status_pending
+			&& (bm_async_query_count == 0);
+}
+
+void bm_async_flush(void)
+{
+	/*
+	 * Check for completion with interrupts disabled: the interrupt ending
+	 * the transfer still wakes up the CPU from the sleep mode.
+	 */
+	while (1) {
+		cpu_irq_disable();
+		if (bm_async_is_idle()) {
+			cpu_irq_enable();
+			break;
+		}
+		sleepmgr_sleep(SLEEPMGR_SLEEP_0);
+	}
+}
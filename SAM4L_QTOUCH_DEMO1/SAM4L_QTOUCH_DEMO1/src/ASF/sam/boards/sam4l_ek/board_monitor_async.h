@@ -0,0 +1,182 @@
+/**
+ * \file
+ *
+ * \brief SAM4L-EK Board Monitor Control, asynchronous interface.
+ *
+ * Copyright (c) 2012 - 2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+#ifndef BOARD_MONITOR_ASYNC_H_INCLUDED
+#define BOARD_MONITOR_ASYNC_H_INCLUDED
+
+#include "board_monitor.h"
+
+/**
+ * \defgroup board_monitor_async Asynchronous Board Monitor interface
+ *
+ * Frames are queued in a transmit buffer and sent by a PDCA channel, so the
+ * caller never waits for the USART. The USART and PDCA clocks only run while
+ * frames are sent or responses are expected.
+ *
+ * - MCU status updates are coalesced: only the latest status is sent, once
+ *   the frames queued before it are out.
+ * - Queries are pipelined: several requests may be outstanding, and each
+ *   response is passed to the callback of its request, in interrupt context.
+ *
+ * Do not mix this interface with the blocking bm_* functions once
+ * bm_async_init() has been called.
+ *
+ * @{
+ */
+
+//! PDCA channel used to transmit the frames
+#ifndef BM_ASYNC_PDCA_TX
+#define BM_ASYNC_PDCA_TX                    4
+#endif
+
+//! Interrupt priority of the PDCA channel and of the USART
+#ifndef BM_ASYNC_IRQ_LEVEL
+#define BM_ASYNC_IRQ_LEVEL                  2
+#endif
+
+//! Size of the transmit buffer, in bytes
+#ifndef BM_ASYNC_TX_SIZE
+#define BM_ASYNC_TX_SIZE                    128
+#endif
+
+//! Maximum number of outstanding queries
+#ifndef BM_ASYNC_QUERY_DEPTH
+#define BM_ASYNC_QUERY_DEPTH                4
+#endif
+
+/**
+ * Time allowed to the board monitor to answer, in bit periods (1.1s at
+ * 115200 bauds). Outstanding queries are dropped once it expires.
+ */
+#ifndef BM_ASYNC_RX_TIMEOUT
+#define BM_ASYNC_RX_TIMEOUT                 0x1ffff
+#endif
+
+/**
+ * \brief Current consumption callback, called from the USART interrupt.
+ *
+ * \param sleep_mode Sleep mode the current has been measured in.
+ * \param current Current measured.
+ */
+typedef void (*bm_async_current_callback_t)(uint32_t sleep_mode,
+		float current);
+
+/**
+ * \brief Board monitor command fifo free size callback, called from the
+ *        USART interrupt.
+ *
+ * \param free_size free size in byte.
+ */
+typedef void (*bm_async_fifo_free_size_callback_t)(uint16_t free_size);
+
+/**
+ * \brief Configure the PDCA channel and the USART interrupt. bm_init() must
+ *        have been called before.
+ */
+void bm_async_init(void);
+
+/**
+ * \brief Update the MCU power saving information displayed by the board
+ *        monitor. Updates are coalesced until the status frame is sent.
+ *
+ * \param power_scaling Power scaling.
+ * \param sleep_mode Sleep mode.
+ * \param cpu_freq CPU frequency.
+ * \param cpu_src CPU source clock.
+ */
+void bm_async_send_mcu_status(uint32_t power_scaling, uint32_t sleep_mode,
+		uint32_t cpu_freq, uint32_t cpu_src);
+
+/**
+ * \brief Queue a Clear Print Text Area command.
+ *
+ * \return false if the transmit buffer is full.
+ */
+bool bm_async_print_clear(void);
+
+/**
+ * \brief Queue a Print Text command.
+ *
+ * \param str String pattern, copied in the transmit buffer.
+ * \param str_length String length pattern.
+ *
+ * \return false if the transmit buffer is full.
+ */
+bool bm_async_print_txt(const uint8_t* str, uint8_t str_length);
+
+/**
+ * \brief Request the current consumption measured.
+ *
+ * \param sleep_mode Sleep Mode Desired.
+ * \param callback Called with the current measured.
+ *
+ * \return false if too many queries are outstanding or the transmit buffer is
+ *         full.
+ */
+bool bm_async_get_mcu_current(uint32_t sleep_mode,
+		bm_async_current_callback_t callback);
+
+/**
+ * \brief Request the free size (in byte) of the board monitor command fifo.
+ *
+ * \param callback Called with the free size.
+ *
+ * \return false if too many queries are outstanding or the transmit buffer is
+ *         full.
+ */
+bool bm_async_get_fifo_free_size(bm_async_fifo_free_size_callback_t callback);
+
+/**
+ * \brief Check whether all frames are sent and all queries answered.
+ */
+bool bm_async_is_idle(void);
+
+/**
+ * \brief Sleep until all frames are sent and all queries answered, e.g.
+ *        before entering a sleep mode whose current is measured.
+ */
+void bm_async_flush(void);
+
+//! @}
+
+#endif  // BOARD_MONITOR_ASYNC_H_INCLUDED
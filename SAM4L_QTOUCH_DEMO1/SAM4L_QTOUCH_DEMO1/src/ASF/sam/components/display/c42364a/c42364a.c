@@ -166,6 +166,7 @@ void c42364a_show_battery(enum c42364a_battery_value val)
 void c42364a_show_numeric_dec(int32_t value)
 {
 	uint8_t lcd_num[5];
+	int8_t i;
 
 	Assert(value > -20000);
 	Assert(value < 20000);
@@ -187,7 +188,12 @@ void c42364a_show_numeric_dec(int32_t value)
 		lcdca_clear_pixel(C42364A_ICON_MINUS_SEG2);
 	}
 
-	sprintf((char*)lcd_num, "%4d", (int)value);
+	/* Right aligned digits, without the cost of sprintf(). */
+	lcd_num[4] = '\0';
+	for (i = 3; i >= 0; i--) {
+		lcd_num[i] = (value || i == 3) ? '0' + value % 10 : ' ';
+		value /= 10;
+	}
 
 	c42364a_write_num_packet((uint8_t const*)&lcd_num);
 }
@@ -210,3 +216,20 @@ void c42364a_text_scrolling_start(const uint8_t *data, uint32_t length)
 	lcdca_automated_char_start(data, length);
 }
 
+void c42364a_text_sequential_start(const uint8_t *data, uint32_t nb_texts)
+{
+	/* Settings of automated display */
+	struct lcdca_automated_char_config automated_char_config;
+
+	automated_char_config.automated_mode = LCDCA_AUTOMATED_MODE_SEQUENTIAL;
+	automated_char_config.automated_timer =
+			CONF_C42364A_TEXT_SEQUENTIAL_TIMER;
+	automated_char_config.lcd_tdg = LCDCA_TDG_14SEG4COM;
+	automated_char_config.stseg = C42364A_FIRST_14SEG_4C;
+	automated_char_config.dign = C42364A_WIDTH_14SEG_4C;
+	/* STEPS is only used in scrolling mode */
+	automated_char_config.steps = 0;
+	automated_char_config.dir_reverse = LCDCA_AUTOMATED_DIR_REVERSE;
+	lcdca_automated_char_set_config(&automated_char_config);
+	lcdca_automated_char_start(data, nb_texts * C42364A_WIDTH_14SEG_4C);
+}
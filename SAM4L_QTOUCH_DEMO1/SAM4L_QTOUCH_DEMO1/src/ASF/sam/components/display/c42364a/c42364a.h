@@ -295,6 +295,16 @@ static inline void c42364a_text_scrolling_stop(void)
 	lcdca_automated_char_stop();
 }
 
+/**
+ * \brief Text sequence stop.
+ *
+ * This function stop the text sequence.
+ */
+static inline void c42364a_text_sequential_stop(void)
+{
+	lcdca_automated_char_stop();
+}
+
 /** @} */
 
 /**
@@ -406,6 +416,19 @@ void c42364a_show_numeric_dec(int32_t value);
  */
 void c42364a_text_scrolling_start(const uint8_t *data, uint32_t length);
 
+/**
+ * \brief Text sequence start.
+ *
+ * This function start the display of a sequence of texts on the alphanumeric
+ * field: each text is C42364A_WIDTH_14SEG_4C characters long, and the next one
+ * is shown at each CONF_C42364A_TEXT_SEQUENTIAL_TIMER event.
+ *
+ * \param data Texts buffer, read in loop by the PDCA: its content may be
+ * changed while the sequence runs.
+ * \param nb_texts Number of texts in the buffer.
+ */
+void c42364a_text_sequential_start(const uint8_t *data, uint32_t nb_texts);
+
 /** @} */
 
 
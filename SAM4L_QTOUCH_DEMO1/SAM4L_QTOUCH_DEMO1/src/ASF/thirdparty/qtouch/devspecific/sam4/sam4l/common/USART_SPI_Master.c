@@ -0,0 +1,222 @@
+/* This source file is part of the ATMEL QTouch Library Release 5.1 */
+
+/**
+ * \file
+ *
+ * \brief  This file contains the USART SPI public API that can be used to
+ * transfer data from a Touch Device to QTouch Studio using the QT600
+ * USB Bridge.
+ * - Userguide:          QTouch Library User Guide - doc8207.pdf.
+ * - Support email:      touch@atmel.com
+ *
+ * Copyright (c) 2012 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ *
+ */
+/*============================ INCLUDES ======================================*/
+#include "asf.h"
+#include <string.h>
+
+#include "USART_SPI_Master.h"
+#include "QDebugSettings.h"
+#include "QDebugTransport.h"
+
+//! compile file only when QDebug is enabled.
+#if (DEF_TOUCH_QDEBUG_ENABLE == 1) && (defined QDEBUG_USART_SPI)
+
+/*============================ GLOBAL VARIABLES ==============================*/
+//! Messages waiting to be sent, the one at QueueHead is being sent.
+static uint8_t Queue[QDEBUG_USART_SPI_QUEUE][TX_BUFFER_SIZE];
+static uint16_t QueueLength[QDEBUG_USART_SPI_QUEUE];
+static volatile uint8_t QueueHead;
+static volatile uint8_t QueueCount;
+
+//! Bytes clocked in during the current transfer.
+static uint8_t RxData[TX_BUFFER_SIZE];
+static uint16_t RxLength;
+
+//! Dummy bytes clocked out to complete a received frame.
+static const uint8_t PollData[QDEBUG_USART_SPI_POLL_SIZE];
+
+/*============================ IMPLEMENTATION ================================*/
+
+/*============================================================================
+Name    :   USART_SPI_Start
+------------------------------------------------------------------------------
+Purpose :   Start a full duplex PDCA transfer
+Input   :   Data to send and its length
+Output  :   n/a
+Notes   :	The receive channel is loaded first, so no byte is missed.
+============================================================================*/
+static void USART_SPI_Start(const uint8_t *data, uint16_t length)
+{
+    RxLength = length;
+    pdca_channel_write_load(QDEBUG_USART_SPI_PDCA_RX, RxData, length);
+    pdca_channel_enable_interrupt(QDEBUG_USART_SPI_PDCA_RX, PDCA_IER_TRC);
+    pdca_channel_write_load(QDEBUG_USART_SPI_PDCA_TX, (void *)data, length);
+}
+
+/*============================================================================
+Name    :   USART_SPI_Transfer_Done
+------------------------------------------------------------------------------
+Purpose :   PDCA receive channel callback
+Input   :   Channel status
+Output  :   n/a
+Notes   :	Feeds the received bytes to RxHandler. While a frame from
+            QTouch Studio is incomplete, dummy bytes are clocked to receive
+            the rest, as BitBangSPI_Send_Message does. Then the next queued
+            message is started.
+============================================================================*/
+static void USART_SPI_Transfer_Done(enum pdca_channel_status status)
+{
+    uint16_t i;
+    uint8_t FrameInProgress = 0;
+
+    if (status != PDCA_CH_TRANSFER_COMPLETED)
+        return;
+
+    pdca_channel_disable_interrupt(QDEBUG_USART_SPI_PDCA_RX, PDCA_IDR_TRC);
+
+    for (i = 0; i < RxLength; i++)
+        FrameInProgress = RxHandler(RxData[i]);
+
+    if (FrameInProgress)
+    {
+        USART_SPI_Start(PollData, sizeof(PollData));
+        return;
+    }
+
+    QueueHead = (QueueHead + 1) % QDEBUG_USART_SPI_QUEUE;
+    QueueCount--;
+    if (QueueCount != 0)
+        USART_SPI_Start(Queue[QueueHead], QueueLength[QueueHead]);
+}
+
+/*============================================================================
+Name    :   USART_SPI_Master_Init
+------------------------------------------------------------------------------
+Purpose :   Initialize the USART in SPI master mode and its PDCA channels
+Input   :   n/a
+Output  :   n/a
+Notes   :	Called from QDebug_Init in QDebug_sam4l.c
+============================================================================*/
+void USART_SPI_Master_Init (void)
+{
+    const usart_spi_opt_t usart_opt = {
+        .baudrate = QDEBUG_USART_SPI_BAUDRATE,
+        .char_length = US_MR_CHRL_8_BIT,
+        .spi_mode = SPI_MODE_0,
+        .channel_mode = US_MR_CHMODE_NORMAL
+    };
+    const pdca_channel_config_t tx_cfg = {
+        .addr = (void *)PollData,
+        .pid = QDEBUG_USART_SPI_PDCA_ID_TX,
+        .size = 0,
+        .transfer_size = PDCA_MR_SIZE_BYTE
+    };
+    const pdca_channel_config_t rx_cfg = {
+        .addr = (void *)RxData,
+        .pid = QDEBUG_USART_SPI_PDCA_ID_RX,
+        .size = 0,
+        .transfer_size = PDCA_MR_SIZE_BYTE
+    };
+
+    QueueHead = 0;
+    QueueCount = 0;
+
+    ioport_set_pin_mode(QDEBUG_USART_SPI_SS_PIN, QDEBUG_USART_SPI_SS_MUX);
+    ioport_disable_pin(QDEBUG_USART_SPI_SS_PIN);
+    ioport_set_pin_mode(QDEBUG_USART_SPI_SCK_PIN, QDEBUG_USART_SPI_SCK_MUX);
+    ioport_disable_pin(QDEBUG_USART_SPI_SCK_PIN);
+    ioport_set_pin_mode(QDEBUG_USART_SPI_MOSI_PIN, QDEBUG_USART_SPI_MOSI_MUX);
+    ioport_disable_pin(QDEBUG_USART_SPI_MOSI_PIN);
+    ioport_set_pin_mode(QDEBUG_USART_SPI_MISO_PIN, QDEBUG_USART_SPI_MISO_MUX);
+    ioport_disable_pin(QDEBUG_USART_SPI_MISO_PIN);
+
+    sysclk_enable_peripheral_clock(QDEBUG_USART_SPI_USART);
+    usart_init_spi_master(QDEBUG_USART_SPI_USART, &usart_opt,
+            sysclk_get_pba_hz());
+    usart_enable_tx(QDEBUG_USART_SPI_USART);
+    usart_enable_rx(QDEBUG_USART_SPI_USART);
+
+    // Keep the bridge selected, as the BitBangSPI interface does.
+    usart_spi_force_chip_select(QDEBUG_USART_SPI_USART);
+
+    pdca_enable(PDCA);
+    pdca_channel_set_config(QDEBUG_USART_SPI_PDCA_TX, &tx_cfg);
+    pdca_channel_set_config(QDEBUG_USART_SPI_PDCA_RX, &rx_cfg);
+    pdca_channel_set_callback(QDEBUG_USART_SPI_PDCA_RX,
+            USART_SPI_Transfer_Done,
+            PDCA_0_IRQn + QDEBUG_USART_SPI_PDCA_RX, 1, 0);
+    pdca_channel_enable(QDEBUG_USART_SPI_PDCA_RX);
+    pdca_channel_enable(QDEBUG_USART_SPI_PDCA_TX);
+}
+
+/*============================================================================
+Name    :   USART_SPI_Send_Message
+------------------------------------------------------------------------------
+Purpose :   Queue one frame for sending
+Input   :   n/a
+Output  :   n/a
+Notes   :	Called from Send_Message in QDebugTransport.c. Copies TX_Buffer
+            and returns, the PDCA sends it and the received bytes are
+            handled from its interrupt. Only waits if all queue entries are
+            taken.
+============================================================================*/
+void USART_SPI_Send_Message(void)
+{
+    irqflags_t flags;
+    uint16_t length = TX_index + 1;
+    uint8_t slot;
+
+    while (QueueCount == QDEBUG_USART_SPI_QUEUE)
+        ;
+
+    flags = cpu_irq_save();
+    slot = (QueueHead + QueueCount) % QDEBUG_USART_SPI_QUEUE;
+    cpu_irq_restore(flags);
+
+    // The slot is not used by the interrupt until it is counted.
+    memcpy(Queue[slot], TX_Buffer, length);
+    QueueLength[slot] = length;
+
+    flags = cpu_irq_save();
+    if (QueueCount++ == 0)
+        USART_SPI_Start(Queue[slot], length);
+    cpu_irq_restore(flags);
+}
+
+#endif  //(DEF_TOUCH_QDEBUG_ENABLE == 1) && (defined QDEBUG_USART_SPI)
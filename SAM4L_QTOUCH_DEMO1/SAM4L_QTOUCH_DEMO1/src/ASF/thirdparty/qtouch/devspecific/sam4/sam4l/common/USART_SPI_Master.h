@@ -0,0 +1,69 @@
+/* This source file is part of the ATMEL QTouch Library Release 5.1 */
+
+/**
+ * \file
+ *
+ * \brief  This file contains the USART SPI public API that can be used to
+ * transfer data from a Touch Device to QTouch Studio using the QT600
+ * USB Bridge.
+ * - Userguide:          QTouch Library User Guide - doc8207.pdf.
+ * - Support email:      touch@atmel.com
+ *
+ * Copyright (c) 2012 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ *
+ */
+#ifndef USART_SPI_MASTER_H_INCLUDED
+#define USART_SPI_MASTER_H_INCLUDED
+
+/*============================ PROTOTYPES ====================================*/
+void USART_SPI_Master_Init (void);
+void USART_SPI_Send_Message(void);
+
+/*============================ MACROS ========================================*/
+//! Messages that can be queued while a previous one is still sent.
+#ifndef QDEBUG_USART_SPI_QUEUE
+#define QDEBUG_USART_SPI_QUEUE      4
+#endif
+
+//! Dummy bytes clocked per transfer while a received frame is incomplete.
+#ifndef QDEBUG_USART_SPI_POLL_SIZE
+#define QDEBUG_USART_SPI_POLL_SIZE  8
+#endif
+
+#endif
+
+/* EOF */
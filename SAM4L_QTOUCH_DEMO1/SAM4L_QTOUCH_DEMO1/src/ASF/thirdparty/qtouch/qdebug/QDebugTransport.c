@@ -82,6 +82,8 @@
 #include "SERIAL.h"
 #elif defined(QDEBUG_SPI_BB)
 #include "BitBangSPI_Master.h"
+#elif defined(QDEBUG_USART_SPI)
+#include "USART_SPI_Master.h"
 #else
 #warning "No Debug Interface is selected in QDebugSettings.h"
 #endif
@@ -180,6 +182,8 @@ Send_Message (void)
   SERIAL_Send_Message ();
 #elif defined(QDEBUG_SPI_BB)
   BitBangSPI_Send_Message ();
+#elif defined(QDEBUG_USART_SPI)
+  USART_SPI_Send_Message ();
 #endif
 
   // Ready for next message
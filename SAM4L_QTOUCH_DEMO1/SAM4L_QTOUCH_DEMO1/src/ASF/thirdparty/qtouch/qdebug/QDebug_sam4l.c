@@ -65,6 +65,8 @@
 #include "SERIAL.h"
 #elif (defined QDEBUG_BITBANG_SPI)
 #include "BitBangSPI_Master.h"
+#elif (defined QDEBUG_USART_SPI)
+#include "USART_SPI_Master.h"
 #else
 #warning "No Debug Interface is selected in QDebugSettings.h"
 #endif
@@ -117,6 +119,8 @@ static bool transmit_dummy = true;
 static bool transmit_dummy = false;
 #elif (defined QDEBUG_BITBANG_SPI)
 static bool transmit_dummy = true;
+#elif (defined QDEBUG_USART_SPI)
+static bool transmit_dummy = true;
 #else
 #endif
 
@@ -137,6 +141,8 @@ QDebug_Init (void)
   SERIAL_Init ();
 #elif (defined QDEBUG_BITBANG_SPI)
   BitBangSPI_Master_Init ();
+#elif (defined QDEBUG_USART_SPI)
+  USART_SPI_Master_Init ();
 #endif
 
   touch_ret = QDEBUG_GET_LIBINFO_FUNC (&QDEBUG_LIBINFO);
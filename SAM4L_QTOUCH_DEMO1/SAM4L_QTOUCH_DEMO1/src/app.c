@@ -87,11 +87,13 @@ void app_init(void)
 void app_init_lowpower(void)
 {
 
-	// Stop LCD Controller
+	// Stop LCD text sequence and LCD Controller
+	ui_lcd_stop();
 	lcdca_disable();
 
 	// Stop QTouch Initialization
 	touch_sensors_deinit();
+	event_task_suspend(EVENT_TASK_QTOUCH);
 
 	// Initialize board features
 	board_init();
@@ -99,6 +101,9 @@ void app_init_lowpower(void)
 	// Clear LCD backlight
 	ioport_set_pin_level(LCD_BL_GPIO, IOPORT_PIN_LEVEL_LOW);
 
+	// Let the board monitor frames in flight leave before the PDCA stops
+	bm_async_flush();
+
 	// Disable the peripheral that we do not use anymore
 	sysclk_disable_peripheral_clock(CATB);
 	sysclk_disable_peripheral_clock(PDCA);
@@ -187,3 +192,40 @@ void app_enter_sleep_mode(sleep_mode_t sleep_mode)
 	sleepmgr_sleep(current_sleep_mode);
 }
 
+#ifdef EVENT_QTOUCH_AT_WAKEUP
+/**
+ * \brief Sleep with only the autonomous touch sensor armed, until it detects
+ * a touch or PB0 is pressed. The average current measured by the board
+ * monitor during the sleep is then reported.
+ */
+void app_qtouch_at_sleep(void)
+{
+	sleep_mode_t sleep_mode = EVENT_QTOUCH_AT_SLEEP_MODE;
+
+	ui_set_sleep_mode_mcu_status(sleep_mode);
+	ui_bm_send_mcu_status();
+	// Keep the board monitor traffic out of the measured sleep
+	bm_async_flush();
+
+	event_qtouch_at_arm();
+	while (1) {
+		/*
+		 * Check the wakeup condition with interrupts disabled: an interrupt
+		 * pending at this point still wakes up the CPU from the sleep mode.
+		 */
+		event_task_checkin(EVENT_TASK_MAIN);
+		event_wdt_service();
+		cpu_irq_disable();
+		if (event_qtouch_at_is_woken()) {
+			cpu_irq_enable();
+			break;
+		}
+		app_enter_sleep_mode(sleep_mode);
+	}
+	event_qtouch_at_disarm();
+
+	ui_set_sleep_mode_mcu_status(SLEEP_MODE_RUN);
+	ui_bm_send_mcu_status();
+	ui_bm_report_current(sleep_mode);
+}
+#endif
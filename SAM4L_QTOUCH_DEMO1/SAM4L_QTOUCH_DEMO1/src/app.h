@@ -63,5 +63,8 @@ void app_init_lowpower(void);
 void app_prime_number_run(void);
 void app_switch_power_scaling(power_scaling_t power_scaling);
 void app_enter_sleep_mode(sleep_mode_t sleep_mode);
+#ifdef EVENT_QTOUCH_AT_WAKEUP
+void app_qtouch_at_sleep(void);
+#endif
 
 #endif  // _APP_H
@@ -62,8 +62,8 @@
 #define CONF_C42364A_CLKDIV  7
 /** Frame count 0 configuration. */
 #define CONF_C42364A_FC0     2
-/** Frame count 1 configuration. */
-#define CONF_C42364A_FC1     2
+/** Frame count 1 configuration, slowest rate for the text sequence. */
+#define CONF_C42364A_FC1     31
 /** Frame count 1 configuration. */
 #define CONF_C42364A_FC2     1
 /** @} */
@@ -77,4 +77,7 @@
 /** Text scrolling configuration. */
 #define CONF_C42364A_TEXT_SCROLLING_TIMER        LCDCA_TIMER_FC0
 
+/** Text sequence configuration. */
+#define CONF_C42364A_TEXT_SEQUENTIAL_TIMER       LCDCA_TIMER_FC1
+
 #endif /* CONF_C42364A_H_INCLUDED */
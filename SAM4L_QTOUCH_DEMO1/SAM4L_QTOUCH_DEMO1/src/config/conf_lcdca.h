@@ -48,4 +48,10 @@
 /** Source Clock of LCD Controller */
 #define CONF_LCDCA_SOURCE_CLK  OSC_ID_OSC32
 
+/**
+ * PDCA channel of the automated character modes: channels 0 to 4 are used by
+ * QTouch, QDebug and the board monitor.
+ */
+#define LCDCA_AUTOMATED_CHAR_DMA_CH  5
+
 #endif /* CONF_LCDCA_H_INCLUDED */
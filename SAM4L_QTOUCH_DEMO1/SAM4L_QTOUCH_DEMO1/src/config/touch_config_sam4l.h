@@ -93,6 +93,14 @@ extern "C"
 #if DEF_TOUCH_QDEBUG_ENABLE == 1
 #define _DEBUG_INTERFACE_
 #endif
+
+/**
+ * Enable/Disable the touch post-processing (touch_post.c): key debounce,
+ * slider position smoothing and gesture detection on each measurement.
+ *  When 1, the application reads the post-processed key and slider states.
+ *  When 0, the application reads the QTouch Library states directly.
+ */
+#define DEF_TOUCH_POST_PROCESSING       (1)
 /*----------------------------------------------------------------------------
                 QTouch Pin Configuration Options.
 ----------------------------------------------------------------------------*/
@@ -44,12 +44,129 @@
 
 // Internal counter for the QTouch library
 volatile uint32_t event_qtouch_sensors_idle_count = 0u;
-// Push button PB0 event
-volatile bool event_pbEvent = false;
 // Boolean value to detect if the QTouch button is pressed or not
 bool event_qTouchButtonPressed = false;
 
-static void wdt_clear(void);
+#if DEF_TOUCH_POST_PROCESSING == 1
+extern touch_post_t touch_post;
+extern uint8_t touch_post_events;
+#endif
+
+// AST periodic interrupt while measuring: 2^(9+1) / 32768Hz = 31.25ms
+#define EVENT_AST_PER_MEASURE         9
+// AST counter prescaler, used as event timestamp: 32768Hz / 2^(4+1) = 1024Hz
+#define EVENT_AST_PSEL_TIMESTAMP      4
+
+// Events queued per source, power of 2
+#define EVENT_QUEUE_SIZE              8u
+
+/*
+ * Event queue: a single interrupt handler produces the events of a queue,
+ * and the application alone consumes them, so that the queue needs no lock.
+ * The producer only writes head, the consumer only writes tail.
+ */
+typedef struct {
+	event_t events[EVENT_QUEUE_SIZE];
+	volatile uint8_t head;
+	volatile uint8_t tail;
+	// Events lost on a full queue, written by the producer
+	volatile uint8_t dropped;
+} event_queue_t;
+
+// PB0 push button events, from the EIC handler
+static event_queue_t event_queue_button;
+// Autonomous QTouch status changes, from the CATB handler
+static event_queue_t event_queue_touch;
+// QTouch measurement ticks, from the AST handler
+static event_queue_t event_queue_tick;
+
+static event_queue_t *const event_queues[] = {
+	&event_queue_button,
+	&event_queue_touch,
+	&event_queue_tick,
+};
+
+// Tasks monitored by the watchdog supervisor
+static uint8_t event_task_monitored = 0u;
+// Monitored tasks checked in since the last watchdog clear
+static uint8_t event_task_alive = 0u;
+
+#ifdef EVENT_QTOUCH_ADAPTIVE_PERIOD
+// AST periodic interrupt while a sensor is in detect: 15.6ms
+#define EVENT_AST_PER_FAST            8
+// Slowest AST periodic interrupt when idle: 250ms
+#define EVENT_AST_PER_IDLE            12
+// Idle AST periods before the period is doubled
+#define EVENT_QTOUCH_BACKOFF_PERIODS  4u
+
+// Current AST periodic interrupt value
+static uint8_t event_ast_per = EVENT_AST_PER_MEASURE;
+// AST period count at the last period update
+static uint32_t event_qtouch_update_count = 0u;
+// Idle AST periods at the current period
+static uint8_t event_qtouch_idle_periods = 0u;
+// Slider position at the last period update
+static uint8_t event_qtouch_slider_position = 0u;
+#endif
+
+#ifdef EVENT_QTOUCH_AT_WAKEUP
+// AST periodic interrupt while asleep: 1s, only needed to keep clearing the
+// watchdog. It is enabled as a wakeup source for the deep sleep modes.
+#define EVENT_AST_PER_SLEEP           14
+// AST periods without any sensor in detect before the burst ends
+#define EVENT_QTOUCH_RELEASE_PERIODS  8u
+
+// Autonomous touch status, reported to QDebug
+extern volatile int8_t autonomous_qtouch_in_touch;
+// AST period count at the last measurement with a sensor in detect
+static uint32_t event_qtouch_touch_count = 0u;
+#endif
+
+/**
+ *  \brief Queue an event, from the producer interrupt handler of the queue.
+ *  The event is dropped if the queue is full.
+ */
+static void event_queue_put(event_queue_t *queue, event_type_t type)
+{
+	uint8_t head = queue->head;
+	event_t *event;
+
+	if ((uint8_t)(head - queue->tail) >= EVENT_QUEUE_SIZE) {
+		queue->dropped++;
+		return;
+	}
+	event = &queue->events[head & (EVENT_QUEUE_SIZE - 1)];
+	event->type = type;
+	event->time = ast_read_counter_value(AST);
+	// Publish the event once written
+	__DMB();
+	queue->head = head + 1;
+}
+
+/**
+ *  \brief Return the oldest event of a queue without removing it, NULL if
+ *  the queue is empty.
+ */
+static event_t *event_queue_peek(event_queue_t *queue)
+{
+	uint8_t tail = queue->tail;
+
+	if (tail == queue->head) {
+		return NULL;
+	}
+	// Read the event only after seeing it published
+	__DMB();
+	return &queue->events[tail & (EVENT_QUEUE_SIZE - 1)];
+}
+
+/**
+ *  \brief Remove the oldest event of a queue, once read.
+ */
+static void event_queue_pop(event_queue_t *queue)
+{
+	__DMB();
+	queue->tail++;
+}
 
 /**
  *  \brief Asynchronous timer (ASF) handler for the QTouch acquisition.
@@ -59,23 +176,33 @@ static void ast_per_callback(void)
 {
 	touch_sensors_update_time();
 	event_qtouch_sensors_idle_count++;
+	event_queue_put(&event_queue_tick, EVENT_TICK);
 	ast_clear_interrupt_flag(AST, AST_INTERRUPT_PER);
-	wdt_clear();
 }
 
+#if defined(EVENT_QTOUCH_ADAPTIVE_PERIOD) || defined(EVENT_QTOUCH_AT_WAKEUP)
+/**
+ *  \brief Program the AST periodic interrupt, which paces the QTouch
+ *  measurements, and the matching QTouch library time step.
+ *  \param per AST periodic value: the period is 2^(per+1) / 32768Hz.
+ */
+static void event_ast_set_period(uint8_t per)
+{
+	ast_write_periodic0_value(AST, per);
+	touch_qt_time.measurement_period_ms = 1000u >> (14 - per);
+}
+#endif
+
 /**
  *  \brief External interrupt handler, used by PB0 push button
  */
 static void eic5_callback(void)
 {
-	sysclk_enable_peripheral_clock(EIC);
-	
 	if(eic_line_interrupt_is_pending(EIC,GPIO_PUSH_BUTTON_EIC_LINE))
 	{
 		eic_line_clear_interrupt(EIC,GPIO_PUSH_BUTTON_EIC_LINE);
-		event_pbEvent = true;
+		event_queue_put(&event_queue_button, EVENT_PUSH_BUTTON);
 	}
-	sysclk_disable_peripheral_clock(EIC);
 }
 
 /**
@@ -88,13 +215,17 @@ static void wdt_set_ctrl(uint32_t ctrl)
 }
 
 /**
- *  \brief Clear WDT
+ *  \brief Clear WDT, unless the previous clear is still being synchronized
+ *  \return true if the WDT has been cleared.
  */
-static void wdt_clear(void)
+static bool wdt_clear(void)
 {
-	while (!(WDT->WDT_SR & WDT_SR_CLEARED));
-	WDT->WDT_CTRL = WDT_CLR_WDTCLR | WDT_CLR_KEY((uint32_t)0x55);
-	WDT->WDT_CTRL = WDT_CLR_WDTCLR | WDT_CLR_KEY((uint32_t)0xAA);
+	if (!(WDT->WDT_SR & WDT_SR_CLEARED)) {
+		return false;
+	}
+	WDT->WDT_CLR = WDT_CLR_WDTCLR | WDT_CLR_KEY((uint32_t)0x55);
+	WDT->WDT_CLR = WDT_CLR_WDTCLR | WDT_CLR_KEY((uint32_t)0xAA);
+	return true;
 }
 
 /**
@@ -120,12 +251,12 @@ void event_qtouch_init(void)
 
 	ast_conf.mode = AST_COUNTER_MODE;
 	ast_conf.osc_type = AST_OSC_32KHZ;
-	ast_conf.psel = AST_PSEL_32KHZ_1HZ;
+	ast_conf.psel = EVENT_AST_PSEL_TIMESTAMP;
 	ast_conf.counter = 0;
 	ast_set_config(AST, &ast_conf);
 
 	ast_clear_interrupt_flag(AST, AST_INTERRUPT_PER);
-	ast_write_periodic0_value(AST, 9);
+	ast_write_periodic0_value(AST, EVENT_AST_PER_MEASURE);
 
 	ast_set_callback(AST, AST_INTERRUPT_PER, ast_per_callback,
 		AST_PER_IRQn, 0);
@@ -180,9 +311,7 @@ void event_button_init(void)
 	bpm_disable_io_retention(BPM);
 	bpm_enable_io_retention(BPM);
 	bpm_enable_fast_wakeup(BPM);
-	sysclk_disable_peripheral_clock(EIC);
-
-	event_pbEvent = false;
+	// The EIC clock is left enabled for the interrupt handler.
 
 	// Initialize WDT Controller
 	sysclk_enable_peripheral_clock(WDT);
@@ -196,6 +325,14 @@ bool event_qtouch_get_slider_state( uint8_t* event_qtouch_position )
 {
 	bool event_qtouch_slider_state = false;
 
+#if DEF_TOUCH_POST_PROCESSING == 1
+	// Use the debounced state and smoothed position.
+	if (touch_post.slider) {
+		*event_qtouch_position = touch_post_get_position(&touch_post);
+		*event_qtouch_position = 255 - *event_qtouch_position;
+		event_qtouch_slider_state = true;
+	}
+#else
 	// Use Rotor/Slider Position.
 	if (GET_QT_SENSOR_STATE(1) || GET_QT_SENSOR_STATE(2) 
 		|| GET_QT_SENSOR_STATE(3) ) {
@@ -206,6 +343,7 @@ bool event_qtouch_get_slider_state( uint8_t* event_qtouch_position )
 	else {
 		event_qtouch_slider_state = false;
 	}
+#endif
 
 	return event_qtouch_slider_state;
 }
@@ -217,6 +355,13 @@ bool event_qtouch_get_button_state(void)
 {
 	bool event_qtouch_button_state = false;
 
+#if DEF_TOUCH_POST_PROCESSING == 1
+	// The button acts on the debounced key release.
+	if (touch_post_events & TOUCH_POST_EVENT_KEY_RELEASE) {
+		touch_post_events &= ~TOUCH_POST_EVENT_KEY_RELEASE;
+		event_qtouch_button_state = true;
+	}
+#else
 	// Use QTouch button status
 	if (GET_QT_SENSOR_STATE(0)&&(event_qTouchButtonPressed==false)) {
 		event_qTouchButtonPressed = true;
@@ -226,18 +371,256 @@ bool event_qtouch_get_button_state(void)
 		event_qTouchButtonPressed = false;
 		event_qtouch_button_state = true;
 	}
+#endif
 	return event_qtouch_button_state;
 }
 
 /** 
- * \brief Check if push button is pressed or not.
+ * \brief Watchdog supervisor: start monitoring a task, which must then check
+ * in between two watchdog clears.
+ */
+void event_task_resume(event_task_t task)
+{
+	event_task_monitored |= 1u << task;
+	event_task_alive |= 1u << task;
+}
+
+/** 
+ * \brief Watchdog supervisor: stop monitoring a task, while it is not
+ * expected to run.
+ */
+void event_task_suspend(event_task_t task)
+{
+	event_task_monitored &= ~(1u << task);
+}
+
+/** 
+ * \brief Watchdog supervisor: report a task as alive.
+ */
+void event_task_checkin(event_task_t task)
+{
+	event_task_alive |= 1u << task;
+}
+
+/** 
+ * \brief Watchdog supervisor: clear the WDT once all monitored tasks have
+ * checked in since the last clear. Called from the idle paths, it never
+ * waits for the WDT to be ready.
+ */
+void event_wdt_service(void)
+{
+	if ((event_task_alive & event_task_monitored) != event_task_monitored) {
+		return;
+	}
+	if (wdt_clear()) {
+		event_task_alive = 0u;
+	}
+}
+
+/** 
+ * \brief Get the oldest queued event of all sources.
+ * \param event returned event.
+ * \return false if no event is queued.
+ */
+bool event_get(event_t *event)
+{
+	event_queue_t *oldest_queue = NULL;
+	event_t *oldest = NULL, *e;
+	uint8_t i;
+
+	for (i = 0; i < sizeof(event_queues) / sizeof(event_queues[0]); i++) {
+		e = event_queue_peek(event_queues[i]);
+		if (e != NULL && (oldest == NULL
+				|| (int32_t)(e->time - oldest->time) < 0)) {
+			oldest_queue = event_queues[i];
+			oldest = e;
+		}
+	}
+	if (oldest == NULL) {
+		return false;
+	}
+	*event = *oldest;
+	event_queue_pop(oldest_queue);
+	return true;
+}
+
+/** 
+ * \brief Check if an event is queued.
+ */
+bool event_is_pending(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < sizeof(event_queues) / sizeof(event_queues[0]); i++) {
+		if (event_queue_peek(event_queues[i]) != NULL) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/** 
+ * \brief Sleep until the next interrupt, unless an event is already
+ * queued. The sleep mode keeps the PDCA running for QTouch acquisitions.
+ */
+void event_wait(void)
+{
+	event_wdt_service();
+
+	cpu_irq_disable();
+	if (event_is_pending()) {
+		cpu_irq_enable();
+		return;
+	}
+	// The pending interrupt wakes the CPU up even with interrupts disabled
+	sleepmgr_sleep(SLEEPMGR_SLEEP_0);
+}
+
+/** 
+ * \brief Autonomous QTouch status change, from the CATB interrupt handler.
+ * \param in_touch true for an IN_TOUCH status change.
+ */
+void event_qtouch_at_status_change(bool in_touch)
+{
+	event_queue_put(&event_queue_touch,
+		in_touch ? EVENT_AT_TOUCH : EVENT_AT_RELEASE);
+}
+
+/** 
+ * \brief Check if push button is pressed or not: consume the queued events
+ * up to the next push button event, so that no press is lost.
  */
 bool event_is_push_button_pressed(void)
 {
-	bool event_button_state = false;
-	event_button_state = event_pbEvent;
-	if (event_pbEvent == true) {
-		event_pbEvent = false;
+	event_t event;
+
+	while (event_get(&event)) {
+		if (event.type == EVENT_PUSH_BUTTON) {
+			return true;
+		}
+	}
+	return false;
+}
+
+#ifdef EVENT_QTOUCH_ADAPTIVE_PERIOD
+/**
+ * \brief Adapt the QTouch measurement period to the touch activity, once
+ * per AST period: switch to the fast period as soon as a sensor is in
+ * detect or the slider moves, and double the period after each
+ * EVENT_QTOUCH_BACKOFF_PERIODS idle periods, up to EVENT_AST_PER_IDLE.
+ */
+void event_qtouch_update_period(void)
+{
+	uint8_t per = event_ast_per;
+	bool active = false;
+	uint8_t i;
+
+	if (event_qtouch_sensors_idle_count == event_qtouch_update_count) {
+		return;
+	}
+	event_qtouch_update_count = event_qtouch_sensors_idle_count;
+
+	for (i = 0; i < p_qt_measure_data->num_sensor_states; i++) {
+		if (p_qt_measure_data->p_sensor_states[i]) {
+			active = true;
+		}
+	}
+	if (GET_QT_ROTOR_SLIDER_POSITION(0) != event_qtouch_slider_position) {
+		event_qtouch_slider_position = GET_QT_ROTOR_SLIDER_POSITION(0);
+		active = true;
+	}
+
+	if (active) {
+		per = EVENT_AST_PER_FAST;
+		event_qtouch_idle_periods = 0u;
+	} else if (++event_qtouch_idle_periods >= EVENT_QTOUCH_BACKOFF_PERIODS) {
+		if (per < EVENT_AST_PER_IDLE) {
+			per++;
+		}
+		event_qtouch_idle_periods = 0u;
+	}
+
+	if (per != event_ast_per) {
+		event_ast_per = per;
+		event_ast_set_period(per);
+	}
+}
+#endif
+
+#ifdef EVENT_QTOUCH_AT_WAKEUP
+/**
+ * \brief Arm the autonomous touch sensor before sleeping: the AST periodic
+ * interrupt is slowed down to the watchdog keep-alive rate, so that apart
+ * from it the CPU is only woken by a touch or the PB0 push button.
+ */
+void event_qtouch_at_arm(void)
+{
+	event_t *event;
+
+	event_ast_set_period(EVENT_AST_PER_SLEEP);
+	// The periodic interrupt must end WAIT and RETENTION to clear the WDT
+	ast_enable_wakeup(AST, AST_WAKEUP_PER);
+	// No measurement until the wakeup
+	event_task_suspend(EVENT_TASK_QTOUCH);
+
+	// Only wake up on status changes from now on
+	while ((event = event_queue_peek(&event_queue_touch)) != NULL) {
+		event_queue_pop(&event_queue_touch);
+	}
+	autonomous_qtouch_in_touch = 0;
+	touch_autonomous_sensor_enable();
+}
+
+/**
+ * \brief Disarm the autonomous touch sensor after wakeup, so that the CATB
+ * is left to the full QTouch measurements, and restore the measurement
+ * period.
+ */
+void event_qtouch_at_disarm(void)
+{
+	touch_autonomous_sensor_disable();
+	ast_disable_wakeup(AST, AST_WAKEUP_PER);
+
+#ifdef EVENT_QTOUCH_ADAPTIVE_PERIOD
+	// A touch woke the CPU up: measure fast right away
+	event_ast_per = EVENT_AST_PER_FAST;
+	event_qtouch_idle_periods = 0u;
+	event_ast_set_period(event_ast_per);
+#else
+	event_ast_set_period(EVENT_AST_PER_MEASURE);
+#endif
+
+	// Measure for at least one release window after the wakeup
+	event_qtouch_touch_count = event_qtouch_sensors_idle_count;
+	event_task_resume(EVENT_TASK_QTOUCH);
+}
+
+/**
+ * \brief Check if the CPU must stay awake: the autonomous touch sensor is
+ * in touch or PB0 has been pressed.
+ * \note Called with interrupts disabled before entering the sleep mode.
+ */
+bool event_qtouch_at_is_woken(void)
+{
+	return (event_queue_peek(&event_queue_touch) != NULL)
+		|| (event_queue_peek(&event_queue_button) != NULL);
+}
+
+/**
+ * \brief Check if every QTouch sensor has been out of detect for the whole
+ * release window.
+ */
+bool event_qtouch_is_released(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < p_qt_measure_data->num_sensor_states; i++) {
+		if (p_qt_measure_data->p_sensor_states[i]) {
+			event_qtouch_touch_count = event_qtouch_sensors_idle_count;
+			return false;
+		}
 	}
-	return event_button_state;
+	return (event_qtouch_sensors_idle_count - event_qtouch_touch_count)
+		>= EVENT_QTOUCH_RELEASE_PERIODS;
 }
+#endif
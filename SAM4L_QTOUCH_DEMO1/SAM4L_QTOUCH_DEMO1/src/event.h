@@ -52,11 +52,65 @@
 #include "sleepmgr.h"
 #include "sysclk.h"
 #include "touch_api_sam4l.h"
+#include "touch_post.h"
+
+/**
+ * Define to measure QTouch fast while a sensor is in detect, and back off
+ * exponentially down to a slow AST period when idle.
+ */
+#define EVENT_QTOUCH_ADAPTIVE_PERIOD
+
+/**
+ * Define to let the full demo sleep with only the autonomous touch sensor
+ * armed, and run QTouch measurements only from a touch until its release.
+ */
+#define EVENT_QTOUCH_AT_WAKEUP
+
+//! Sleep mode used while waiting for the autonomous touch sensor.
+#define EVENT_QTOUCH_AT_SLEEP_MODE     SLEEP_MODE_RETENTION
+
+//! Tasks monitored by the watchdog supervisor.
+typedef enum {
+	EVENT_TASK_MAIN,     //!< Main loop iteration
+	EVENT_TASK_QTOUCH,   //!< QTouch measurement completed
+} event_task_t;
+
+//! Event sources.
+typedef enum {
+	EVENT_PUSH_BUTTON,   //!< PB0 push button pressed (EIC)
+	EVENT_TICK,          //!< QTouch measurement period elapsed (AST)
+	EVENT_AT_TOUCH,      //!< Autonomous QTouch sensor in touch (CATB)
+	EVENT_AT_RELEASE,    //!< Autonomous QTouch sensor out of touch (CATB)
+} event_type_t;
+
+//! Queued event.
+typedef struct {
+	event_type_t type;
+	//! AST counter value when the event was queued, in 1/1024 s.
+	uint32_t time;
+} event_t;
 
 void event_qtouch_init(void);
 void event_button_init(void);
 bool event_qtouch_get_button_state(void);
 bool event_qtouch_get_slider_state( uint8_t* event_qtouch_position );
 bool event_is_push_button_pressed(void);
+void event_task_resume(event_task_t task);
+void event_task_suspend(event_task_t task);
+void event_task_checkin(event_task_t task);
+void event_wdt_service(void);
+bool event_get(event_t *event);
+bool event_is_pending(void);
+void event_wait(void);
+void event_qtouch_at_status_change(bool in_touch);
+#ifdef EVENT_QTOUCH_ADAPTIVE_PERIOD
+void event_qtouch_update_period(void);
+#endif
+#ifdef EVENT_QTOUCH_AT_WAKEUP
+void event_qtouch_at_arm(void);
+void event_qtouch_at_disarm(void);
+bool event_qtouch_at_is_woken(void);
+bool event_qtouch_is_released(void);
+#endif
 
 #endif  // _EVENT_H
@@ -66,6 +66,14 @@
  * QTouch and segment LCD). The applications captures QTouch inputs 
  * (sliders and CS0 QTouch button): displays the slider value (0..255)  to the 
  * segment LCD, CS0 will change the SAM4L Power Scaling mode (PS0 or PS1). 
+ * - With EVENT_QTOUCH_AT_WAKEUP defined (event.h), the full demo mode sleeps
+ * in RETENTION mode once all sensors are released, with only the CS0
+ * autonomous touch sensor armed. A touch on CS0 wakes the SAM4L up for a
+ * burst of QTouch measurements until release, and the average current
+ * measured by the board monitor is printed on the OLED display.
+ * - With EVENT_QTOUCH_ADAPTIVE_PERIOD defined (event.h), QTouch is measured
+ * every 15.6ms while a sensor is in detect, and the period doubles after
+ * each 4 idle periods, up to 250ms.
  * - Once the PB0 push button has been pressed, the application switches in low 
  * power mode: Stop LCD controller, stop LCD backlight, stop QTouch 
  * acquisition, switch SAM4L in power scaling PS1 mode. SAM4L is still in RUN 
@@ -118,8 +126,31 @@ int main(void)
 	 */
 	app_init();
 
+	// From now on, the watchdog is only cleared while the main loop and the
+	// QTouch measurements run.
+	event_task_resume(EVENT_TASK_MAIN);
+	event_task_resume(EVENT_TASK_QTOUCH);
+
 	// Stay in full demo mode until push button PB0 button is pressed
 	while (!event_is_push_button_pressed()){
+		event_task_checkin(EVENT_TASK_MAIN);
+#ifdef EVENT_QTOUCH_AT_WAKEUP
+		/*
+		 * Once every QTouch sensor has been released, sleep with only the
+		 * autonomous touch sensor armed: the burst of QTouch measurements
+		 * below restarts on the next touch.
+		 */
+		if (event_qtouch_is_released()) {
+			app_qtouch_at_sleep();
+		}
+#endif
+		/*
+		 * Sleep until the next interrupt: the AST measurement tick, the
+		 * QTouch acquisition or an input event.
+		 */
+		event_wait();
+		// Print the board monitor reports received meanwhile
+		ui_bm_task();
 		// Runs prime number algorithm
 		app_prime_number_run();
 		/* 
@@ -128,6 +159,10 @@ int main(void)
 		 * Power Scaling mode (PS0 or PS1). 
 		 */
 		touch_sensors_measure();
+#ifdef EVENT_QTOUCH_ADAPTIVE_PERIOD
+		// Adapt the measurement period to the touch activity
+		event_qtouch_update_period();
+#endif
 		if (event_qtouch_get_button_state()) {
 			/*
 			 * Change Power Scaling Mode: from PS0 to PS1 or PS1 to PS0.
@@ -172,6 +207,8 @@ int main(void)
 	app_init_lowpower();
 
 	while(1u){
+		event_task_checkin(EVENT_TASK_MAIN);
+		event_wdt_service();
 		// Runs prime number algorithm
 		app_prime_number_run();
 		/* 
@@ -207,6 +244,8 @@ int main(void)
 			ui_set_sleep_mode_mcu_status(sleep_mode);
 			// Send new MCU status to the board monitor
 			ui_bm_send_mcu_status();
+			// Wait for the frame to be sent, out of the measured sleep mode
+			bm_async_flush();
 			// Now we're ready to enter the selected sleep mode 
 			app_enter_sleep_mode(sleep_mode);
 		}
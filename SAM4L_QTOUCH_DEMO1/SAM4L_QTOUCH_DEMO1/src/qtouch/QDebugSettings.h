@@ -90,6 +90,35 @@ extern "C"
 //#define QDEBUG_SERIAL
 //#define QDEBUG_BITBANG_SPI
 //#define QDEBUG_SPI_BB
+//#define QDEBUG_USART_SPI
+
+/*
+ * QDEBUG_USART_SPI: USART in SPI master mode, fed by two PDCA channels that
+ * must differ from QT_DMA_CHANNEL_0, QT_DMA_CHANNEL_1 and
+ * LCDCA_AUTOMATED_CHAR_DMA_CH (conf_lcdca.h).
+ *
+ * The QT600 bridge is wired to the QDEBUG_SPI_BB pins below (PC01 SS,
+ * PC07 SCK, PC08 MOSI, PC13 MISO), which no USART can drive. With this
+ * interface the bridge must be rewired to the USART3 pins:
+ *   SS   PC13    SCK  PC14    MOSI  PC10    MISO  PC09
+ * PC14 is the LCD backlight and PC10 is LED0 on this board, so neither
+ * can be used by the application while QDebug runs over USART3.
+ */
+#define QDEBUG_USART_SPI_USART      USART3
+#define QDEBUG_USART_SPI_BAUDRATE   125000
+#define QDEBUG_USART_SPI_PDCA_ID_TX USART3_PDCA_ID_TX
+#define QDEBUG_USART_SPI_PDCA_ID_RX USART3_PDCA_ID_RX
+#define QDEBUG_USART_SPI_PDCA_TX    2
+#define QDEBUG_USART_SPI_PDCA_RX    3
+
+#define QDEBUG_USART_SPI_SS_PIN     PIN_PC13B_USART3_RTS
+#define QDEBUG_USART_SPI_SS_MUX     MUX_PC13B_USART3_RTS
+#define QDEBUG_USART_SPI_SCK_PIN    PIN_PC14B_USART3_CLK
+#define QDEBUG_USART_SPI_SCK_MUX    MUX_PC14B_USART3_CLK
+#define QDEBUG_USART_SPI_MOSI_PIN   PIN_PC10B_USART3_TXD
+#define QDEBUG_USART_SPI_MOSI_MUX   MUX_PC10B_USART3_TXD
+#define QDEBUG_USART_SPI_MISO_PIN   PIN_PC09B_USART3_RXD
+#define QDEBUG_USART_SPI_MISO_MUX   MUX_PC09B_USART3_RXD
 
 // The definitions below should not clash with the SNS/SNSK port pins
 #define QDEBUG_SPI_BB_SS_PIN        1
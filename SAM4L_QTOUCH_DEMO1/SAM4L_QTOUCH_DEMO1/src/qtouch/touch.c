@@ -57,6 +57,11 @@
  */
 #include "touch_api_sam4l.h"
 
+/**
+ * Includes for the application event queues.
+ */
+#include "event.h"
+
 #if DEF_TOUCH_QDEBUG_ENABLE == 1
   /**
    * Includes for Touch Debug interface.
@@ -64,6 +69,13 @@
 #include "QDebug_sam4l.h"
 #endif
 
+#if DEF_TOUCH_POST_PROCESSING == 1
+  /**
+   * Includes for Touch post-processing.
+   */
+#include "touch_post.h"
+#endif
+
 /*----------------------------------------------------------------------------
                             manifest constants
 ----------------------------------------------------------------------------*/
@@ -97,6 +109,14 @@ touch_measure_data_t *p_qt_measure_data = NULL;
  */
 volatile int8_t autonomous_qtouch_in_touch = 0;
 
+#if DEF_TOUCH_POST_PROCESSING == 1
+//! Touch post-processing state.
+touch_post_t touch_post;
+
+//! Touch post-processing events not yet handled by the application.
+uint8_t touch_post_events = 0u;
+#endif
+
 /*----------------------------------------------------------------------------
                                 extern variables
 ----------------------------------------------------------------------------*/
@@ -248,6 +268,11 @@ touch_sensors_init (void)
       while (1u);		/* Check API Error return code. */
     }
 
+#if DEF_TOUCH_POST_PROCESSING == 1
+  touch_post_init (&touch_post);
+  touch_post_events = 0u;
+#endif
+
   /* Initialize touch sensing. */
   touch_ret = touch_qt_sensors_calibrate ();
   if (touch_ret != TOUCH_SUCCESS)
@@ -307,12 +332,27 @@ touch_sensors_measure (void)
   {
     /* Clear flag: QTouch Library measurement complete. */
     touch_qt_time.measurement_done_touch = 0u;
+
+    /* Report the measurements as alive to the watchdog supervisor. */
+    event_task_checkin (EVENT_TASK_QTOUCH);
     
     /* Use Touch Status. */
     //uint8_t touch_status_sensor0 = GET_SENSOR_STATE(SENSOR_NUMBER);
     
     /* Use Rotor/Slider Position. */
     //uint8_t rotor_slider_position = GET_ROTOR_SLIDER_POSITION(ROTOR_SLIDER_NUMBER);
+
+#if DEF_TOUCH_POST_PROCESSING == 1
+    /* Debounce, smooth and detect gestures on this measurement. */
+    {
+      touch_post_frame_t frame;
+
+      frame.time_ms = touch_qt_time.current_time_ms;
+      frame.states = p_qt_measure_data->p_sensor_states[0];
+      frame.slider = GET_QT_ROTOR_SLIDER_POSITION (0);
+      touch_post_events |= touch_post_process (&touch_post, &frame);
+    }
+#endif
     
 #if DEF_TOUCH_QDEBUG_ENABLE == 1
     /* QT600 two-way QDebug communication application Example. */
@@ -451,6 +491,9 @@ touch_at_status_change_interrupt_callback (touch_at_status * p_at_status)
       autonomous_qtouch_in_touch = 0u;
 
     }
+
+  /* Queue the status change for the application. */
+  event_qtouch_at_status_change (autonomous_qtouch_in_touch != 0);
 }
 
 /*! \brief QTouch Library time update function.
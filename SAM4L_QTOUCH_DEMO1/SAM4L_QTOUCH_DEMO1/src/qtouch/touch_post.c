@@ -0,0 +1,156 @@
+/**
+ * \file
+ *
+ * \brief Touch post-processing: key debounce, slider smoothing and gestures.
+ *
+ * Copyright (c) 2012-2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ *
+ */
+#include <string.h>
+#include "touch_post.h"
+
+/**
+ * \brief Initialize the touch post-processing state.
+ * \param post Touch post-processing state.
+ */
+void touch_post_init(touch_post_t *post)
+{
+	memset(post, 0, sizeof(*post));
+}
+
+/**
+ * \brief Debounce a sensor state.
+ * \param state Debounced state.
+ * \param count Measurements the raw state has differed from the debounced one.
+ * \param raw Raw state of this measurement.
+ * \return true if the debounced state changed.
+ */
+static bool touch_post_debounce(bool *state, uint8_t *count, bool raw)
+{
+	if (raw == *state) {
+		*count = 0;
+		return false;
+	}
+	if (++(*count) < TOUCH_POST_DEBOUNCE) {
+		return false;
+	}
+	*state = raw;
+	*count = 0;
+	return true;
+}
+
+/**
+ * \brief Classify a slider touch on its release.
+ * \param post Touch post-processing state.
+ * \param time_ms Time of the release.
+ * \return Swipe or tap event, 0 if none.
+ */
+static uint8_t touch_post_gesture(const touch_post_t *post, uint16_t time_ms)
+{
+	int16_t travel = (int16_t)touch_post_get_position(post)
+		- post->start_position;
+
+	if (travel >= TOUCH_POST_SWIPE_DISTANCE) {
+		return TOUCH_POST_EVENT_SWIPE_UP;
+	}
+	if (travel <= -TOUCH_POST_SWIPE_DISTANCE) {
+		return TOUCH_POST_EVENT_SWIPE_DOWN;
+	}
+	if ((uint16_t)(time_ms - post->start_time_ms) <= TOUCH_POST_TAP_TIME_MS) {
+		return TOUCH_POST_EVENT_TAP;
+	}
+	return 0;
+}
+
+/**
+ * \brief Post-process a completed QTouch measurement: debounce the key and
+ * slider states, smooth the slider position and velocity, and detect the
+ * slider gestures.
+ * \param post Touch post-processing state.
+ * \param frame Measurement.
+ * \return Events of this measurement (touch_post_event).
+ */
+uint8_t touch_post_process(touch_post_t *post,
+		const touch_post_frame_t *frame)
+{
+	uint8_t events = 0;
+	uint16_t elapsed_ms = frame->time_ms - post->time_ms;
+	uint16_t position = post->position;
+	int32_t velocity;
+
+	post->time_ms = frame->time_ms;
+
+	if (touch_post_debounce(&post->key, &post->key_count,
+			(frame->states & TOUCH_POST_KEY_MASK) != 0)) {
+		events |= post->key ? TOUCH_POST_EVENT_KEY_PRESS
+			: TOUCH_POST_EVENT_KEY_RELEASE;
+	}
+
+	if (touch_post_debounce(&post->slider, &post->slider_count,
+			(frame->states & TOUCH_POST_SLIDER_MASK) != 0)) {
+		if (!post->slider) {
+			return events | TOUCH_POST_EVENT_SLIDER_RELEASE
+				| touch_post_gesture(post, frame->time_ms);
+		}
+		// Start from the touched position rather than sliding to it
+		post->position = (uint16_t)frame->slider << 8;
+		post->velocity = 0;
+		post->start_position = frame->slider;
+		post->start_time_ms = frame->time_ms;
+		return events | TOUCH_POST_EVENT_SLIDER_TOUCH;
+	}
+	// While a release is debounced the raw position is no longer valid
+	if (!post->slider || (frame->states & TOUCH_POST_SLIDER_MASK) == 0) {
+		return events;
+	}
+
+	// Exponential smoothing of the position, in 8.8 fixed point
+	post->position += ((((int32_t)frame->slider << 8) - position)
+		/ (1 << TOUCH_POST_SMOOTH_SHIFT));
+	if ((post->position >> 8) != (position >> 8)) {
+		events |= TOUCH_POST_EVENT_SLIDER_MOVE;
+	}
+
+	// Velocity of the smoothed position, smoothed the same way
+	if (elapsed_ms != 0) {
+		velocity = ((int32_t)post->position - position) * 1000
+			/ ((int32_t)elapsed_ms << 8);
+		post->velocity += (velocity - post->velocity)
+			/ (1 << TOUCH_POST_SMOOTH_SHIFT);
+	}
+	return events;
+}
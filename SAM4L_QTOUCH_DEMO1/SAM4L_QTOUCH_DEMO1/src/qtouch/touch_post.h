@@ -0,0 +1,127 @@
+/**
+ * \file
+ *
+ * \brief Touch post-processing: key debounce, slider smoothing and gestures.
+ *
+ * Copyright (c) 2012-2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ *
+ */
+#ifndef _TOUCH_POST_H
+#define _TOUCH_POST_H
+
+/*
+ * The post-processing only depends on the C library, so that it can also be
+ * built on the host and replayed on recorded QDebug streams
+ * (tools/touch_post_bench.c).
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+//! Sensor state bit of the CS0 key.
+#define TOUCH_POST_KEY_MASK            (0x01u)
+//! Sensor state bits of the slider.
+#define TOUCH_POST_SLIDER_MASK         (0x0Eu)
+//! Measurements a new key or slider state must last to be reported.
+#define TOUCH_POST_DEBOUNCE            (2u)
+/**
+ * Slider position smoothing: each measurement moves the position by
+ * 1/2^TOUCH_POST_SMOOTH_SHIFT of its distance to the raw position.
+ */
+#define TOUCH_POST_SMOOTH_SHIFT        (2u)
+//! Slider travel from touch to release reported as a swipe.
+#define TOUCH_POST_SWIPE_DISTANCE      (64)
+//! Longest slider touch without a swipe reported as a tap, in ms.
+#define TOUCH_POST_TAP_TIME_MS         (250u)
+
+//! Touch post-processing events, or-ed together.
+enum touch_post_event {
+	TOUCH_POST_EVENT_KEY_PRESS       = (1u << 0),
+	TOUCH_POST_EVENT_KEY_RELEASE     = (1u << 1),
+	TOUCH_POST_EVENT_SLIDER_TOUCH    = (1u << 2),
+	TOUCH_POST_EVENT_SLIDER_MOVE     = (1u << 3),
+	TOUCH_POST_EVENT_SLIDER_RELEASE  = (1u << 4),
+	TOUCH_POST_EVENT_TAP             = (1u << 5),
+	TOUCH_POST_EVENT_SWIPE_UP        = (1u << 6),
+	TOUCH_POST_EVENT_SWIPE_DOWN      = (1u << 7),
+};
+
+//! One completed QTouch measurement.
+typedef struct {
+	//! QTouch library time of the measurement.
+	uint16_t time_ms;
+	//! First sensor state byte.
+	uint8_t states;
+	//! Raw slider position.
+	uint8_t slider;
+} touch_post_frame_t;
+
+//! Touch post-processing state.
+typedef struct {
+	//! Debounced key state.
+	bool key;
+	//! Measurements the raw key state has differed from the debounced one.
+	uint8_t key_count;
+	//! Debounced slider state.
+	bool slider;
+	//! Measurements the raw slider state has differed from the debounced one.
+	uint8_t slider_count;
+	//! Smoothed slider position, 8.8 fixed point.
+	uint16_t position;
+	//! Smoothed slider velocity, in positions per second.
+	int16_t velocity;
+	//! Time of the previous measurement.
+	uint16_t time_ms;
+	//! Slider position when touched.
+	uint8_t start_position;
+	//! Time of the slider touch.
+	uint16_t start_time_ms;
+} touch_post_t;
+
+void touch_post_init(touch_post_t *post);
+uint8_t touch_post_process(touch_post_t *post,
+		const touch_post_frame_t *frame);
+
+/**
+ * \brief Return the smoothed slider position (0..255).
+ * \param post Touch post-processing state.
+ */
+static inline uint8_t touch_post_get_position(const touch_post_t *post)
+{
+	return post->position >> 8;
+}
+
+#endif  // _TOUCH_POST_H
@@ -41,6 +41,7 @@
  *
  */
 #include "ui.h"
+#include "event.h"
 
 //
 #define UI_IDLE_TIME         (156u)
@@ -55,6 +56,21 @@ volatile sam4l_status_t sam4l_status = {
 
 extern volatile uint32_t event_qtouch_sensors_idle_count;
 
+//! Value of the numeric field when it is cleared
+#define UI_LCD_NONE          (-1)
+//! Number of texts shown in turn in the alphanumeric field
+#define UI_LCD_TXT_SEQ_LENGTH 2
+
+//! Value shown in the numeric field, UI_LCD_NONE if cleared, none at startup
+static int32_t ui_lcd_num_value = UI_LCD_NONE - 1;
+//! Texts shown in turn in the alphanumeric field, read by the PDCA
+static uint8_t ui_lcd_txt_seq[UI_LCD_TXT_SEQ_LENGTH][C42364A_WIDTH_14SEG_4C];
+//! Status shown in the alphanumeric field
+static power_scaling_t ui_lcd_txt_ps;
+static uint32_t ui_lcd_txt_freq;
+//! Text sequence started
+static bool ui_lcd_txt_running = false;
+
 /**
  * \brief Set MCU power saving information used by the UI.
  *
@@ -117,23 +133,83 @@ void ui_bm_init(void)
 	sysclk_enable_peripheral_clock(BM_USART_USART);
 	bm_init();
 	sysclk_disable_peripheral_clock(BM_USART_USART);
+	bm_async_init();
 	ui_bm_send_mcu_status();
 }
 
 
 /** 
- * \brief User Interface Board Monitor send SAM4L status.
+ * \brief User Interface Board Monitor send SAM4L status. The frame is sent in
+ *  background, and coalesced with the next status updates until it is sent.
  */
 void ui_bm_send_mcu_status(void)
 {
 	uint32_t power_scaling, sleep_mode, cpu_freq, cpu_src;
-	sysclk_enable_peripheral_clock(BM_USART_USART);
 	power_scaling = sam4l_status.power_scaling;
 	sleep_mode = sam4l_status.sleep_mode;
 	cpu_freq = sam4l_status.cpu_freq;
 	cpu_src = sam4l_status.cpu_src;
-	bm_send_mcu_status(power_scaling, sleep_mode, cpu_freq, cpu_src);
-	sysclk_disable_peripheral_clock(BM_USART_USART);
+	bm_async_send_mcu_status(power_scaling, sleep_mode, cpu_freq, cpu_src);
+}
+
+//! Last current reported by the board monitor.
+static volatile float ui_bm_current;
+//! A current has been reported and not yet printed.
+static volatile bool ui_bm_current_pending = false;
+
+/** 
+ * \brief Board Monitor current callback, called from the USART interrupt:
+ *  keep the current for ui_bm_task().
+ * \param sleep_mode Sleep Mode the current has been measured in.
+ * \param current Current measured.
+ */
+static void ui_bm_current_callback(uint32_t sleep_mode, float current)
+{
+	UNUSED(sleep_mode);
+	ui_bm_current = current;
+	ui_bm_current_pending = true;
+}
+
+/** 
+ * \brief User Interface Board Monitor task: print the average of all the
+ *  currents reported so far on the board monitor text area, once a new one
+ *  has been received. Called from the main loop.
+ */
+void ui_bm_task(void)
+{
+	static float current_sum = 0;
+	static uint32_t current_count = 0;
+	float average;
+	char string_info[24];
+	int length;
+
+	if (!ui_bm_current_pending) {
+		return;
+	}
+	cpu_irq_disable();
+	current_sum += ui_bm_current;
+	ui_bm_current_pending = false;
+	cpu_irq_enable();
+	current_count++;
+	average = current_sum / current_count;
+	// Print with 3 decimals, without the float support of printf
+	length = sprintf(string_info, "AT avg %lu.%03lu",
+		(uint32_t)average,
+		(uint32_t)((average - (uint32_t)average) * 1000));
+	bm_async_print_clear();
+	bm_async_print_txt((uint8_t *)string_info, length);
+}
+
+/** 
+ * \brief User Interface Board Monitor current report: request the current
+ *  measured by the board monitor in the given sleep mode. Its average over
+ *  all the reports is printed on the board monitor text area by ui_bm_task()
+ *  once received.
+ * \param sleep_mode Sleep Mode the current has been measured in.
+ */
+void ui_bm_report_current(sleep_mode_t sleep_mode)
+{
+	bm_async_get_mcu_current(sleep_mode, ui_bm_current_callback);
 }
 
 /** 
@@ -158,7 +234,9 @@ void ui_lcd_init(void)
 	c42364a_text_scrolling_start(scrolling_str,
 			strlen((char const *)scrolling_str));
 
-	while(event_qtouch_sensors_idle_count<UI_IDLE_TIME){}
+	while(event_qtouch_sensors_idle_count<UI_IDLE_TIME){
+		event_wdt_service();
+	}
 	event_qtouch_sensors_idle_count = 0;
 
 	// Stop scrolling text.
@@ -167,45 +245,111 @@ void ui_lcd_init(void)
 	ui_lcd_refresh_txt();
 }
 /** 
- * \brief User Interface LCD Refresh Alphanumeric area.
+ * \brief Write a decimal value, left aligned and padded with spaces.
+ * \param buf Characters buffer, not NULL terminated.
+ * \param width Number of characters to write.
+ * \param value Value to write.
+ */
+static void ui_lcd_format_dec(uint8_t *buf, uint8_t width, uint32_t value)
+{
+	uint32_t div = 1;
+	uint8_t i = 0;
+
+	while (value / div >= 10) {
+		div *= 10;
+	}
+	for (; div && i < width; div /= 10) {
+		buf[i++] = '0' + (value / div) % 10;
+	}
+	while (i < width) {
+		buf[i++] = ' ';
+	}
+}
+
+/** 
+ * \brief User Interface LCD Refresh Alphanumeric area. The numeric field is
+ *  only written when the displayed value changes.
  * \param ui_lcd_refresh boolean to refresh or not Alphanumeric area.
  * \param event_qtouch_slider_position set slider position in Alphanumeric area.
  */
 void ui_lcd_refresh_alphanum(bool ui_lcd_refresh, 
 	int32_t event_qtouch_slider_position)
 {
-	char  string_info[8];
-	if (ui_lcd_refresh == true ) {
-		sprintf(string_info, "%d", event_qtouch_slider_position);
-		if (event_qtouch_slider_position < 100) {
-			string_info[2] = ' ';
-			string_info[3] = ' ';
-			string_info[4] = '\0';
-		}
-		// display slider position on segment LCD
-		c42364a_write_num_packet((uint8_t const*)&string_info);
+	uint8_t string_info[C42364A_WIDTH_7SEG_4C + 1];
+	int32_t value;
+
+	// Displayed value, UI_LCD_NONE to clear the digit area
+	value = ui_lcd_refresh ? event_qtouch_slider_position : UI_LCD_NONE;
+	if (value == ui_lcd_num_value) {
+		return;
+	}
+	ui_lcd_num_value = value;
+
+	if (value == UI_LCD_NONE) {
+		memset(string_info, ' ', C42364A_WIDTH_7SEG_4C);
 	} else {
-		// Clear digit area
-		string_info[0] = ' ';
-		string_info[1] = ' ';
-		string_info[2] = ' ';
-		string_info[3] = ' ';
-		string_info[4] = '\0';
-		// display slider position on segment LCD
-		c42364a_write_num_packet((uint8_t const*)&string_info);
+		ui_lcd_format_dec(string_info, C42364A_WIDTH_7SEG_4C, value);
 	}
+	string_info[C42364A_WIDTH_7SEG_4C] = '\0';
+	// display slider position on segment LCD
+	c42364a_write_num_packet(string_info);
 }
+
 /** 
- * \brief User Interface LCD Refresh Text area.
+ * \brief User Interface LCD Refresh Text area: the power scaling mode and the
+ *  CPU frequency are shown in turn by the LCDCA sequential mode, and the ARM
+ *  icon blinks in PS1. The texts buffer is only written when the status
+ *  changes, the PDCA and the LCDCA timers do the rest.
  */
 void ui_lcd_refresh_txt(void)
 {
-	char  string_info[8];
+	power_scaling_t power_scaling = sam4l_status.power_scaling;
+	uint32_t cpu_freq = sam4l_status.cpu_freq;
+	uint8_t *txt;
+
+	if (ui_lcd_txt_running && power_scaling == ui_lcd_txt_ps
+			&& cpu_freq == ui_lcd_txt_freq) {
+		return;
+	}
+
 	// Display Power Scaling mode on segment LCD
-	if (ui_get_power_scaling_mcu_status() == POWER_SCALING_PS0){
-		sprintf((char*)string_info, "RUN PS0");
-	} else {
-		sprintf((char*)string_info, "RUN PS1");
+	txt = ui_lcd_txt_seq[0];
+	memcpy(txt, "RUN PS", 6);
+	txt[6] = (power_scaling == POWER_SCALING_PS0) ? '0' : '1';
+
+	// Display the CPU frequency, in MHz
+	txt = ui_lcd_txt_seq[1];
+	ui_lcd_format_dec(txt, 3, cpu_freq / 1000000);
+	memcpy(&txt[3], "MHZ ", 4);
+
+	// Blink the ARM icon in PS1
+	if (power_scaling != ui_lcd_txt_ps || !ui_lcd_txt_running) {
+		if (power_scaling == POWER_SCALING_PS0) {
+			c42364a_blink_icon_stop(C42364A_ICON_ARM);
+			c42364a_blink_disable();
+			c42364a_show_icon(C42364A_ICON_ARM);
+		} else {
+			c42364a_blink_icon_start(C42364A_ICON_ARM);
+		}
+	}
+
+	ui_lcd_txt_ps = power_scaling;
+	ui_lcd_txt_freq = cpu_freq;
+	if (!ui_lcd_txt_running) {
+		c42364a_text_sequential_start(&ui_lcd_txt_seq[0][0],
+			UI_LCD_TXT_SEQ_LENGTH);
+		ui_lcd_txt_running = true;
+	}
+}
+
+/** 
+ * \brief User Interface LCD Stop: stop the text sequence, before the LCD
+ *  controller or the PDCA are stopped.
+ */
+void ui_lcd_stop(void)
+{
+	if (ui_lcd_txt_running) {
+		c42364a_text_sequential_stop();
+		ui_lcd_txt_running = false;
 	}
-	c42364a_show_text((const uint8_t *)string_info);
 }
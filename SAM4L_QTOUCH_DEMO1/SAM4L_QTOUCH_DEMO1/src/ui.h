@@ -53,6 +53,7 @@
 #include "board.h"
 #include "c42364a.h"
 #include "board_monitor.h"
+#include "board_monitor_async.h"
 #include "touch_api_sam4l.h"
 #include "ioport.h"
 
@@ -64,9 +65,12 @@ sleep_mode_t ui_get_sleep_mode_mcu_status(void);
 void ui_set_sleep_mode_mcu_status(sleep_mode_t sleep_mode);
 void ui_bm_init(void);
 void ui_bm_send_mcu_status(void);
+void ui_bm_report_current(sleep_mode_t sleep_mode);
+void ui_bm_task(void);
 void ui_lcd_init(void);
 void ui_lcd_refresh_alphanum(bool ui_lcd_refresh, 
 	int32_t event_qtouch_slider_position);
 void ui_lcd_refresh_txt(void);
+void ui_lcd_stop(void);
 
 #endif  // _UI_H
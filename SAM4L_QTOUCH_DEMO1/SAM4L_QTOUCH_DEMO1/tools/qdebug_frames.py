@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""Convert a recorded QDebug stream into touch_post_bench frames.
+
+The input is the raw byte stream sent by QDebug_SendData() (for example a
+capture of the QDebug USART SPI or bit-bang SPI lines). Each QT_STATES
+message becomes one CSV line, together with the deltas of the preceding
+QT_DELTAS message:
+
+    time_ms,states,slider,delta0,delta1,...
+
+QDebug messages carry no time, so measurements are assumed to be
+--period-ms apart. Record with EVENT_QTOUCH_ADAPTIVE_PERIOD undefined.
+
+    qdebug_frames.py capture.bin > frames.csv
+"""
+
+import argparse
+import sys
+
+MESSAGE_START = 0x1B
+QT_DELTAS = 0x26
+QT_STATES = 0x27
+
+
+def messages(data):
+    """Yield the payload of each message with a valid checksum."""
+    i = 0
+    while i + 4 < len(data):
+        if data[i] != MESSAGE_START:
+            i += 1
+            continue
+        length = (data[i + 1] << 8) | data[i + 2]
+        if length < 5 or i + length >= len(data):
+            i += 1
+            continue
+        checksum = 0
+        for byte in data[i + 1:i + length]:
+            checksum ^= byte
+        if checksum != data[i + length]:
+            i += 1
+            continue
+        yield data[i + 4:i + length]
+        i += length + 1
+
+
+def frames(data, period_ms):
+    deltas = []
+    count = 0
+    for msg in messages(data):
+        if msg[0] == QT_DELTAS:
+            deltas = [int.from_bytes(msg[j:j + 2], 'big', signed=True)
+                      for j in range(1, len(msg) - 1, 2)]
+        elif msg[0] == QT_STATES and len(msg) >= 3:
+            channels, sliders = msg[1], msg[2]
+            state_bytes = (channels + 7) // 8
+            states = msg[3:3 + state_bytes]
+            positions = msg[3 + state_bytes:3 + state_bytes + sliders]
+            if len(states) < 1 or len(positions) < 1:
+                continue
+            time_ms = int(round(count * period_ms)) & 0xFFFF
+            count += 1
+            yield [time_ms, states[0], positions[0]] + deltas
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('capture', nargs='?', help='capture file, default stdin')
+    parser.add_argument('--period-ms', type=float, default=31.25,
+                        help='measurement period (default %(default)s)')
+    args = parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, 'rb') as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    print('# time_ms,states,slider,deltas...')
+    for frame in frames(data, args.period_ms):
+        print(','.join(str(v) for v in frame))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,285 @@
+/**
+ * \file
+ *
+ * \brief Host replay and benchmark of the touch post-processing.
+ *
+ * Copyright (c) 2012-2013 Atmel Corporation. All rights reserved.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel microcontroller product.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \asf_license_stop
+ *
+ */
+
+/*
+ * Replays frames recorded with qdebug_frames.py through touch_post.c, prints
+ * the events, the latency from touch to event and the cost per frame. With
+ * -x, exits with an error unless the named event was reported, e.g. for
+ * the recordings in fixtures/:
+ *   ./touch_post_bench -x SWIPE_UP fixtures/swipe_up.csv
+ *
+ * Build and run on the host:
+ *   cc -O2 -I../src/qtouch -o touch_post_bench touch_post_bench.c \
+ *       ../src/qtouch/touch_post.c
+ *   ./touch_post_bench [-t threshold] [-n repeat] [-q] [-x event] frames.csv
+ *
+ * The touch onset is the first frame with a delta at or above the threshold,
+ * so the latency includes the QTouch Library detect integration as well as
+ * the post-processing. Without deltas in the frames, the raw sensor states
+ * are used instead.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "touch_post.h"
+
+//! Maximum number of deltas per frame.
+#define BENCH_MAX_DELTAS   8
+
+//! Recorded frame.
+typedef struct {
+	touch_post_frame_t frame;
+	int16_t deltas[BENCH_MAX_DELTAS];
+	uint8_t num_deltas;
+} bench_frame_t;
+
+//! Latency statistics.
+typedef struct {
+	uint32_t count;
+	uint32_t sum_ms;
+	uint32_t max_ms;
+} bench_latency_t;
+
+static const char *const event_names[] = {
+	"KEY_PRESS", "KEY_RELEASE", "SLIDER_TOUCH", "SLIDER_MOVE",
+	"SLIDER_RELEASE", "TAP", "SWIPE_UP", "SWIPE_DOWN",
+};
+
+/**
+ * \brief Read the frames of a CSV file.
+ * \return Number of frames, 0 on error.
+ */
+static size_t bench_read(const char *path, bench_frame_t **frames)
+{
+	FILE *f = fopen(path, "r");
+	char line[256];
+	size_t count = 0, size = 0;
+
+	if (f == NULL) {
+		perror(path);
+		return 0;
+	}
+	*frames = NULL;
+	while (fgets(line, sizeof(line), f)) {
+		bench_frame_t *fr;
+		char *p = line, *end;
+
+		if (line[0] == '#' || line[0] == '\n') {
+			continue;
+		}
+		if (count == size) {
+			size = size ? 2 * size : 256;
+			*frames = realloc(*frames, size * sizeof(**frames));
+			if (*frames == NULL) {
+				fclose(f);
+				return 0;
+			}
+		}
+		fr = &(*frames)[count];
+		memset(fr, 0, sizeof(*fr));
+		fr->frame.time_ms = strtoul(p, &end, 0);
+		if (end == p || *end != ',') {
+			continue;
+		}
+		fr->frame.states = strtoul(end + 1, &end, 0);
+		fr->frame.slider = strtoul(end + 1, &end, 0);
+		while (*end == ',' && fr->num_deltas < BENCH_MAX_DELTAS) {
+			fr->deltas[fr->num_deltas++] = strtol(end + 1, &end, 0);
+		}
+		count++;
+	}
+	fclose(f);
+	return count;
+}
+
+/**
+ * \brief Check if a frame is touched before any post-processing.
+ */
+static bool bench_is_touched(const bench_frame_t *fr, long threshold)
+{
+	uint8_t i;
+
+	if (fr->num_deltas == 0) {
+		return (fr->frame.states
+				& (TOUCH_POST_KEY_MASK | TOUCH_POST_SLIDER_MASK)) != 0;
+	}
+	for (i = 0; i < fr->num_deltas; i++) {
+		if (fr->deltas[i] >= threshold) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void bench_latency_add(bench_latency_t *lat, uint16_t from,
+		uint16_t to)
+{
+	uint16_t ms = to - from;
+
+	lat->count++;
+	lat->sum_ms += ms;
+	if (ms > lat->max_ms) {
+		lat->max_ms = ms;
+	}
+}
+
+static void bench_latency_print(const char *name, const bench_latency_t *lat)
+{
+	if (lat->count == 0) {
+		printf("%-16s no event\n", name);
+		return;
+	}
+	printf("%-16s %u events, average %.1f ms, max %u ms\n", name,
+			(unsigned)lat->count, (double)lat->sum_ms / lat->count,
+			(unsigned)lat->max_ms);
+}
+
+int main(int argc, char *argv[])
+{
+	long threshold = 15;
+	unsigned long repeat = 1000, r;
+	bool quiet = false;
+	const char *expect = NULL;
+	uint8_t seen = 0;
+	bench_frame_t *frames;
+	size_t count, i;
+	touch_post_t post;
+	bench_latency_t touch_lat = {0}, release_lat = {0};
+	bool touched = false, touch_pending = false, release_pending = false;
+	uint16_t onset_ms = 0;
+	struct timespec start, stop;
+	volatile uint8_t sink = 0;
+	double ns;
+	int opt = 1;
+
+	while (opt < argc && argv[opt][0] == '-') {
+		if (!strcmp(argv[opt], "-t") && opt + 1 < argc) {
+			threshold = strtol(argv[++opt], NULL, 0);
+		} else if (!strcmp(argv[opt], "-n") && opt + 1 < argc) {
+			repeat = strtoul(argv[++opt], NULL, 0);
+		} else if (!strcmp(argv[opt], "-q")) {
+			quiet = true;
+		} else if (!strcmp(argv[opt], "-x") && opt + 1 < argc) {
+			expect = argv[++opt];
+		} else {
+			break;
+		}
+		opt++;
+	}
+	if (opt + 1 != argc) {
+		fprintf(stderr, "usage: %s [-t threshold] [-n repeat] [-q] "
+				"[-x event] frames.csv\n", argv[0]);
+		return 2;
+	}
+	count = bench_read(argv[opt], &frames);
+	if (count == 0) {
+		fprintf(stderr, "%s: no frames\n", argv[opt]);
+		return 1;
+	}
+
+	// Replay once: events and latency from touch to event
+	touch_post_init(&post);
+	for (i = 0; i < count; i++) {
+		const bench_frame_t *fr = &frames[i];
+		bool now = bench_is_touched(fr, threshold);
+		uint8_t events, e;
+
+		if (now != touched) {
+			touched = now;
+			onset_ms = fr->frame.time_ms;
+			touch_pending = now;
+			release_pending = !now;
+		}
+		events = touch_post_process(&post, &fr->frame);
+		seen |= events;
+		if (touch_pending && (events & (TOUCH_POST_EVENT_KEY_PRESS
+				| TOUCH_POST_EVENT_SLIDER_TOUCH))) {
+			bench_latency_add(&touch_lat, onset_ms, fr->frame.time_ms);
+			touch_pending = false;
+		}
+		if (release_pending && (events & (TOUCH_POST_EVENT_KEY_RELEASE
+				| TOUCH_POST_EVENT_SLIDER_RELEASE))) {
+			bench_latency_add(&release_lat, onset_ms, fr->frame.time_ms);
+			release_pending = false;
+		}
+		for (e = 0; !quiet && e < 8; e++) {
+			if (events & (1u << e)) {
+				printf("%6u ms  %-14s position %3u velocity %d\n",
+						(unsigned)fr->frame.time_ms, event_names[e],
+						touch_post_get_position(&post),
+						(int)post.velocity);
+			}
+		}
+	}
+	printf("%zu frames\n", count);
+	bench_latency_print("touch latency", &touch_lat);
+	bench_latency_print("release latency", &release_lat);
+
+	// Cost per frame
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (r = 0; r < repeat; r++) {
+		touch_post_init(&post);
+		for (i = 0; i < count; i++) {
+			sink ^= touch_post_process(&post, &frames[i].frame);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	ns = (stop.tv_sec - start.tv_sec) * 1e9 + (stop.tv_nsec - start.tv_nsec);
+	printf("cost             %.1f ns per frame (host, %lu replays)\n",
+			ns / ((double)count * (repeat ? repeat : 1)), repeat);
+
+	free(frames);
+	if (expect != NULL) {
+		uint8_t e;
+
+		for (e = 0; e < 8 && strcmp(expect, event_names[e]); e++) {
+		}
+		if (e == 8 || !(seen & (1u << e))) {
+			fprintf(stderr, "%s: no %s event\n", argv[opt], expect);
+			return 1;
+		}
+	}
+	return 0;
+}